@@ -0,0 +1,17 @@
+#!/bin/bash
+# Build BusTub in release mode once per page size and run the buffer pool benchmark against each build.
+# Usage: build_support/page_size_bench.sh [bustub-bpm-bench arguments...]
+
+set -e
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+cd "$DIR/.."
+
+for PAGE_SIZE in 4096 8192 16384 32768; do
+  BUILD_DIR="cmake-build-page-${PAGE_SIZE}"
+  mkdir -p "${BUILD_DIR}"
+  cmake -S . -B "${BUILD_DIR}" -DCMAKE_BUILD_TYPE=Release -DBUSTUB_PAGE_SIZE="${PAGE_SIZE}" > /dev/null
+  cmake --build "${BUILD_DIR}" -j"$(nproc)" --target bpm-bench > /dev/null
+  echo "=== page size ${PAGE_SIZE} ==="
+  "${BUILD_DIR}/bin/bustub-bpm-bench" "$@"
+done
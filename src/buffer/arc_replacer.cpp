@@ -0,0 +1,175 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : frames_(num_frames) {}
+
+auto ARCReplacer::FindVictim(std::list<frame_id_t> *list) -> std::list<frame_id_t>::iterator {
+  return std::find_if(list->begin(), list->end(), [this](frame_id_t fid) { return frames_[fid].is_evictable_; });
+}
+
+void ARCReplacer::AddGhost(page_id_t page_id, bool in_b2) {
+  auto &list = in_b2 ? b2_ : b1_;
+  ghosts_[page_id] = Ghost{in_b2, list.insert(list.end(), page_id)};
+  TrimGhosts();
+}
+
+void ARCReplacer::EraseGhost(std::unordered_map<page_id_t, Ghost>::iterator it) {
+  (it->second.in_b2_ ? b2_ : b1_).erase(it->second.pos_);
+  ghosts_.erase(it);
+}
+
+void ARCReplacer::TrimGhosts() {
+  auto capacity = frames_.size();
+  while (!b1_.empty() && t1_.size() + b1_.size() > capacity) {
+    EraseGhost(ghosts_.find(b1_.front()));
+  }
+  while (!ghosts_.empty() && t1_.size() + t2_.size() + ghosts_.size() > 2 * capacity) {
+    EraseGhost(ghosts_.find(b2_.empty() ? b1_.front() : b2_.front()));
+  }
+}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  bool from_t1 = PreferT1(t1_.size());
+  auto victim = FindVictim(from_t1 ? &t1_ : &t2_);
+  if (victim == (from_t1 ? t1_.end() : t2_.end())) {
+    // Every frame of the preferred list is pinned.
+    from_t1 = !from_t1;
+    victim = FindVictim(from_t1 ? &t1_ : &t2_);
+  }
+  *frame_id = *victim;
+  auto &frame = frames_[*frame_id];
+  (from_t1 ? t1_ : t2_).erase(victim);
+  if (frame.page_id_ != INVALID_PAGE_ID) {
+    AddGhost(frame.page_id_, !from_t1);
+  }
+  frame = Frame();
+  curr_size_--;
+  return true;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (frame.is_tracked_) {
+    // A hit: the page has now been seen twice and moves to the MRU end of T2, unless this is a scan.
+    auto &list = frame.in_t2_ ? t2_ : t1_;
+    if (is_scan) {
+      list.splice(list.end(), list, frame.pos_);
+    } else {
+      t2_.splice(t2_.end(), list, frame.pos_);
+      frame.in_t2_ = true;
+    }
+    return;
+  }
+
+  // A miss. If the page was evicted recently, grow the list it was evicted from.
+  frame.is_tracked_ = true;
+  frame.in_t2_ = false;
+  auto ghost = ghosts_.find(frame.page_id_);
+  if (ghost != ghosts_.end()) {
+    if (!is_scan) {
+      if (ghost->second.in_b2_) {
+        auto delta = std::max<size_t>(1, b1_.size() / b2_.size());
+        target_t1_size_ = target_t1_size_ > delta ? target_t1_size_ - delta : 0;
+      } else {
+        auto delta = std::max<size_t>(1, b2_.size() / b1_.size());
+        target_t1_size_ = std::min(frames_.size(), target_t1_size_ + delta);
+      }
+      frame.in_t2_ = true;
+    }
+    EraseGhost(ghost);
+  }
+  auto &list = frame.in_t2_ ? t2_ : t1_;
+  frame.pos_ = list.insert(list.end(), frame_id);
+  TrimGhosts();
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.is_tracked_ || frame.is_evictable_ == set_evictable) {
+    return;
+  }
+  frame.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.is_tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(frame.is_evictable_, "Cannot remove a non-evictable frame.");
+  (frame.in_t2_ ? t2_ : t1_).erase(frame.pos_);
+  frame = Frame();
+  curr_size_--;
+}
+
+auto ARCReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  // Replay Evict() without changing anything: T1 shrinks with every victim taken from it, and ghosts only move the
+  // target on a later miss.
+  std::vector<frame_id_t> frames;
+  auto t1_size = t1_.size();
+  auto t1_it = FindVictim(&t1_);
+  auto t2_it = FindVictim(&t2_);
+  auto next_evictable = [this](std::list<frame_id_t>::iterator it, std::list<frame_id_t>::iterator end) {
+    return std::find_if(std::next(it), end, [this](frame_id_t fid) { return frames_[fid].is_evictable_; });
+  };
+  while (frames.size() < max_frames && (t1_it != t1_.end() || t2_it != t2_.end())) {
+    bool from_t1 = PreferT1(t1_size);
+    if (from_t1 ? t1_it == t1_.end() : t2_it == t2_.end()) {
+      from_t1 = !from_t1;
+    }
+    if (from_t1) {
+      frames.push_back(*t1_it);
+      t1_it = next_evictable(t1_it, t1_.end());
+      t1_size--;
+    } else {
+      frames.push_back(*t2_it);
+      t2_it = next_evictable(t2_it, t2_.end());
+    }
+  }
+  return frames;
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return curr_size_;
+}
+
+void ARCReplacer::SetPageId(frame_id_t frame_id, page_id_t page_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  frames_[frame_id].page_id_ = page_id;
+}
+
+}  // namespace bustub
@@ -12,57 +12,721 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <new>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
 #include "common/exception.h"
+#include "common/logger.h"
 #include "common/macros.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+BufferPoolManager::Shard::Shard(size_t index, frame_id_t first_frame_id, size_t num_frames,
+                                std::unique_ptr<Replacer> replacer)
+    : index_(index), first_frame_id_(first_frame_id), page_table_(num_frames), replacer_(std::move(replacer)) {
+  // Initially, every frame of the shard is in the free list.
+  for (size_t i = 0; i < num_frames; ++i) {
+    free_list_.emplace_back(first_frame_id + static_cast<frame_id_t>(i));
+  }
+  for (auto &access : access_log_) {
+    access.store(NO_ACCESS, std::memory_order_relaxed);
+  }
+}
+
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // TODO(students): remove this line after you have implemented the buffer pool manager
-  throw NotImplementedException(
-      "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
-      "exception line in `buffer_pool_manager.cpp`.");
-
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
-
-  // Initially, every page is in the free list.
+                                     LogManager *log_manager, size_t num_shards, ReplacerPolicy replacer_policy)
+    : pool_size_(pool_size),
+      disk_manager_(disk_manager),
+      disk_scheduler_(std::make_unique<DiskScheduler>(disk_manager)),
+      log_manager_(log_manager) {
+  BUSTUB_ASSERT(num_shards > 0 && num_shards <= pool_size, "Every shard needs at least one frame.");
+  BUSTUB_ASSERT(pool_size < (size_t{1} << 29), "Frame ids must fit into an access log entry.");
+
+  // we allocate a consecutive memory space for the buffer pool, keeping the frame metadata apart from the data
+  frame_arena_ = std::make_unique<FrameArena>(pool_size_, bpm_use_huge_pages, bpm_numa_node);
+  pages_ = static_cast<Page *>(::operator new[](pool_size_ * sizeof(Page), std::align_val_t{alignof(Page)}));
   for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+    new (&pages_[i]) Page(frame_arena_->GetFrameData(static_cast<frame_id_t>(i)));
+  }
+
+  // Split the frames as evenly as possible, giving the remainder to the first shards.
+  frame_id_t first_frame_id = 0;
+  for (size_t i = 0; i < num_shards; ++i) {
+    size_t num_frames = pool_size_ / num_shards + (i < pool_size_ % num_shards ? 1 : 0);
+    auto replacer = CreateReplacer(replacer_policy, num_frames, replacer_k);
+    shards_.emplace_back(std::make_unique<Shard>(i, first_frame_id, num_frames, std::move(replacer)));
+    first_frame_id += static_cast<frame_id_t>(num_frames);
   }
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+BufferPoolManager::~BufferPoolManager() {
+  StopBackgroundFlusher();
+  // Outstanding prefetches still write into the frames.
+  for (auto &shard : shards_) {
+    std::scoped_lock lock(shard->latch_);
+    ReapPrefetches(*shard, true);
+  }
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_, std::align_val_t{alignof(Page)});
+}
+
+auto BufferPoolManager::AcquireFrame(Shard &shard, frame_id_t *frame_id) -> bool {
+  if (!shard.free_list_.empty()) {
+    *frame_id = shard.free_list_.front();
+    shard.free_list_.pop_front();
+    // A thread that found the frame through a stale page table entry may hold it for a moment.
+    while (!ClaimFrame(&pages_[*frame_id])) {
+      std::this_thread::yield();
+    }
+    return true;
+  }
 
-// 3333333333333
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * { return nullptr; }
+  ApplyAccessLog(shard);
+  ReapPrefetches(shard, false);
+  frame_id_t replacer_frame_id;
+  while (true) {
+    if (!shard.replacer_->Evict(&replacer_frame_id)) {
+      // Frames still being prefetched become evictable once their reads are done.
+      if (shard.pending_reads_.empty()) {
+        return false;
+      }
+      ReapPrefetches(shard, true);
+      if (!shard.replacer_->Evict(&replacer_frame_id)) {
+        return false;
+      }
+    }
+    *frame_id = shard.first_frame_id_ + replacer_frame_id;
+    if (ClaimFrame(&pages_[*frame_id])) {
+      break;
+    }
+    // Pinned without the latch after the access log was applied. Track the frame again; the unpin that brings its
+    // pin count back to 0 is logged and makes it evictable.
+    shard.replacer_->SetPageId(replacer_frame_id, pages_[*frame_id].GetPageId());
+    shard.replacer_->RecordAccess(replacer_frame_id);
+    shard.replacer_->SetEvictable(replacer_frame_id, false);
+  }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
+  auto *page = &pages_[*frame_id];
+  if (page->IsDirty()) {
+    DoPageIO(true, page->GetPageId(), *frame_id);
+    ClearDirty(page);
+    dirty_evictions_++;
+  } else {
+    clean_evictions_++;
+  }
+  shard.page_table_.Remove(page->GetPageId());
+  page->ResetMemory();
+  page->page_id_.store(INVALID_PAGE_ID, std::memory_order_relaxed);
+  return true;
+}
+
+void BufferPoolManager::ReapPrefetches(Shard &shard, bool wait) {
+  for (auto it = shard.pending_reads_.begin(); it != shard.pending_reads_.end();) {
+    auto &read = it->second;
+    if (!wait && read.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      ++it;
+      continue;
+    }
+    auto frame_id = it->first;
+    auto *page = &pages_[frame_id];
+    bool ok = read.get();
+    if (!ok && !ClaimFrame(page)) {
+      ++it;
+      continue;
+    }
+    it = shard.pending_reads_.erase(it);
+    if (!ok) {
+      DiscardFrame(shard, frame_id);
+      continue;
+    }
+    page->io_pending_.store(false, std::memory_order_seq_cst);
+    if (page->pin_count_.load(std::memory_order_seq_cst) == 0) {
+      shard.replacer_->SetEvictable(frame_id - shard.first_frame_id_, true);
+    }
+  }
+}
+
+void BufferPoolManager::DiscardFrame(Shard &shard, frame_id_t frame_id) {
+  auto *page = &pages_[frame_id];
+  auto replacer_frame_id = frame_id - shard.first_frame_id_;
+  shard.replacer_->SetEvictable(replacer_frame_id, true);
+  shard.replacer_->Remove(replacer_frame_id);
+  shard.page_table_.Remove(page->GetPageId());
+  shard.free_list_.push_back(frame_id);
+  page->ResetMemory();
+  page->page_id_.store(INVALID_PAGE_ID, std::memory_order_relaxed);
+  page->io_pending_.store(false, std::memory_order_relaxed);
+  ClearDirty(page);
+  page->pin_count_.store(0, std::memory_order_release);
+}
+
+void BufferPoolManager::ClearDirty(Page *page) {
+  if (page->is_dirty_.exchange(false)) {
+    num_dirty_--;
+  }
+}
+
+auto BufferPoolManager::DoPageIO(bool is_write, page_id_t page_id, frame_id_t frame_id) -> bool {
+  // The caller needs the result before it can go on, so handing a single page to a scheduler thread would only add
+  // a thread switch. The disk manager does positional I/O without a latch, so these calls still overlap across shards.
+  if (is_write) {
+    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
+    return true;
+  }
+  return disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+}
+
+void BufferPoolManager::InstallPage(Shard &shard, frame_id_t frame_id, page_id_t page_id, int pin_count) {
+  auto *page = &pages_[frame_id];
+  page->page_id_.store(page_id, std::memory_order_relaxed);
+  shard.page_table_.Insert(page_id, frame_id);
+  shard.replacer_->SetPageId(frame_id - shard.first_frame_id_, page_id);
+  // Publishes the page along with the new pin count: a thread that pins the frame also sees its data and page id.
+  page->pin_count_.store(pin_count, std::memory_order_release);
+}
+
+void BufferPoolManager::PinFrame(Shard &shard, frame_id_t frame_id, AccessType access_type) {
+  pages_[frame_id].pin_count_.fetch_add(1, std::memory_order_acquire);
+  auto replacer_frame_id = frame_id - shard.first_frame_id_;
+  shard.replacer_->RecordAccess(replacer_frame_id, access_type);
+  shard.replacer_->SetEvictable(replacer_frame_id, false);
+}
+
+auto BufferPoolManager::TryPinResident(Shard &shard, page_id_t page_id, frame_id_t frame_id) -> bool {
+  auto *page = &pages_[frame_id];
+  auto pin_count = page->pin_count_.load(std::memory_order_relaxed);
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1, std::memory_order_acquire,
+                                                   std::memory_order_relaxed));
+  // Once pinned, the frame cannot be reused, so the page id read now stays valid.
+  if (page->GetPageId() == page_id && !page->io_pending_.load(std::memory_order_seq_cst)) {
+    return true;
+  }
+  auto held_page_id = page->GetPageId();
+  if (page->pin_count_.fetch_sub(1, std::memory_order_release) == 1 && held_page_id != INVALID_PAGE_ID) {
+    // The pin may have kept the frame from being evicted, which left it non-evictable in the replacer.
+    LogAccess(shard, MakeAccess(held_page_id, frame_id, UNPIN_ACCESS));
+  }
+  return false;
+}
+
+void BufferPoolManager::LogAccess(Shard &shard, uint64_t access) {
+  while (true) {
+    auto slot = shard.access_log_size_.fetch_add(1, std::memory_order_relaxed);
+    if (slot < shard.access_log_.size()) {
+      shard.access_log_[slot].store(access, std::memory_order_release);
+      return;
+    }
+    // The log is full. Applying it makes room for this entry; if another thread just did so, there is room already.
+    std::scoped_lock lock(shard.latch_);
+    if (shard.access_log_size_.load(std::memory_order_relaxed) >= shard.access_log_.size()) {
+      ApplyAccessLog(shard);
+    }
+  }
+}
+
+void BufferPoolManager::ApplyAccessLog(Shard &shard) {
+  // Hand out no more slots while the log is applied. Threads that get none wait for the latch and try again.
+  auto size = std::min(shard.access_log_size_.exchange(shard.access_log_.size(), std::memory_order_acquire),
+                       shard.access_log_.size());
+  for (size_t i = 0; i < size; i++) {
+    uint64_t access;
+    // A thread may have been handed the slot but not written it yet.
+    while ((access = shard.access_log_[i].exchange(NO_ACCESS, std::memory_order_acquire)) == NO_ACCESS) {
+      std::this_thread::yield();
+    }
+    auto page_id = static_cast<page_id_t>(access >> 32);
+    auto frame_id = static_cast<frame_id_t>((access & UINT32_MAX) >> 3);
+    auto kind = static_cast<uint32_t>(access & 7);
+    auto *page = &pages_[frame_id];
+    // The frame may hold another page by now, or its page may not be readable yet.
+    if (page->GetPageId() != page_id || page->io_pending_.load(std::memory_order_relaxed)) {
+      continue;
+    }
+    auto replacer_frame_id = frame_id - shard.first_frame_id_;
+    if (kind != UNPIN_ACCESS) {
+      shard.replacer_->RecordAccess(replacer_frame_id, static_cast<AccessType>(kind));
+    }
+    shard.replacer_->SetEvictable(replacer_frame_id, page->pin_count_.load(std::memory_order_seq_cst) == 0);
+  }
+  shard.access_log_size_.store(0, std::memory_order_release);
+}
+
+auto BufferPoolManager::NewPage(page_id_t *page_id, segment_id_t segment_id) -> Page * {
+  if (!disk_manager_->HasSegment(segment_id)) {
+    return nullptr;
+  }
+  // Spread new pages over the shards round-robin, moving on to the next shard if one has every frame pinned.
+  auto num_shards = shards_.size();
+  auto first_shard = next_shard_.fetch_add(1) % num_shards;
+  for (size_t i = 0; i < num_shards; ++i) {
+    auto &shard = *shards_[(first_shard + i) % num_shards];
+    std::scoped_lock lock(shard.latch_);
+    frame_id_t frame_id;
+    if (!AcquireFrame(shard, &frame_id)) {
+      continue;
+    }
+    *page_id = AllocatePage(shard, segment_id);
+    InstallPage(shard, frame_id, *page_id, 0);
+    PinFrame(shard, frame_id, AccessType::Unknown);
+    return &pages_[frame_id];
+  }
   return nullptr;
 }
 
+auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  auto &shard = GetShard(page_id);
+  frame_id_t frame_id;
+  if (shard.page_table_.Find(page_id, &frame_id) && TryPinResident(shard, page_id, frame_id)) {
+    shard.hits_.fetch_add(1, std::memory_order_relaxed);
+    LogAccess(shard, MakeAccess(page_id, frame_id, static_cast<uint32_t>(access_type)));
+    return &pages_[frame_id];
+  }
+
+  std::unique_lock lock(shard.latch_);
+  // Completed prefetches can be pinned without the latch from now on.
+  ReapPrefetches(shard, false);
+  if (shard.page_table_.Find(page_id, &frame_id)) {
+    PinFrame(shard, frame_id, access_type);
+    shard.hits_.fetch_add(1, std::memory_order_relaxed);
+    auto pending = shard.pending_reads_.find(frame_id);
+    if (pending != shard.pending_reads_.end()) {
+      // The page is still being prefetched. Our pin keeps the frame in place, so wait without holding the latch.
+      auto read = pending->second;
+      lock.unlock();
+      if (!read.get()) {
+        // The last thread to give up on the page drops it.
+        lock.lock();
+        pages_[frame_id].pin_count_.fetch_sub(1, std::memory_order_release);
+        if (shard.pending_reads_.count(frame_id) > 0 && ClaimFrame(&pages_[frame_id])) {
+          shard.pending_reads_.erase(frame_id);
+          DiscardFrame(shard, frame_id);
+        }
+        return nullptr;
+      }
+    }
+    return &pages_[frame_id];
+  }
+
+  if (!AcquireFrame(shard, &frame_id)) {
+    return nullptr;
+  }
+  misses_++;
+  if (!DoPageIO(false, page_id, frame_id)) {
+    pages_[frame_id].ResetMemory();
+    shard.free_list_.push_back(frame_id);
+    pages_[frame_id].pin_count_.store(0, std::memory_order_release);
+    return nullptr;
+  }
+  InstallPage(shard, frame_id, page_id, 0);
+  PinFrame(shard, frame_id, access_type);
+  return &pages_[frame_id];
+}
+
+auto BufferPoolManager::PrefetchPage(page_id_t page_id, AccessType access_type) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto &shard = GetShard(page_id);
+  frame_id_t frame_id;
+  if (shard.page_table_.Find(page_id, &frame_id)) {
+    return true;
+  }
+  std::scoped_lock lock(shard.latch_);
+  if (shard.page_table_.Find(page_id, &frame_id)) {
+    return true;
+  }
+
+  if (!AcquireFrame(shard, &frame_id)) {
+    return false;
+  }
+  auto *page = &pages_[frame_id];
+  // Threads that find the page keep their hands off it until the read has completed and the prefetch is reaped.
+  page->io_pending_.store(true, std::memory_order_relaxed);
+  InstallPage(shard, frame_id, page_id, 0);
+  // Record the access but leave the frame unpinned and not evictable until then.
+  shard.replacer_->RecordAccess(frame_id - shard.first_frame_id_, access_type);
+  shard.replacer_->SetEvictable(frame_id - shard.first_frame_id_, false);
+
+  auto promise = disk_scheduler_->CreatePromise();
+  shard.pending_reads_.emplace(frame_id, promise.get_future().share());
+  disk_scheduler_->Schedule({false, page->GetData(), page_id, std::move(promise)});
+  prefetch_reads_++;
+  return true;
+}
+
 auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
-  return false;
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto &shard = GetShard(page_id);
+  frame_id_t frame_id;
+  if (!shard.page_table_.Find(page_id, &frame_id)) {
+    // The lock-free lookup can miss while the table is rebuilt; only a miss under the latch is certain.
+    std::scoped_lock lock(shard.latch_);
+    if (!shard.page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+  }
+  // The caller's pin keeps the page in its frame, so the frame can be used without the latch.
+  auto *page = &pages_[frame_id];
+  if (page->GetPageId() != page_id || page->pin_count_.load(std::memory_order_relaxed) <= 0) {
+    return false;
+  }
+  // Mark the page dirty while it is still pinned, or it could be evicted without being written back.
+  if (is_dirty && !page->is_dirty_.exchange(true)) {
+    // Wake the flusher as soon as the high watermark is reached rather than at its next periodic check.
+    auto high_watermark = flusher_high_watermark_.load();
+    if (++num_dirty_ >= high_watermark && high_watermark > 0) {
+      flusher_cv_.notify_one();
+    }
+  }
+  auto pin_count = page->pin_count_.load(std::memory_order_relaxed);
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+  if (pin_count == 1) {
+    LogAccess(shard, MakeAccess(page_id, frame_id, UNPIN_ACCESS));
+  }
+  return true;
 }
 
-auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool { return false; }
+auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto &shard = GetShard(page_id);
+  {
+    std::scoped_lock lock(shard.latch_);
+    frame_id_t frame_id;
+    if (!shard.page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+    if (shard.pending_reads_.count(frame_id) > 0) {
+      ReapPrefetches(shard, true);
+      // The prefetch failed, and there is nothing to write.
+      if (shard.pending_reads_.count(frame_id) > 0 || !shard.page_table_.Find(page_id, &frame_id)) {
+        return false;
+      }
+    }
+    DoPageIO(true, page_id, frame_id);
+    ClearDirty(&pages_[frame_id]);
+  }
+  // Make the write durable without holding up other threads of the shard.
+  disk_manager_->Sync();
+  return true;
+}
 
-void BufferPoolManager::FlushAllPages() {}
+void BufferPoolManager::FlushAllPages() {
+  // Once the pages deleted so far are flushed, no page on disk refers to them any more.
+  auto deallocated_pages = disk_manager_->TakeDeallocatedPages();
+  for (auto &shard : shards_) {
+    std::scoped_lock lock(shard->latch_);
+    ReapPrefetches(*shard, true);
+    // Hand the whole shard to the disk scheduler as one batch so the writes are in flight together.
+    std::vector<DiskRequest> requests;
+    std::vector<std::future<bool>> futures;
+    shard->page_table_.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+      // Only pages that failed their prefetch can still be outstanding.
+      if (shard->pending_reads_.count(frame_id) > 0) {
+        return;
+      }
+      auto promise = disk_scheduler_->CreatePromise();
+      futures.push_back(promise.get_future());
+      requests.push_back({true, pages_[frame_id].GetData(), page_id, std::move(promise)});
+      ClearDirty(&pages_[frame_id]);
+    });
+    disk_scheduler_->Schedule(std::move(requests));
+    for (auto &future : futures) {
+      future.get();
+    }
+  }
+  disk_manager_->Sync();
+  disk_manager_->PersistDeallocations(deallocated_pages);
+}
 
-auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool { return false; }
+auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  auto &shard = GetShard(page_id);
+  std::scoped_lock lock(shard.latch_);
+  frame_id_t frame_id;
+  if (shard.page_table_.Find(page_id, &frame_id)) {
+    if (pages_[frame_id].GetPinCount() > 0) {
+      return false;
+    }
+    if (shard.pending_reads_.count(frame_id) > 0) {
+      ReapPrefetches(shard, true);
+    }
+    // The page may have been pinned without the latch meanwhile, or dropped because its prefetch failed.
+    if (shard.page_table_.Find(page_id, &frame_id)) {
+      if (!ClaimFrame(&pages_[frame_id])) {
+        return false;
+      }
+      DiscardFrame(shard, frame_id);
+    }
+  }
+  DeallocatePage(shard, page_id);
+  return true;
+}
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+void BufferPoolManager::StartBackgroundFlusher(double high_watermark, double low_watermark) {
+  BUSTUB_ASSERT(0 < high_watermark && high_watermark <= 1, "The high watermark must be a fraction of the pool.");
+  BUSTUB_ASSERT(0 <= low_watermark && low_watermark < high_watermark, "The low watermark must be below the high one.");
+  std::scoped_lock lock(flusher_latch_);
+  flusher_low_watermark_ = static_cast<size_t>(low_watermark * pool_size_);
+  flusher_high_watermark_ = std::max<size_t>(static_cast<size_t>(high_watermark * pool_size_), 1);
+  if (!flusher_thread_.joinable()) {
+    flusher_stop_ = false;
+    flusher_thread_ = std::thread([this] { RunFlusher(); });
+  }
+}
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, nullptr}; }
+void BufferPoolManager::StopBackgroundFlusher() {
+  {
+    std::scoped_lock lock(flusher_latch_);
+    if (!flusher_thread_.joinable()) {
+      return;
+    }
+    flusher_stop_ = true;
+    flusher_high_watermark_ = 0;
+  }
+  flusher_cv_.notify_one();
+  flusher_thread_.join();
+}
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard { return {this, nullptr}; }
+auto BufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.hits_ = 0;
+  for (auto &shard : shards_) {
+    stats.hits_ += shard->hits_.load(std::memory_order_relaxed);
+  }
+  stats.misses_ = misses_;
+  stats.dirty_pages_ = num_dirty_;
+  stats.flusher_writes_ = flusher_writes_;
+  stats.dirty_evictions_ = dirty_evictions_;
+  stats.clean_evictions_ = clean_evictions_;
+  stats.prefetch_reads_ = prefetch_reads_;
+  return stats;
+}
+
+void BufferPoolManager::RunFlusher() {
+  std::unique_lock lock(flusher_latch_);
+  while (!flusher_stop_) {
+    flusher_cv_.wait_for(lock, bpm_flusher_interval,
+                         [&] { return flusher_stop_ || num_dirty_ >= flusher_high_watermark_; });
+    if (flusher_stop_ || num_dirty_ < flusher_high_watermark_) {
+      continue;
+    }
+    size_t num_dirty = num_dirty_;
+    size_t low_watermark = flusher_low_watermark_;
+    lock.unlock();
+    FlushVictims(num_dirty - std::min(num_dirty, low_watermark));
+    lock.lock();
+  }
+}
+
+auto BufferPoolManager::FlushVictims(size_t max_pages) -> size_t {
+  // Split the work over the shards, so that every shard keeps clean victims of its own.
+  auto num_shards = shards_.size();
+  auto quota = (max_pages + num_shards - 1) / num_shards;
+  size_t flushed = 0;
+  for (auto &shard : shards_) {
+    std::vector<frame_id_t> candidates;
+    {
+      std::scoped_lock lock(shard->latch_);
+      ApplyAccessLog(*shard);
+      candidates = shard->replacer_->EvictionCandidates(pool_size_);
+    }
+    size_t shard_flushed = 0;
+    for (auto candidate : candidates) {
+      if (shard_flushed == quota || flushed == max_pages) {
+        break;
+      }
+      if (FlushUnpinnedFrame(*shard, shard->first_frame_id_ + candidate)) {
+        shard_flushed++;
+        flushed++;
+      }
+    }
+  }
+  return flushed;
+}
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard { return {this, nullptr}; }
+auto BufferPoolManager::FlushUnpinnedFrame(Shard &shard, frame_id_t frame_id) -> bool {
+  auto *page = &pages_[frame_id];
+  auto replacer_frame_id = frame_id - shard.first_frame_id_;
+  page_id_t page_id;
+  {
+    std::scoped_lock lock(shard.latch_);
+    // The frame may have been pinned or reused since the candidates were listed.
+    page_id = page->GetPageId();
+    int pin_count = 0;
+    if (!page->IsDirty() || page_id == INVALID_PAGE_ID ||
+        !page->pin_count_.compare_exchange_strong(pin_count, 1, std::memory_order_acquire)) {
+      return false;
+    }
+    // Pin without recording an access, so the write does not change the frame's place in the eviction order. The
+    // page is marked clean before the write: any change made after this point comes with an UnpinPage that marks it
+    // dirty again.
+    shard.replacer_->SetEvictable(replacer_frame_id, false);
+    ClearDirty(page);
+  }
+
+  page->RLatch();
+  DoPageIO(true, page_id, frame_id);
+  page->RUnlatch();
+  flusher_writes_++;
+
+  std::scoped_lock lock(shard.latch_);
+  if (page->pin_count_.fetch_sub(1, std::memory_order_release) == 1) {
+    shard.replacer_->SetEvictable(replacer_frame_id, true);
+  }
+  return true;
+}
 
-auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {this, nullptr}; }
+auto BufferPoolManager::GetSegmentPages(Shard &shard, segment_id_t segment_id) -> Shard::SegmentPages & {
+  auto it = shard.segment_pages_.find(segment_id);
+  if (it != shard.segment_pages_.end()) {
+    return it->second;
+  }
+  // Pick up after the pages already allocated in the segment, and take over the free ones that map to this shard.
+  auto num_shards = static_cast<page_id_t>(shards_.size());
+  auto index = static_cast<page_id_t>(shard.index_);
+  auto page_id_limit = disk_manager_->GetPageIdLimit(segment_id);
+  auto &pages = shard.segment_pages_[segment_id];
+  pages.next_page_id_ = page_id_limit + (index - page_id_limit % num_shards + num_shards) % num_shards;
+  for (auto page_id : disk_manager_->GetFreePages(segment_id)) {
+    if (page_id % num_shards == index) {
+      pages.free_pages_.insert(page_id);
+    }
+  }
+  return pages;
+}
+
+auto BufferPoolManager::AllocatePage(Shard &shard, segment_id_t segment_id) -> page_id_t {
+  auto &pages = GetSegmentPages(shard, segment_id);
+  page_id_t page_id;
+  if (!pages.free_pages_.empty()) {
+    page_id = *pages.free_pages_.begin();
+    pages.free_pages_.erase(pages.free_pages_.begin());
+  } else {
+    page_id = pages.next_page_id_;
+    pages.next_page_id_ += static_cast<page_id_t>(shards_.size());
+  }
+  disk_manager_->AllocatePage(page_id);
+  return page_id;
+}
+
+void BufferPoolManager::DeallocatePage(Shard &shard, page_id_t page_id) {
+  if (disk_manager_->DeallocatePage(page_id)) {
+    GetSegmentPages(shard, DiskManager::GetSegmentId(page_id)).free_pages_.insert(page_id);
+  }
+}
+
+auto BufferPoolManager::CreateSegment() -> segment_id_t {
+  auto segment_id = disk_manager_->CreateSegment();
+  if (segment_id == INVALID_SEGMENT_ID) {
+    LOG_DEBUG("no more segments, using the default segment");
+    return DEFAULT_SEGMENT_ID;
+  }
+  return segment_id;
+}
+
+auto BufferPoolManager::DropSegment(segment_id_t segment_id) -> bool {
+  if (segment_id == DEFAULT_SEGMENT_ID || !disk_manager_->HasSegment(segment_id)) {
+    return false;
+  }
+  // Hold every shard latch, so that no page of the segment can be fetched while it is dropped.
+  std::vector<std::unique_lock<std::mutex>> locks;
+  for (auto &shard : shards_) {
+    locks.emplace_back(shard->latch_);
+    ReapPrefetches(*shard, true);
+  }
+  // Claim every frame of the segment, so that none of its pages can be pinned without a latch either.
+  std::vector<std::pair<Shard *, frame_id_t>> claimed;
+  bool pinned = false;
+  for (auto &shard : shards_) {
+    shard->page_table_.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+      if (pinned || DiskManager::GetSegmentId(page_id) != segment_id) {
+        return;
+      }
+      if (ClaimFrame(&pages_[frame_id])) {
+        claimed.emplace_back(shard.get(), frame_id);
+      } else {
+        pinned = true;
+      }
+    });
+  }
+  if (pinned) {
+    for (auto [shard, frame_id] : claimed) {
+      pages_[frame_id].pin_count_.store(0, std::memory_order_release);
+    }
+    return false;
+  }
+  for (auto [shard, frame_id] : claimed) {
+    DiscardFrame(*shard, frame_id);
+  }
+  for (auto &shard : shards_) {
+    shard->segment_pages_.erase(segment_id);
+  }
+  return disk_manager_->DropSegment(segment_id);
+}
+
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, FetchPage(page_id)}; }
+
+auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
+  auto *page = FetchPage(page_id);
+  if (page != nullptr) {
+    page->RLatch();
+  }
+  return {this, page};
+}
+
+auto BufferPoolManager::TryFetchPageRead(page_id_t page_id, ReadPageGuard *guard) -> bool {
+  auto *page = FetchPage(page_id);
+  if (page == nullptr) {
+    return false;
+  }
+  if (!page->TryRLatch()) {
+    UnpinPage(page_id, false);
+    return false;
+  }
+  *guard = ReadPageGuard(this, page);
+  return true;
+}
+
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
+  auto *page = FetchPage(page_id);
+  if (page != nullptr) {
+    page->WLatch();
+  }
+  return {this, page};
+}
+
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard {
+  return {this, FetchPage(page_id)};
+}
+
+auto BufferPoolManager::NewPageGuarded(page_id_t *page_id, segment_id_t segment_id) -> BasicPageGuard {
+  return {this, NewPage(page_id, segment_id)};
+}
 
 }  // namespace bustub
@@ -0,0 +1,273 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.cpp
+//
+// Identification: src/buffer/clock_pro_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_pro_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+static constexpr frame_id_t NON_RESIDENT = -1;
+
+ClockProReplacer::ClockProReplacer(size_t num_frames)
+    : hand_hot_(clock_.end()),
+      hand_cold_(clock_.end()),
+      hand_test_(clock_.end()),
+      frames_(num_frames),
+      cold_target_(std::max<size_t>(1, num_frames / 2)) {}
+
+auto ClockProReplacer::Next(EntryIterator it) -> EntryIterator {
+  ++it;
+  return it == clock_.end() ? clock_.begin() : it;
+}
+
+auto ClockProReplacer::Insert(Entry entry) -> EntryIterator {
+  if (clock_.empty()) {
+    auto it = clock_.insert(clock_.end(), entry);
+    hand_hot_ = hand_cold_ = hand_test_ = it;
+    return it;
+  }
+  return clock_.insert(hand_hot_, entry);
+}
+
+void ClockProReplacer::Erase(EntryIterator it) {
+  auto next = clock_.size() == 1 ? clock_.end() : Next(it);
+  for (auto *hand : {&hand_hot_, &hand_cold_, &hand_test_}) {
+    if (*hand == it) {
+      *hand = next;
+    }
+  }
+  clock_.erase(it);
+}
+
+void ClockProReplacer::EndTestPeriod(Entry *entry) {
+  entry->in_test_ = false;
+  cold_target_ = std::max<size_t>(1, cold_target_ - 1);
+}
+
+void ClockProReplacer::RunHandHot() {
+  // Every hot page passed has its reference bit cleared, so one is demoted within two laps.
+  while (num_hot_ > 0) {
+    auto it = hand_hot_;
+    if (it->frame_id_ == NON_RESIDENT) {
+      EndTestPeriod(&*it);
+      non_resident_.erase(it->page_id_);
+      Erase(it);
+      continue;
+    }
+    hand_hot_ = Next(it);
+    if (!it->is_hot_) {
+      if (it->in_test_) {
+        EndTestPeriod(&*it);
+      }
+      continue;
+    }
+    if (it->is_referenced_) {
+      it->is_referenced_ = false;
+      continue;
+    }
+    it->is_hot_ = false;
+    num_hot_--;
+    return;
+  }
+}
+
+void ClockProReplacer::RunHandTest() {
+  while (!non_resident_.empty()) {
+    auto it = hand_test_;
+    if (it->frame_id_ == NON_RESIDENT) {
+      EndTestPeriod(&*it);
+      non_resident_.erase(it->page_id_);
+      Erase(it);
+      return;
+    }
+    if (!it->is_hot_ && it->in_test_) {
+      EndTestPeriod(&*it);
+    }
+    hand_test_ = Next(it);
+  }
+}
+
+void ClockProReplacer::EvictEntry(EntryIterator it) {
+  auto frame_id = it->frame_id_;
+  if (it->in_test_ && it->page_id_ != INVALID_PAGE_ID) {
+    // Keep the page as non-resident until its test period ends, to recognize it if it comes back.
+    it->frame_id_ = NON_RESIDENT;
+    it->is_referenced_ = false;
+    non_resident_[it->page_id_] = it;
+    hand_cold_ = Next(it);
+    while (non_resident_.size() > frames_.size()) {
+      RunHandTest();
+    }
+  } else {
+    Erase(it);
+  }
+  frames_[frame_id] = Frame();
+  curr_size_--;
+}
+
+auto ClockProReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  size_t steps_without_victim = 0;
+  for (size_t step = 0; step < 8 * clock_.size(); step++) {
+    if (steps_without_victim == clock_.size()) {
+      // A whole lap found only hot or pinned cold pages; demote a hot page to have more cold ones.
+      RunHandHot();
+      steps_without_victim = 0;
+    }
+    auto it = hand_cold_;
+    bool is_candidate = !it->is_hot_ && it->frame_id_ != NON_RESIDENT && frames_[it->frame_id_].is_evictable_;
+    if (is_candidate && !it->is_referenced_) {
+      *frame_id = it->frame_id_;
+      EvictEntry(it);
+      return true;
+    }
+    hand_cold_ = Next(it);
+    steps_without_victim++;
+    if (!is_candidate) {
+      continue;
+    }
+    it->is_referenced_ = false;
+    if (!it->in_test_) {
+      // Referenced outside its test period: give it another test period.
+      it->in_test_ = true;
+      continue;
+    }
+    // Reaccessed within its test period: its reuse distance is short, so it turns hot.
+    it->in_test_ = false;
+    it->is_hot_ = true;
+    num_hot_++;
+    while (num_hot_ > HotTarget()) {
+      RunHandHot();
+    }
+  }
+
+  // The hands keep turning pages hot and cold without finding a victim, e.g. because every evictable frame is hot
+  // and keeps being promoted again. Take the first evictable frame from HAND_cold on.
+  auto it = hand_cold_;
+  while (it->frame_id_ == NON_RESIDENT || !frames_[it->frame_id_].is_evictable_) {
+    it = Next(it);
+  }
+  if (it->is_hot_) {
+    it->is_hot_ = false;
+    num_hot_--;
+  }
+  it->in_test_ = false;
+  *frame_id = it->frame_id_;
+  EvictEntry(it);
+  return true;
+}
+
+void ClockProReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (frame.is_tracked_) {
+    if (!is_scan) {
+      frame.pos_->is_referenced_ = true;
+    }
+    return;
+  }
+
+  frame.is_tracked_ = true;
+  auto ghost = non_resident_.find(frame.page_id_);
+  if (ghost != non_resident_.end()) {
+    Erase(ghost->second);
+    non_resident_.erase(ghost);
+    if (!is_scan) {
+      // A miss on a page in its test period: with more room for cold pages it would have been a hit.
+      cold_target_ = std::min(frames_.size(), cold_target_ + 1);
+      frame.pos_ = Insert(Entry{frame.page_id_, frame_id, true});
+      num_hot_++;
+      while (num_hot_ > HotTarget()) {
+        RunHandHot();
+      }
+      return;
+    }
+  }
+  frame.pos_ = Insert(Entry{frame.page_id_, frame_id, false, false, true});
+}
+
+void ClockProReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.is_tracked_ || frame.is_evictable_ == set_evictable) {
+    return;
+  }
+  frame.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ClockProReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.is_tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(frame.is_evictable_, "Cannot remove a non-evictable frame.");
+  if (frame.pos_->is_hot_) {
+    num_hot_--;
+  }
+  Erase(frame.pos_);
+  frame = Frame();
+  curr_size_--;
+}
+
+auto ClockProReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  std::vector<frame_id_t> frames;
+  if (clock_.empty()) {
+    return frames;
+  }
+  auto matches = [](const Entry &entry, int pass) {
+    switch (pass) {
+      case 0:
+        return !entry.is_hot_ && !entry.is_referenced_;
+      case 1:
+        return !entry.is_hot_ && entry.is_referenced_;
+      default:
+        return entry.is_hot_;
+    }
+  };
+  for (int pass = 0; pass < 3; pass++) {
+    auto it = hand_cold_;
+    for (size_t i = 0; i < clock_.size() && frames.size() < max_frames; i++, it = Next(it)) {
+      if (it->frame_id_ != NON_RESIDENT && frames_[it->frame_id_].is_evictable_ && matches(*it, pass)) {
+        frames.push_back(it->frame_id_);
+      }
+    }
+  }
+  return frames;
+}
+
+auto ClockProReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return curr_size_;
+}
+
+void ClockProReplacer::SetPageId(frame_id_t frame_id, page_id_t page_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  frames_[frame_id].page_id_ = page_id;
+}
+
+}  // namespace bustub
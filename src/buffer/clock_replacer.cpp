@@ -12,18 +12,91 @@
 
 #include "buffer/clock_replacer.h"
 
+#include "common/macros.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : entries_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  // The first lap clears the reference bits it passes, so the hand finds a victim within two laps.
+  while (true) {
+    auto &entry = entries_[hand_];
+    auto current = hand_;
+    hand_ = (hand_ + 1) % entries_.size();
+    if (!entry.is_tracked_ || !entry.is_evictable_) {
+      continue;
+    }
+    if (entry.is_referenced_) {
+      entry.is_referenced_ = false;
+      continue;
+    }
+    entry = Entry();
+    curr_size_--;
+    *frame_id = static_cast<frame_id_t>(current);
+    return true;
+  }
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < entries_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  entries_[frame_id].is_tracked_ = true;
+  entries_[frame_id].is_referenced_ = true;
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < entries_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &entry = entries_[frame_id];
+  if (!entry.is_tracked_ || entry.is_evictable_ == set_evictable) {
+    return;
+  }
+  entry.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < entries_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &entry = entries_[frame_id];
+  if (!entry.is_tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(entry.is_evictable_, "Cannot remove a non-evictable frame.");
+  entry = Entry();
+  curr_size_--;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  // Going around from the hand, the unreferenced frames go first; the referenced ones follow on the second lap.
+  std::vector<frame_id_t> frames;
+  for (int lap = 0; lap < 2; lap++) {
+    for (size_t i = 0; i < entries_.size() && frames.size() < max_frames; i++) {
+      auto slot = (hand_ + i) % entries_.size();
+      const auto &entry = entries_[slot];
+      if (entry.is_tracked_ && entry.is_evictable_ && entry.is_referenced_ == (lap == 1)) {
+        frames.push_back(static_cast<frame_id_t>(slot));
+      }
+    }
+  }
+  return frames;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return curr_size_;
+}
 
 }  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef __linux__
+
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+FrameArena::FrameArena(size_t num_frames, bool use_huge_pages, int numa_node) {
+  size_t bytes = num_frames * BUSTUB_PAGE_SIZE;
+  void *addr = MAP_FAILED;
+  if (use_huge_pages) {
+    size_ = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    addr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    uses_huge_pages_ = addr != MAP_FAILED;
+    if (!uses_huge_pages_) {
+      LOG_DEBUG("no huge pages reserved, using transparent huge pages for the buffer pool");
+    }
+  }
+  if (addr == MAP_FAILED) {
+    // mmap only aligns to the OS page, which can be smaller than BUSTUB_PAGE_SIZE. Map one more page and trim the
+    // mapping so that it starts on a BUSTUB_PAGE_SIZE boundary.
+    size_ = bytes;
+    auto *base = static_cast<char *>(
+        mmap(nullptr, size_ + BUSTUB_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (base == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    auto head = (BUSTUB_PAGE_SIZE - reinterpret_cast<uintptr_t>(base) % BUSTUB_PAGE_SIZE) % BUSTUB_PAGE_SIZE;
+    if (head > 0) {
+      munmap(base, head);
+    }
+    munmap(base + head + size_, BUSTUB_PAGE_SIZE - head);
+    addr = base + head;
+    if (use_huge_pages) {
+      madvise(addr, size_, MADV_HUGEPAGE);
+    }
+  }
+  data_ = static_cast<char *>(addr);
+
+  // The mapping is not touched yet, so the pages are placed according to the policy when they are first written.
+  if (numa_node >= 0 && numa_node < 64) {
+    unsigned long nodemask = 1UL << numa_node;  // NOLINT
+    is_numa_bound_ = syscall(__NR_mbind, data_, size_, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8, 0) == 0;
+    if (!is_numa_bound_) {
+      LOG_DEBUG("cannot place the buffer pool on NUMA node %d", numa_node);
+    }
+  }
+}
+
+FrameArena::~FrameArena() { munmap(data_, size_); }
+
+#else
+
+FrameArena::FrameArena(size_t num_frames, bool use_huge_pages, int numa_node) {
+  size_ = num_frames * BUSTUB_PAGE_SIZE;
+  data_ = static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, size_));
+  if (data_ == nullptr) {
+    throw std::bad_alloc();
+  }
+  memset(data_, 0, size_);
+}
+
+FrameArena::~FrameArena() { std::free(data_); }
+
+#endif
+
+}  // namespace bustub
@@ -11,20 +11,103 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_k_replacer.h"
+
 #include "common/exception.h"
 
 namespace bustub {
 
 LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
 
-auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool { return false; }
+auto LRUKReplacer::GetVictimKey(const LRUKNode &node) -> VictimKey {
+  // For frames with fewer than k accesses the earliest access gives the LRU order among +inf; for the others it is
+  // the k-th most recent access, the oldest of which has the largest backward k-distance.
+  int group = node.IsScanOnly() ? 0 : node.HasKAccesses() ? 2 : 1;
+  return {group, node.GetEarliestTimestamp(), node.GetFrameId()};
+}
+
+auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  *frame_id = std::get<2>(*evictable_.begin());
+  evictable_.erase(evictable_.begin());
+  node_store_.erase(*frame_id);
+  curr_size_--;
+  return true;
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto it = node_store_.find(frame_id);
+  bool is_new = it == node_store_.end();
+  if (is_new) {
+    it = node_store_.emplace(frame_id, LRUKNode(frame_id, k_)).first;
+  }
+  auto &node = it->second;
+  auto timestamp = current_timestamp_++;
+  if (access_type == AccessType::Scan && !is_new && !node.IsScanOnly()) {
+    return;
+  }
+  // Evictable frames are rarely accessed, but when they are their key changes, so they are re-inserted.
+  if (node.IsEvictable()) {
+    evictable_.erase(GetVictimKey(node));
+  }
+  if (access_type == AccessType::Scan) {
+    node.RecordScanAccess(timestamp);
+  } else {
+    if (node.IsScanOnly()) {
+      node.ClearScanHistory();
+    }
+    node.RecordAccess(timestamp);
+  }
+  if (node.IsEvictable()) {
+    evictable_.insert(GetVictimKey(node));
+  }
+}
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {}
+void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto it = node_store_.find(frame_id);
+  if (it == node_store_.end() || it->second.IsEvictable() == set_evictable) {
+    return;
+  }
+  it->second.SetEvictable(set_evictable);
+  if (set_evictable) {
+    evictable_.insert(GetVictimKey(it->second));
+    curr_size_++;
+  } else {
+    evictable_.erase(GetVictimKey(it->second));
+    curr_size_--;
+  }
+}
 
-void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {}
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto it = node_store_.find(frame_id);
+  if (it == node_store_.end()) {
+    return;
+  }
+  BUSTUB_ASSERT(it->second.IsEvictable(), "Cannot remove a non-evictable frame.");
+  evictable_.erase(GetVictimKey(it->second));
+  node_store_.erase(it);
+  curr_size_--;
+}
 
-void LRUKReplacer::Remove(frame_id_t frame_id) {}
+auto LRUKReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  std::vector<frame_id_t> frames;
+  for (auto it = evictable_.begin(); it != evictable_.end() && frames.size() < max_frames; ++it) {
+    frames.push_back(std::get<2>(*it));
+  }
+  return frames;
+}
 
-auto LRUKReplacer::Size() -> size_t { return 0; }
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return curr_size_;
+}
 
 }  // namespace bustub
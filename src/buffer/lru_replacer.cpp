@@ -12,18 +12,80 @@
 
 #include "buffer/lru_replacer.h"
 
+#include "common/macros.h"
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : replacer_size_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  for (auto it = lru_list_.begin(); it != lru_list_.end(); ++it) {
+    if (entries_[*it].is_evictable_) {
+      *frame_id = *it;
+      entries_.erase(*it);
+      lru_list_.erase(it);
+      curr_size_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+void LRUReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto it = entries_.find(frame_id);
+  if (it == entries_.end()) {
+    entries_.emplace(frame_id, Entry{lru_list_.insert(lru_list_.end(), frame_id)});
+    return;
+  }
+  lru_list_.splice(lru_list_.end(), lru_list_, it->second.pos_);
+}
+
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto it = entries_.find(frame_id);
+  if (it == entries_.end() || it->second.is_evictable_ == set_evictable) {
+    return;
+  }
+  it->second.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto it = entries_.find(frame_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  BUSTUB_ASSERT(it->second.is_evictable_, "Cannot remove a non-evictable frame.");
+  lru_list_.erase(it->second.pos_);
+  entries_.erase(it);
+  curr_size_--;
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+auto LRUReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  std::vector<frame_id_t> frames;
+  for (auto it = lru_list_.begin(); it != lru_list_.end() && frames.size() < max_frames; ++it) {
+    if (entries_[*it].is_evictable_) {
+      frames.push_back(*it);
+    }
+  }
+  return frames;
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+auto LRUReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return curr_size_;
+}
 
 }  // namespace bustub
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+PageTable::PageTable(size_t max_entries) {
+  // Keep the table at most half full, so that probes stay short.
+  size_t num_slots = 8;
+  while (num_slots < 2 * max_entries) {
+    num_slots *= 2;
+  }
+  mask_ = num_slots - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(num_slots);
+  for (size_t i = 0; i < num_slots; i++) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  for (size_t i = Home(page_id), probes = 0; probes <= mask_; i = (i + 1) & mask_, probes++) {
+    auto slot = slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY) {
+      return false;
+    }
+    if (IsEntry(slot) && GetPageId(slot) == page_id) {
+      *frame_id = GetFrameId(slot);
+      return true;
+    }
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "Only valid page ids can be inserted.");
+  if (size_ + tombstones_ + 1 > (mask_ + 1) * 3 / 4) {
+    Rebuild();
+  }
+  // Reuse the first tombstone on the way, the page is not in the table further along.
+  size_t i = Home(page_id);
+  while (IsEntry(slots_[i].load(std::memory_order_relaxed))) {
+    i = (i + 1) & mask_;
+  }
+  if (slots_[i].load(std::memory_order_relaxed) == TOMBSTONE) {
+    tombstones_--;
+  }
+  slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+  size_++;
+}
+
+auto PageTable::Remove(page_id_t page_id) -> bool {
+  for (size_t i = Home(page_id);; i = (i + 1) & mask_) {
+    auto slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      return false;
+    }
+    if (IsEntry(slot) && GetPageId(slot) == page_id) {
+      slots_[i].store(TOMBSTONE, std::memory_order_release);
+      size_--;
+      tombstones_++;
+      return true;
+    }
+  }
+}
+
+void PageTable::Rebuild() {
+  std::vector<std::pair<page_id_t, frame_id_t>> entries;
+  entries.reserve(size_);
+  ForEach([&entries](page_id_t page_id, frame_id_t frame_id) { entries.emplace_back(page_id, frame_id); });
+  for (size_t i = 0; i <= mask_; i++) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+  size_ = 0;
+  tombstones_ = 0;
+  for (const auto &[page_id, frame_id] : entries) {
+    size_t i = Home(page_id);
+    while (slots_[i].load(std::memory_order_relaxed) != EMPTY) {
+      i = (i + 1) & mask_;
+    }
+    slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+    size_++;
+  }
+}
+
+}  // namespace bustub
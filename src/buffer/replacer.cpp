@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_pro_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+auto CreateReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer> {
+  switch (policy) {
+    case ReplacerPolicy::LRU:
+      return std::make_unique<LRUReplacer>(num_frames);
+    case ReplacerPolicy::Clock:
+      return std::make_unique<ClockReplacer>(num_frames);
+    case ReplacerPolicy::LRUK:
+      return std::make_unique<LRUKReplacer>(num_frames, k);
+    case ReplacerPolicy::ARC:
+      return std::make_unique<ARCReplacer>(num_frames);
+    case ReplacerPolicy::TwoQueue:
+      return std::make_unique<TwoQueueReplacer>(num_frames);
+    case ReplacerPolicy::ClockPro:
+      return std::make_unique<ClockProReplacer>(num_frames);
+  }
+  throw Exception(ExceptionType::INVALID, "unknown replacer policy");
+}
+
+}  // namespace bustub
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+// The paper recommends Kin = 25% of the pages and Kout = 50%.
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames)
+    : frames_(num_frames), a1in_target_size_(std::max<size_t>(1, num_frames / 4)),
+      a1out_size_(std::max<size_t>(1, num_frames / 2)) {}
+
+auto TwoQueueReplacer::FindVictim(std::list<frame_id_t> *queue) -> std::list<frame_id_t>::iterator {
+  return std::find_if(queue->begin(), queue->end(), [this](frame_id_t fid) { return frames_[fid].is_evictable_; });
+}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  bool from_a1in = PreferA1in(a1in_.size());
+  auto victim = FindVictim(from_a1in ? &a1in_ : &am_);
+  if (victim == (from_a1in ? a1in_.end() : am_.end())) {
+    // Every frame of the preferred queue is pinned.
+    from_a1in = !from_a1in;
+    victim = FindVictim(from_a1in ? &a1in_ : &am_);
+  }
+  *frame_id = *victim;
+  auto &frame = frames_[*frame_id];
+  (from_a1in ? a1in_ : am_).erase(victim);
+  if (from_a1in && frame.page_id_ != INVALID_PAGE_ID && a1out_index_.count(frame.page_id_) == 0) {
+    a1out_index_[frame.page_id_] = a1out_.insert(a1out_.end(), frame.page_id_);
+    if (a1out_.size() > a1out_size_) {
+      a1out_index_.erase(a1out_.front());
+      a1out_.pop_front();
+    }
+  }
+  frame = Frame();
+  curr_size_--;
+  return true;
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (frame.is_tracked_) {
+    // Hits in A1in are ignored; hits in Am refresh the page unless they come from a scan.
+    if (frame.in_am_ && !is_scan) {
+      am_.splice(am_.end(), am_, frame.pos_);
+    }
+    return;
+  }
+
+  frame.is_tracked_ = true;
+  frame.in_am_ = false;
+  auto ghost = a1out_index_.find(frame.page_id_);
+  if (ghost != a1out_index_.end()) {
+    frame.in_am_ = !is_scan;
+    a1out_.erase(ghost->second);
+    a1out_index_.erase(ghost);
+  }
+  auto &queue = frame.in_am_ ? am_ : a1in_;
+  frame.pos_ = queue.insert(queue.end(), frame_id);
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.is_tracked_ || frame.is_evictable_ == set_evictable) {
+    return;
+  }
+  frame.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.is_tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(frame.is_evictable_, "Cannot remove a non-evictable frame.");
+  (frame.in_am_ ? am_ : a1in_).erase(frame.pos_);
+  frame = Frame();
+  curr_size_--;
+}
+
+auto TwoQueueReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  // Replay Evict() without changing anything: A1in shrinks with every victim taken from it.
+  std::vector<frame_id_t> frames;
+  auto a1in_size = a1in_.size();
+  auto a1in_it = FindVictim(&a1in_);
+  auto am_it = FindVictim(&am_);
+  auto next_evictable = [this](std::list<frame_id_t>::iterator it, std::list<frame_id_t>::iterator end) {
+    return std::find_if(std::next(it), end, [this](frame_id_t fid) { return frames_[fid].is_evictable_; });
+  };
+  while (frames.size() < max_frames && (a1in_it != a1in_.end() || am_it != am_.end())) {
+    bool from_a1in = PreferA1in(a1in_size);
+    if (from_a1in ? a1in_it == a1in_.end() : am_it == am_.end()) {
+      from_a1in = !from_a1in;
+    }
+    if (from_a1in) {
+      frames.push_back(*a1in_it);
+      a1in_it = next_evictable(a1in_it, a1in_.end());
+      a1in_size--;
+    } else {
+      frames.push_back(*am_it);
+      am_it = next_evictable(am_it, am_.end());
+    }
+  }
+  return frames;
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return curr_size_;
+}
+
+void TwoQueueReplacer::SetPageId(frame_id_t frame_id, page_id_t page_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  std::scoped_lock lock(latch_);
+  frames_[frame_id].page_id_ = page_id;
+}
+
+}  // namespace bustub
@@ -33,6 +33,7 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/index/key_encoder.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -44,8 +45,8 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
 BustubInstance::BustubInstance(const std::string &db_file_name) {
   enable_logging = false;
 
-  // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  // Storage related. Pages of a database file carry checksums, so that bustub-verify can check them.
+  disk_manager_ = new DiskManager(db_file_name, false, DiskSyncPolicy::OnFlush, true);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
@@ -232,21 +233,26 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
 
         std::vector<uint32_t> col_ids;
         for (const auto &col : index_stmt.cols_) {
-          auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
-          col_ids.push_back(idx);
-          if (index_stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-            throw NotImplementedException("only support creating index on integer column");
-          }
-        }
-        if (col_ids.size() != 1) {
-          throw NotImplementedException("only support creating index with exactly one column");
+          col_ids.push_back(index_stmt.table_->schema_.GetColIdx(col->col_name_.back()));
         }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
+        if (KeyEncoder::EncodedSize(key_schema) > Catalog::MAX_INDEX_KEY_SIZE) {
+          throw NotImplementedException(fmt::format("index keys take more than {} bytes", Catalog::MAX_INDEX_KEY_SIZE));
+        }
+
+        // `SET index_internal_layout = eytzinger` picks the layout of the internal pages of the indexes created after.
+        auto internal_layout = StringUtil::Lower(GetSessionVariable("index_internal_layout")) == "eytzinger"
+                                   ? InternalPageLayout::EYTZINGER
+                                   : InternalPageLayout::SORTED;
+        if (internal_layout == InternalPageLayout::EYTZINGER &&
+            KeyEncoder::EncodedSize(key_schema) > EYTZINGER_MAX_KEY_SIZE) {
+          throw NotImplementedException(
+              fmt::format("eytzinger internal pages need index keys of at most {} bytes", EYTZINGER_MAX_KEY_SIZE));
+        }
 
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-            txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+        auto info = catalog_->CreateIndex(txn, index_stmt.index_name_, index_stmt.table_->table_,
+                                          index_stmt.table_->schema_, key_schema, col_ids, internal_layout);
         l.unlock();
 
         if (info == nullptr) {
@@ -20,4 +20,10 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds bpm_flusher_interval = std::chrono::milliseconds(10);
+
+bool bpm_use_huge_pages = true;
+
+int bpm_numa_node = -1;
+
 }  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define BUSTUB_HAS_SSE42_CRC32C
+#endif
+
+namespace bustub {
+
+/** The reflected Castagnoli polynomial. */
+static constexpr uint32_t CRC32C_POLY = 0x82F63B78;
+
+static auto MakeCrc32cTable() -> std::array<uint32_t, 256> {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLY : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+static auto ComputeSoftware(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  static const std::array<uint32_t, 256> TABLE = MakeCrc32cTable();
+  for (size_t i = 0; i < length; i++) {
+    crc = TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#ifdef BUSTUB_HAS_SSE42_CRC32C
+__attribute__((target("sse4.2"))) static auto ComputeHardware(const char *data, size_t length, uint32_t crc)
+    -> uint32_t {
+  uint64_t crc64 = crc;
+  for (; length >= sizeof(uint64_t); data += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; length > 0; data++, length--) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data));
+  }
+  return crc;
+}
+#endif
+
+auto Crc32c::IsHardwareAccelerated() -> bool {
+#ifdef BUSTUB_HAS_SSE42_CRC32C
+  static const bool HAS_SSE42 = __builtin_cpu_supports("sse4.2");
+  return HAS_SSE42;
+#else
+  return false;
+#endif
+}
+
+auto Crc32c::Compute(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  crc = ~crc;
+#ifdef BUSTUB_HAS_SSE42_CRC32C
+  if (IsHardwareAccelerated()) {
+    return ~ComputeHardware(data, length, crc);
+  }
+#endif
+  return ~ComputeSoftware(data, length, crc);
+}
+
+}  // namespace bustub
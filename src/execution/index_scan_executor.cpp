@@ -11,12 +11,53 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include "common/exception.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexScanExecutor::Init() {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  auto *txn = GetExecutorContext()->GetTransaction();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info_->table_name_);
 
-void IndexScanExecutor::Init() { throw NotImplementedException("IndexScanExecutor is not implemented"); }
+  rids_.clear();
+  cursor_ = 0;
+  scan_cursor_ = IndexScanCursor();
+  const auto &key_values = plan_->GetKeyValues();
+  if (key_values.empty()) {
+    // Scans of all keys fetch their RIDs in Next(), a batch at a time.
+    return;
+  }
+  scan_cursor_.done_ = true;
+  Tuple key(key_values, &index_info_->key_schema_);
+  try {
+    index_info_->index_->ScanKey(key, &rids_, txn);
+  } catch (const Exception &e) {
+    // A key too long for the index cannot have been inserted into it.
+    if (e.GetType() != ExceptionType::OUT_OF_RANGE) {
+      throw;
+    }
+  }
+}
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  auto *txn = GetExecutorContext()->GetTransaction();
+  while (true) {
+    while (cursor_ < rids_.size()) {
+      *rid = rids_[cursor_++];
+      if (table_info_->table_->GetTuple(*rid, tuple, txn)) {
+        return true;
+      }
+    }
+    rids_.clear();
+    cursor_ = 0;
+    if (!index_info_->index_->ScanRangeBatch(nullptr, nullptr, plan_->IsReverse(), &scan_cursor_, &rids_, txn)) {
+      return false;
+    }
+  }
+}
 
 }  // namespace bustub
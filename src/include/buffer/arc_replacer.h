@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST 2003).
+ *
+ * Resident frames are kept in two LRU lists: T1 holds pages seen once since they were brought in, T2 pages seen at
+ * least twice. Two ghost lists, B1 and B2, remember the ids of the pages recently evicted from T1 and T2. A page that
+ * comes back while in B1 means T1 was too small, one in B2 that T2 was, and the target size of T1 moves accordingly.
+ * Evict() takes the least recently used evictable frame of T1 while T1 is above its target, and of T2 otherwise.
+ *
+ * Ghost hits need page ids, so the buffer pool reports them with SetPageId(). Scan accesses never promote a page to
+ * T2 or move the target, which keeps a sequential scan from flooding T2.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the ARCReplacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+  void SetPageId(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  struct Frame {
+    bool is_tracked_{false};
+    bool is_evictable_{false};
+    /** Whether the frame is in T2 rather than T1. */
+    bool in_t2_{false};
+    std::list<frame_id_t>::iterator pos_;
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  struct Ghost {
+    /** Whether the page is in B2 rather than B1. */
+    bool in_b2_;
+    std::list<page_id_t>::iterator pos_;
+  };
+
+  /** @return true if the next victim should come from T1, given the number of frames currently in T1 */
+  auto PreferT1(size_t t1_size) const -> bool { return t1_size > 0 && t1_size > target_t1_size_; }
+
+  /** @return the least recently used evictable frame of the list, or end() if there is none */
+  auto FindVictim(std::list<frame_id_t> *list) -> std::list<frame_id_t>::iterator;
+
+  /** Remember an evicted page in B1 or B2. */
+  void AddGhost(page_id_t page_id, bool in_b2);
+
+  /** Forget a ghost page. */
+  void EraseGhost(std::unordered_map<page_id_t, Ghost>::iterator it);
+
+  /** Drop the oldest ghosts until |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. */
+  void TrimGhosts();
+
+  /** Resident frames, least recently used in front. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** Ids of recently evicted pages, least recently evicted in front. */
+  std::list<page_id_t> b1_;
+  std::list<page_id_t> b2_;
+  std::unordered_map<page_id_t, Ghost> ghosts_;
+  std::vector<Frame> frames_;
+  /** The target size of T1, p in the paper. */
+  size_t target_t1_size_{0};
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
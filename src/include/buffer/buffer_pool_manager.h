@@ -12,22 +12,69 @@
 
 #pragma once
 
+#include <array>
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <set>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_k_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/** Counters exposed by a BufferPoolManager for monitoring and benchmarks. */
+struct BufferPoolStats {
+  /** FetchPage() calls that found the page resident. */
+  uint64_t hits_;
+  /** FetchPage() calls that had to read the page from disk. */
+  uint64_t misses_;
+  /** Number of frames currently holding a dirty page. */
+  size_t dirty_pages_;
+  /** Dirty pages written back by the background flusher. */
+  uint64_t flusher_writes_;
+  /** Evictions that had to write a dirty victim back on the critical path of NewPage/FetchPage. */
+  uint64_t dirty_evictions_;
+  /** Evictions whose victim was already clean. */
+  uint64_t clean_evictions_;
+  /** Pages read in by PrefetchPage(). */
+  uint64_t prefetch_reads_;
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * The frames can be partitioned into shards. Every page id maps to exactly one shard (page_id % num_shards), and each
+ * shard has its own page table, free list, replacer and latch, so threads working on pages of different shards never
+ * contend. With one shard this is a plain buffer pool behind a single latch.
+ *
+ * Fetching a page that is already resident, and unpinning it, takes no latch at all: the page table is looked up
+ * lock-free, the pin count is raised with a compare-and-swap, and the frame is checked to still hold the page once it
+ * is pinned. Frames are only reused after swapping a pin count of 0 for -1, so a pinned frame stays put. The replacer
+ * is not thread-safe, so these accesses go to a small per-shard log that is handed to the replacer in one batch under
+ * the latch, before it picks a victim or when the log is full.
+ *
+ * The replacement policy is picked at construction time: LRU-K suits point lookups, while 2Q or ARC hold up better
+ * against large scans. Each shard gets its own replacer of that policy.
+ *
+ * Deleted pages are deallocated in the disk manager's allocation map and handed out again by NewPage(), lowest page id
+ * first, so the database file only grows when there is no free page left. Deallocations become durable with
+ * FlushAllPages(), once no page on disk can refer to the deleted pages any more.
+ *
+ * Pages can be grouped into segments (see DiskManager), which keeps a table or an index in a file of its own and lets
+ * it be dropped in one go.
  */
 class BufferPoolManager {
  public:
@@ -36,10 +83,13 @@ class BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
-   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param log_manager the log manager, nullptr to run without logging
+   * @param num_shards the number of independently latched shards to split the frames into
+   * @param replacer_policy the replacement policy each shard uses to pick victims
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, size_t num_shards = 1,
+                    ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
@@ -52,51 +102,41 @@ class BufferPoolManager {
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return the number of shards the buffer pool is split into. */
+  auto GetNumShards() -> size_t { return shards_.size(); }
+
   /**
-   * TODO(P1): Add implementation
+   * @brief Create a new, zeroed page in the buffer pool, pinned once.
    *
-   * @brief Create a new page in the buffer pool. Set page_id to the new page's id, or nullptr if all frames
-   * are currently in use and not evictable (in another word, pinned).
-   *
-   * You should pick the replacement frame from either the free list or the replacer (always find from the free list
-   * first), and then call the AllocatePage() method to get a new page id. If the replacement frame has a dirty page,
-   * you should write it back to the disk first. You also need to reset the memory and metadata for the new page.
-   *
-   * Remember to "Pin" the frame by calling replacer.SetEvictable(frame_id, false)
-   * so that the replacer wouldn't evict the frame before the buffer pool manager "Unpin"s it.
-   * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
+   * The shards are tried round-robin, each under its own latch, until one has a frame to spare: a free frame, or else
+   * the replacer's victim once the shard's access log has been applied, claimed with ClaimFrame() and written back
+   * first if it is dirty. The page id is allocated in the given segment, reusing the lowest deallocated id of the
+   * shard if there is one.
    *
    * @param[out] page_id id of created page
-   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   * @param segment_id the segment to create the page in
+   * @return nullptr if the segment does not exist or every frame is pinned, otherwise pointer to new page
    */
-  auto NewPage(page_id_t *page_id) -> Page *;
+  auto NewPage(page_id_t *page_id, segment_id_t segment_id = DEFAULT_SEGMENT_ID) -> Page *;
 
   /**
-   * TODO(P1): Add implementation
-   *
-   * @brief PageGuard wrapper for NewPage
-   *
-   * Functionality should be the same as NewPage, except that
-   * instead of returning a pointer to a page, you return a
-   * BasicPageGuard structure.
+   * @brief Like NewPage(), but returns the page in a BasicPageGuard, which unpins it when dropped.
    *
    * @param[out] page_id, the id of the new page
+   * @param segment_id the segment to create the page in
    * @return BasicPageGuard holding a new page
    */
-  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+  auto NewPageGuarded(page_id_t *page_id, segment_id_t segment_id = DEFAULT_SEGMENT_ID) -> BasicPageGuard;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Fetch the requested page from the buffer pool. Return nullptr if page_id needs to be fetched from the disk
-   * but all frames are currently in use and not evictable (in another word, pinned).
-   *
-   * First search for page_id in the buffer pool. If not found, pick a replacement frame from either the free list or
-   * the replacer (always find from the free list first), read the page from disk by calling disk_manager_->ReadPage(),
-   * and replace the old page in the frame. Similar to NewPage(), if the old page is dirty, you need to write it back
-   * to disk and update the metadata of the new page
+   * but all frames are currently in use and not evictable (in another word, pinned), or if the page cannot be read,
+   * e.g. because it failed its checksum.
    *
-   * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
+   * A resident page is found and pinned without the shard latch, see TryPinResident(), and the access goes to the
+   * shard's access log, which the replacer is handed in one batch later. Otherwise the shard latch is taken: a page
+   * still being prefetched is pinned and waited for with the latch released, and a page that is not resident is read
+   * from disk into a frame found like in NewPage().
    *
    * @param page_id id of page to be fetched
    * @param access_type type of access to the page, only needed for leaderboard tests.
@@ -105,14 +145,23 @@ class BufferPoolManager {
   auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
 
   /**
-   * TODO(P1): Add implementation
+   * @brief Start reading a page into the buffer pool without waiting for it and without pinning it. Used for
+   * read-ahead: a later FetchPage() of the page finds it resident, or waits only for the rest of the read.
    *
-   * @brief PageGuard wrappers for FetchPage
+   * Prefetching is best effort. Nothing happens if the page is already resident, and the prefetch is dropped if the
+   * page's shard has no free or evictable frame.
+   *
+   * @param page_id id of page to be prefetched
+   * @param access_type type of access recorded for the prefetched page
+   * @return false if the page is neither resident nor being read in
+   */
+  auto PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Scan) -> bool;
+
+  /**
+   * @brief Fetch and pin a page like FetchPage(), and return it in a guard that unpins it when dropped.
    *
-   * Functionality should be the same as FetchPage, except
-   * that, depending on the function called, a guard is returned.
-   * If FetchPageRead or FetchPageWrite is called, it is expected that
-   * the returned page already has a read or write latch held, respectively.
+   * FetchPageRead and FetchPageWrite also take the read or write latch of the page, which the guard releases.
+   * FetchPageOptimistic takes no latch and records the version of the page instead.
    *
    * @param page_id, the id of the page to fetch
    * @return PageGuard holding the fetched page
@@ -120,15 +169,25 @@ class BufferPoolManager {
   auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
   auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
   auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard;
 
   /**
-   * TODO(P1): Add implementation
+   * Like FetchPageRead, but gives up rather than wait for the read latch, so that a thread can latch pages against
+   * the order it usually latches them in without deadlocking.
    *
+   * @param page_id, the id of the page to fetch
+   * @param[out] guard the read latched page
+   * @return false if the page could not be fetched or a writer holds its latch
+   */
+  auto TryFetchPageRead(page_id_t page_id, ReadPageGuard *guard) -> bool;
+
+  /**
    * @brief Unpin the target page from the buffer pool. If page_id is not in the buffer pool or its pin count is already
    * 0, return false.
    *
-   * Decrement the pin count of a page. If the pin count reaches 0, the frame should be evictable by the replacer.
-   * Also, set the dirty flag on the page to indicate if the page was modified.
+   * Takes no shard latch. The dirty flag is set while the page is still pinned, so it cannot be evicted unwritten, and
+   * the pin count is lowered with a compare-and-swap. The unpin that brings it to 0 goes to the shard's access log,
+   * and the replacer makes the frame evictable when the log is applied.
    *
    * @param page_id id of page to be unpinned
    * @param is_dirty true if the page should be marked as dirty, false otherwise
@@ -138,12 +197,11 @@ class BufferPoolManager {
   auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Flush the target page to disk.
    *
-   * Use the DiskManager::WritePage() method to flush a page to disk, REGARDLESS of the dirty flag.
-   * Unset the dirty flag of the page after flushing.
+   * The page is written whether it is dirty or not, and its dirty flag is cleared, under the shard latch; a prefetch
+   * of the page is waited for first. The write is then made durable according to the disk manager's sync policy
+   * (DiskManager::Sync()), without holding the latch.
    *
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
@@ -151,62 +209,269 @@ class BufferPoolManager {
   auto FlushPage(page_id_t page_id) -> bool;
 
   /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk, then make them durable with one DiskManager::Sync().
+   * Afterwards the pages deleted before the flush are durably deallocated as well.
    */
   void FlushAllPages();
 
   /**
-   * TODO(P1): Add implementation
+   * @brief Start a background thread that writes dirty, unpinned pages back before they are chosen for eviction, so
+   * that NewPage/FetchPage almost always find a clean victim.
    *
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
-   * page is pinned and cannot be deleted, return false immediately.
+   * Whenever the fraction of dirty frames reaches high_watermark, the flusher walks each shard's frames in replacer
+   * order (next victim first) and writes dirty, unpinned pages until the fraction is down to low_watermark. It also
+   * re-checks every bpm_flusher_interval. Calling this again while the flusher runs only changes the watermarks.
    *
-   * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
-   * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * @param high_watermark fraction of dirty frames at which the flusher starts writing
+   * @param low_watermark fraction of dirty frames the flusher writes down to
+   */
+  void StartBackgroundFlusher(double high_watermark = BPM_FLUSHER_HIGH_WATERMARK,
+                              double low_watermark = BPM_FLUSHER_LOW_WATERMARK);
+
+  /** @brief Stop the background flusher, if it is running. */
+  void StopBackgroundFlusher();
+
+  /** @brief Return a snapshot of the buffer pool counters. */
+  auto GetStats() -> BufferPoolStats;
+
+  /**
+   * @brief Delete a page from the buffer pool and deallocate it on disk. If page_id is not in the buffer pool, only
+   * deallocate it and return true. If the page is pinned and cannot be deleted, return false immediately.
+   *
+   * Under the shard latch, the frame is claimed with ClaimFrame(), which fails if the page was pinned without the latch
+   * meanwhile. The frame is then dropped from the page table and the replacer, zeroed and put on the free list, and
+   * the page id is deallocated, so that NewPage() can reuse it.
    *
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
   auto DeletePage(page_id_t page_id) -> bool;
 
+  /**
+   * @brief Create a segment to keep a set of pages, such as those of one table, in a file of their own. If the disk
+   * manager cannot create any more segments, the pages go to the default segment instead.
+   * @return the id of the segment to pass to NewPage()
+   */
+  auto CreateSegment() -> segment_id_t;
+
+  /**
+   * @brief Drop a segment and all of its pages at once, without writing any of them back. The default segment cannot
+   * be dropped.
+   * @param segment_id the segment to drop
+   * @return false if the segment does not exist or one of its pages is pinned
+   */
+  auto DropSegment(segment_id_t segment_id) -> bool;
+
  private:
+  /**
+   * A shard owns a contiguous slice of the frames and all pages whose id maps to it. Frame ids are global indexes into
+   * pages_; the shard's replacer is indexed by the frame's offset within the slice.
+   */
+  struct Shard {
+    Shard(size_t index, frame_id_t first_frame_id, size_t num_frames, std::unique_ptr<Replacer> replacer);
+
+    /** The page ids a shard hands out in one segment. */
+    struct SegmentPages {
+      /** The next fresh page id. Shards allocate disjoint, interleaved page ids. */
+      page_id_t next_page_id_;
+      /** Deallocated page ids below next_page_id_, reused lowest first. */
+      std::set<page_id_t> free_pages_;
+    };
+
+    /** The position of this shard, which is also the remainder of its page ids modulo the number of shards. */
+    const size_t index_;
+    /** The first frame owned by this shard. */
+    const frame_id_t first_frame_id_;
+    /** Page id allocation per segment, set up from the disk manager when the shard first allocates in a segment. */
+    std::unordered_map<segment_id_t, SegmentPages> segment_pages_;
+    /** Page table for keeping track of the pages held by this shard. Lookups take no latch. */
+    PageTable page_table_;
+    /** Replacer to find unpinned frames of this shard for replacement. */
+    std::unique_ptr<Replacer> replacer_;
+    /** List of free frames of this shard that don't have any pages on them. */
+    std::list<frame_id_t> free_list_;
+    /** Frames being filled by PrefetchPage(), with the read that fills them. They are not evictable until the read
+     * has completed and the prefetch is reaped. */
+    std::unordered_map<frame_id_t, std::shared_future<bool>> pending_reads_;
+    /** Protects the page table, free list, replacer and page id allocation of this shard, and the metadata of its
+     * frames except for the pin counts and dirty flags. Page table lookups and pins of resident pages need no latch. */
+    std::mutex latch_;
+    /** Accesses and unpins of resident pages made without the latch, which the replacer has not seen yet. Each entry
+     * is packed by MakeAccess(); NO_ACCESS marks a slot that is free or whose entry is still being written. */
+    alignas(CACHE_LINE_SIZE) std::array<std::atomic<uint64_t>, BPM_ACCESS_LOG_SIZE> access_log_;
+    /** The number of slots of access_log_ handed out. Runs past the end while the log is full or being applied. */
+    std::atomic<size_t> access_log_size_{0};
+    /** FetchPage() calls of this shard that found the page resident. */
+    std::atomic<uint64_t> hits_{0};
+  };
+
+  /** The kind of an access log entry that records an unpin rather than an access. */
+  static constexpr uint32_t UNPIN_ACCESS = 7;
+  /** An empty access log slot. */
+  static constexpr uint64_t NO_ACCESS = UINT64_MAX;
+
+  /** @return an access log entry for an access of the given kind (an AccessType or UNPIN_ACCESS) to a frame */
+  static auto MakeAccess(page_id_t page_id, frame_id_t frame_id, uint32_t kind) -> uint64_t {
+    return static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32 | static_cast<uint64_t>(frame_id) << 3 | kind;
+  }
+
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
+  /** The shard NewPage() tries first, rotated to spread new pages evenly. */
+  std::atomic<size_t> next_shard_ = 0;
 
-  /** Array of buffer pool pages. */
+  /** The data of all frames. */
+  std::unique_ptr<FrameArena> frame_arena_;
+  /** Array of buffer pool pages, i.e. the metadata of the frames. */
   Page *pages_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. Please ignore this for P1. */
+  DiskManager *disk_manager_;
+  /** Issues the I/O that does not need to be waited for one page at a time: batched flushes and prefetches. */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
+  /** Pointer to the log manager, nullptr if logging is disabled. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /** The shards the frames are split into. */
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::atomic<uint64_t> misses_{0};
+  /** Number of frames holding a dirty page. */
+  std::atomic<size_t> num_dirty_{0};
+  std::atomic<uint64_t> flusher_writes_{0};
+  std::atomic<uint64_t> dirty_evictions_{0};
+  std::atomic<uint64_t> clean_evictions_{0};
+  std::atomic<uint64_t> prefetch_reads_{0};
+
+  /** The background flusher thread, joinable while the flusher runs. */
+  std::thread flusher_thread_;
+  /** Protects flusher_stop_ and starting / stopping the flusher. */
+  std::mutex flusher_latch_;
+  std::condition_variable flusher_cv_;
+  bool flusher_stop_{false};
+  /** Number of dirty frames at which the flusher starts writing; 0 while it is not running. */
+  std::atomic<size_t> flusher_high_watermark_{0};
+  /** Number of dirty frames the flusher writes down to. */
+  std::atomic<size_t> flusher_low_watermark_{0};
+
+  /** @return the shard responsible for the given page */
+  auto GetShard(page_id_t page_id) -> Shard & { return *shards_[page_id % shards_.size()]; }
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
-   * @return the id of the allocated page
+   * @brief Find a frame to hold a new page, from the free list first and then from the replacer. If the evicted page
+   * is dirty, it is written back first. The frame is removed from the page table and its memory is reset. Caller
+   * should acquire the shard latch before calling this function.
+   * @param shard the shard to take the frame from
+   * @param[out] frame_id id of the frame
+   * @return false if every frame of the shard is pinned
    */
-  auto AllocatePage() -> page_id_t;
+  auto AcquireFrame(Shard &shard, frame_id_t *frame_id) -> bool;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
-   * @param page_id id of the page to deallocate
+   * @brief Take a frame for reuse by swapping its pin count of 0 for -1, so that nobody can pin it meanwhile. Caller
+   * should acquire the shard latch before calling this function.
+   * @return false if the frame is pinned
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
+  static auto ClaimFrame(Page *page) -> bool {
+    int pin_count = 0;
+    return page->pin_count_.compare_exchange_strong(pin_count, -1, std::memory_order_acquire);
   }
 
-  // TODO(student): You may add additional private members and helper functions
+  /**
+   * @brief Put a page into a claimed frame and make it visible to lookups, with the given pin count. The replacer
+   * still has to be told about the access. Caller should acquire the shard latch before calling this function.
+   */
+  void InstallPage(Shard &shard, frame_id_t frame_id, page_id_t page_id, int pin_count);
+
+  /**
+   * @brief Pin a resident page without the shard latch.
+   * @param page_id the page to pin
+   * @param frame_id the frame the page table had for the page, which may hold another page by now
+   * @return false if the frame does not hold the page, is being reused or is still being read into; the caller then
+   * has to look again under the latch
+   */
+  auto TryPinResident(Shard &shard, page_id_t page_id, frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Append an entry to the access log of a shard. If the log is full, apply it first. Caller must not hold
+   * the shard latch.
+   */
+  void LogAccess(Shard &shard, uint64_t access);
+
+  /**
+   * @brief Tell the replacer about the accesses and unpins logged by threads that took no latch, and empty the log.
+   * Caller should acquire the shard latch before calling this function.
+   */
+  void ApplyAccessLog(Shard &shard);
+
+  /**
+   * @brief Synchronously read or write the page held by a frame.
+   * @param is_write true to write the frame out, false to read the page into the frame
+   * @param page_id the page to read or write
+   * @param frame_id the frame holding the page
+   * @return false if the page could not be read
+   */
+  auto DoPageIO(bool is_write, page_id_t page_id, frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Drop the page held by a claimed frame without writing it back, and return the frame to the free list.
+   * Caller should acquire the shard latch before calling this function.
+   */
+  void DiscardFrame(Shard &shard, frame_id_t frame_id);
+
+  /**
+   * @brief Finish the prefetches of a shard whose reads have completed, and make their frames evictable if nobody
+   * pinned them meanwhile. Pages that could not be read are dropped; while they are still pinned by threads waiting
+   * for them, their prefetch stays outstanding and those threads drop them. Caller should acquire the shard latch
+   * before calling this function.
+   * @param wait if true, wait for all outstanding prefetches of the shard instead of only the completed ones
+   */
+  void ReapPrefetches(Shard &shard, bool wait);
+
+  /** @brief Mark a frame's page clean. Caller should acquire the shard latch before calling this function. */
+  void ClearDirty(Page *page);
+
+  /** @brief Main loop of the background flusher thread. */
+  void RunFlusher();
+
+  /**
+   * @brief Write back up to max_pages dirty, unpinned pages, taking each shard's next eviction victims first.
+   * @return the number of pages written
+   */
+  auto FlushVictims(size_t max_pages) -> size_t;
+
+  /**
+   * @brief Write back the page in a frame if it is dirty and unpinned. The page is pinned and read latched during the
+   * write, so the shard latch is not held across the I/O.
+   * @return true if the page was written
+   */
+  auto FlushUnpinnedFrame(Shard &shard, frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Pin a frame that holds a page and record the access. Caller should acquire the shard latch before calling
+   * this function.
+   */
+  void PinFrame(Shard &shard, frame_id_t frame_id, AccessType access_type);
+
+  /**
+   * @brief Return the page id allocation of a shard in a segment, setting it up if needed. Caller should acquire the
+   * shard latch before calling this function.
+   */
+  auto GetSegmentPages(Shard &shard, segment_id_t segment_id) -> Shard::SegmentPages &;
+
+  /**
+   * @brief Allocate a page on disk, reusing a free page of the shard if there is one. Caller should acquire the shard
+   * latch before calling this function.
+   * @param shard the shard the page will belong to
+   * @param segment_id the segment the page will belong to
+   * @return the id of the allocated page
+   */
+  auto AllocatePage(Shard &shard, segment_id_t segment_id) -> page_id_t;
+
+  /**
+   * @brief Deallocate a page on disk and keep its id for reuse. Caller should acquire the shard latch before calling
+   * this function.
+   * @param shard the shard the page belongs to
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(Shard &shard, page_id_t page_id);
 };
 }  // namespace bustub
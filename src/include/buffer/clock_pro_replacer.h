@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.h
+//
+// Identification: src/include/buffer/clock_pro_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ClockProReplacer implements CLOCK-Pro (Jiang, Chen and Zhang, USENIX ATC 2005), a clock approximation of LIRS.
+ *
+ * Resident pages are hot or cold. A single clock holds both, plus non-resident cold pages that were evicted recently.
+ * A newly brought in page is cold and in its test period; if it is accessed again before the test period ends, even
+ * after it has been evicted, its reuse distance is short and it becomes hot. Three hands walk the clock:
+ *  - HAND_cold evicts unreferenced cold pages, and promotes referenced ones that are in their test period;
+ *  - HAND_hot demotes unreferenced hot pages when there are too many, and ends the test periods it passes;
+ *  - HAND_test ends test periods and drops non-resident pages when too many are remembered.
+ * The number of frames given to cold pages adapts: it grows whenever a page is reaccessed during its test period and
+ * shrinks whenever a test period ends without one.
+ *
+ * Recognizing non-resident pages needs page ids, so the buffer pool reports them with SetPageId(). Scan accesses
+ * never set the reference bit, so scanned pages never turn hot.
+ */
+class ClockProReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ClockProReplacer.
+   * @param num_frames the maximum number of frames the ClockProReplacer will be required to store
+   */
+  explicit ClockProReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ClockProReplacer);
+
+  ~ClockProReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  /**
+   * Unlike the other replacers, this is only an approximation of the eviction order: evicting changes the status of
+   * the pages the hands pass, which is not replayed here. Unreferenced cold frames are listed first, then referenced
+   * cold frames, then hot frames, each in clock order.
+   */
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+  void SetPageId(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  struct Entry {
+    page_id_t page_id_;
+    /** The frame holding the page, or -1 if the page is not resident. */
+    frame_id_t frame_id_;
+    bool is_hot_{false};
+    bool is_referenced_{false};
+    bool in_test_{false};
+  };
+  using EntryIterator = std::list<Entry>::iterator;
+
+  struct Frame {
+    bool is_tracked_{false};
+    bool is_evictable_{false};
+    EntryIterator pos_;
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** @return the entry after it, wrapping around the end of the clock */
+  auto Next(EntryIterator it) -> EntryIterator;
+
+  /** Insert an entry at the head of the clock, i.e. right behind HAND_hot, the last place the hands reach. */
+  auto Insert(Entry entry) -> EntryIterator;
+
+  /** Remove an entry from the clock, moving any hand pointing at it to the next entry. */
+  void Erase(EntryIterator it);
+
+  /** Move HAND_hot until it has demoted one hot page. */
+  void RunHandHot();
+
+  /** Move HAND_test until it has dropped one non-resident page. */
+  void RunHandTest();
+
+  /** End the test period of a cold page that was not reaccessed, shrinking the cold target. */
+  void EndTestPeriod(Entry *entry);
+
+  /** Turn the frame of a resident cold entry into a victim. */
+  void EvictEntry(EntryIterator it);
+
+  /** @return the number of hot pages allowed */
+  auto HotTarget() const -> size_t { return frames_.size() - cold_target_; }
+
+  /** The clock, in the order the hands move. */
+  std::list<Entry> clock_;
+  EntryIterator hand_hot_;
+  EntryIterator hand_cold_;
+  EntryIterator hand_test_;
+  /** Non-resident cold pages still in their test period. */
+  std::unordered_map<page_id_t, EntryIterator> non_resident_;
+  std::vector<Frame> frames_;
+  /** The number of frames cold pages should get, m_c in the paper. */
+  size_t cold_target_;
+  size_t num_hot_{0};
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -37,16 +37,32 @@ class ClockReplacer : public Replacer {
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  struct Entry {
+    bool is_tracked_{false};
+    bool is_evictable_{false};
+    /** The reference bit, set by every access and cleared as the clock hand passes. */
+    bool is_referenced_{false};
+  };
+
+  /** One slot per frame, in clock order. */
+  std::vector<Entry> entries_;
+  /** The next slot the clock hand looks at. */
+  size_t hand_{0};
+  size_t curr_size_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of all frames of a buffer pool in one contiguous, page-aligned mapping, apart from the
+ * frame metadata. Frame i starts at i * BUSTUB_PAGE_SIZE.
+ *
+ * With huge pages requested, the arena is rounded up to 2 MB and mapped with MAP_HUGETLB. If the system has no huge
+ * pages reserved, it falls back to regular pages and asks for transparent huge pages instead. With a NUMA node given,
+ * the memory is preferably placed on that node; this is a hint and never makes the allocation fail.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map the memory for the frames.
+   * @param num_frames the number of frames
+   * @param use_huge_pages whether to back the arena with 2 MB pages when possible
+   * @param numa_node the NUMA node to place the memory on, or -1 for the default placement
+   */
+  FrameArena(size_t num_frames, bool use_huge_pages, int numa_node);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the data of the given frame, BUSTUB_PAGE_SIZE bytes aligned to BUSTUB_PAGE_SIZE */
+  auto GetFrameData(frame_id_t frame_id) -> char * { return data_ + static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE; }
+
+  /** @return true if the arena is backed by MAP_HUGETLB pages */
+  auto UsesHugePages() const -> bool { return uses_huge_pages_; }
+
+  /** @return true if the arena was bound to the requested NUMA node */
+  auto IsNumaBound() const -> bool { return is_numa_bound_; }
+
+ private:
+  char *data_{nullptr};
+  /** The size of the mapping, a multiple of the page size backing it. */
+  size_t size_{0};
+  bool uses_huge_pages_{false};
+  bool is_numa_bound_{false};
+};
+
+}  // namespace bustub
@@ -15,25 +15,67 @@
 #include <limits>
 #include <list>
 #include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Get, Scan };
-
 class LRUKNode {
+ public:
+  LRUKNode(frame_id_t fid, size_t k) : k_(k), fid_(fid) {}
+
+  /** Record an access at the given timestamp, keeping only the last k timestamps. */
+  void RecordAccess(size_t timestamp) {
+    history_.push_back(timestamp);
+    if (history_.size() > k_) {
+      history_.pop_front();
+    }
+  }
+
+  /**
+   * Record an access of a frame that has only ever been touched by scans. Only the latest access is kept: scanned
+   * pages are ordered LRU among themselves and never build up a k-distance.
+   */
+  void RecordScanAccess(size_t timestamp) {
+    history_.clear();
+    history_.push_back(timestamp);
+    is_scan_only_ = true;
+  }
+
+  /** Forget the scan accesses of a frame that is now accessed by something other than a scan. */
+  void ClearScanHistory() {
+    history_.clear();
+    is_scan_only_ = false;
+  }
+
+  /** @return true if this frame has been accessed at least k times, i.e. its backward k-distance is finite */
+  auto HasKAccesses() const -> bool { return history_.size() >= k_; }
+
+  /** @return the timestamp of the k-th most recent access, or of the earliest access if there are fewer than k */
+  auto GetEarliestTimestamp() const -> size_t { return history_.front(); }
+
+  auto GetFrameId() const -> frame_id_t { return fid_; }
+
+  auto IsEvictable() const -> bool { return is_evictable_; }
+
+  void SetEvictable(bool is_evictable) { is_evictable_ = is_evictable; }
+
+  /** @return true if every access to this frame so far was a scan */
+  auto IsScanOnly() const -> bool { return is_scan_only_; }
+
  private:
   /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
-
-  [[maybe_unused]] std::list<size_t> history_;
-  [[maybe_unused]] size_t k_;
-  [[maybe_unused]] frame_id_t fid_;
-  [[maybe_unused]] bool is_evictable_{false};
+  std::list<size_t> history_;
+  size_t k_;
+  frame_id_t fid_;
+  bool is_evictable_{false};
+  bool is_scan_only_{false};
 };
 
 /**
@@ -46,116 +88,102 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multipe frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * The replacer is scan resistant. Frames brought in and touched only by AccessType::Scan accesses sit in a
+ * probationary group that is evicted before any other frame, in LRU order, so one large sequential scan recycles its
+ * own frames instead of pushing out the hot pages. A scan access to a frame with other history does not change that
+ * history, and the first non-scan access moves a probationary frame into the regular LRU-K order.
+ *
+ * Evictable frames are kept in an ordered set keyed by their eviction order, so Evict() takes O(log n) instead of a
+ * scan over all frames, and EvictionCandidates() simply reads the front of the set.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
-   *
-   * TODO(P1): Add implementation
-   *
-   * @brief a new LRUKReplacer.
-   * @param num_frames the maximum number of frames the LRUReplacer will be required to store
+   * @brief Create a new LRUKReplacer.
+   * @param num_frames the maximum number of frames the LRUKReplacer will be required to store
+   * @param k the number of accesses the backward k-distance looks back
    */
   explicit LRUKReplacer(size_t num_frames, size_t k);
 
   DISALLOW_COPY_AND_MOVE(LRUKReplacer);
 
   /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Destroys the LRUReplacer.
+   * @brief Destroys the LRUKReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Find the frame with largest backward k-distance and evict that frame. Only frames
-   * that are marked as 'evictable' are candidates for eviction.
-   *
-   * A frame with less than k historical references is given +inf as its backward k-distance.
-   * If multiple frames have inf backward k-distance, then evict frame with earliest timestamp
-   * based on LRU.
-   *
-   * Successful eviction of a frame should decrement the size of replacer and remove the frame's
-   * access history.
+   * @brief Evict the first evictable frame in the eviction order: frames only ever accessed by scans, then frames
+   * with fewer than k accesses (+inf backward k-distance) by their earliest access, then the others by their backward
+   * k-distance, largest first. The frame's access history is dropped.
    *
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Record the event that the given frame id is accessed at current timestamp.
-   * Create a new entry for access history if frame id has not been seen before.
-   *
-   * If frame id is invalid (ie. larger than replacer_size_), throw an exception. You can
-   * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
+   * @brief Record an access to a frame at the current timestamp, tracking the frame if it was not tracked yet. A scan
+   * access only counts for a frame that has seen nothing but scans; the first other access drops those. Aborts if the
+   * frame id is not below the number of frames.
    *
    * @param frame_id id of frame that received a new access.
-   * @param access_type type of access that was received. This parameter is only needed for
-   * leaderboard tests.
+   * @param access_type type of access that was received
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Toggle whether a frame is evictable or non-evictable. This function also
-   * controls replacer's size. Note that size is equal to number of evictable entries.
-   *
-   * If a frame was previously evictable and is to be set to non-evictable, then size should
-   * decrement. If a frame was previously non-evictable and is to be set to evictable,
-   * then size should increment.
-   *
-   * If frame id is invalid, throw an exception or abort the process.
-   *
-   * For other scenarios, this function should terminate without modifying anything.
+   * @brief Mark a tracked frame evictable or not, which adds it to or removes it from the eviction order and the
+   * replacer's size. Does nothing for frames that are not tracked. Aborts if the frame id is not below the number of
+   * frames.
    *
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Remove an evictable frame from replacer, along with its access history.
-   * This function should also decrement replacer's size if removal is successful.
-   *
-   * Note that this is different from evicting a frame, which always remove the frame
-   * with largest backward k-distance. This function removes specified frame id,
-   * no matter what its backward k-distance is.
-   *
-   * If Remove is called on a non-evictable frame, throw an exception or abort the
-   * process.
-   *
-   * If specified frame is not found, directly return from this function.
+   * @brief Stop tracking an evictable frame, wherever it is in the eviction order, and drop its access history. Does
+   * nothing for frames that are not tracked, and aborts for frames that are not evictable.
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
-   * TODO(P1): Add implementation
+   * @brief List evictable frames in the order Evict() would choose them, without evicting anything. Used by the
+   * buffer pool's background flusher to clean the next victims ahead of time.
    *
+   * @param max_frames the maximum number of frames to return
+   * @return up to max_frames evictable frames, the next victim first
+   */
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /**
    * @brief Return replacer's size, which tracks the number of evictable frames.
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] std::unordered_map<frame_id_t, LRUKNode> node_store_;
-  [[maybe_unused]] size_t current_timestamp_{0};
-  [[maybe_unused]] size_t curr_size_{0};
-  [[maybe_unused]] size_t replacer_size_;
-  [[maybe_unused]] size_t k_;
-  [[maybe_unused]] std::mutex latch_;
+  /**
+   * Position of an evictable frame in the eviction order: scan-only frames first, then frames with +inf backward
+   * k-distance, then all others. Within each group, the frame whose earliest remembered access is oldest goes first.
+   */
+  using VictimKey = std::tuple<int, size_t, frame_id_t>;
+
+  static auto GetVictimKey(const LRUKNode &node) -> VictimKey;
+
+  std::unordered_map<frame_id_t, LRUKNode> node_store_;
+  /** The evictable frames, next victim first. */
+  std::set<VictimKey> evictable_;
+  size_t current_timestamp_{0};
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  size_t k_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <list>
 #include <mutex>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -37,16 +38,31 @@ class LRUReplacer : public Replacer {
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  struct Entry {
+    /** Position of the frame in lru_list_. */
+    std::list<frame_id_t>::iterator pos_;
+    bool is_evictable_{false};
+  };
+
+  /** Tracked frames, least recently used in front. */
+  std::list<frame_id_t> lru_list_;
+  std::unordered_map<frame_id_t, Entry> entries_;
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the page ids held by a buffer pool shard to their frames.
+ *
+ * It is an open addressing hash table with linear probing over a fixed array of slots, sized for the most pages the
+ * shard can hold. Each slot is one atomic word holding a page id and its frame, so Find() is lock-free: it never
+ * sees half an entry and never waits for a writer. Insert() and Remove() must be serialized by the caller (the shard
+ * latch). Removed entries leave tombstones behind, which a writer clears by rebuilding the table in place once they
+ * take up too many slots.
+ *
+ * A Find() running concurrently with a writer may miss an entry that is there, or return the frame of a page that is
+ * just being removed. Callers treat a miss as a hint to look again under the latch, and check a hit against the
+ * frame's page id once they have pinned it.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create an empty page table.
+   * @param max_entries the most entries the table holds at once, i.e. the number of frames of the shard
+   */
+  explicit PageTable(size_t max_entries);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * @brief Look up the frame holding a page, without any latch.
+   * @param page_id the page to look for
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page was found
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /**
+   * @brief Add a page that is not in the table yet. The caller must serialize writers.
+   * @param page_id the page, a valid page id
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove a page. The caller must serialize writers.
+   * @return false if the page was not in the table
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+  /** @return the number of pages in the table. The caller must serialize this with writers. */
+  auto Size() const -> size_t { return size_; }
+
+  /**
+   * @brief Call fn(page_id, frame_id) for every page in the table, in no particular order. The caller must serialize
+   * this with writers; fn must not change the table.
+   */
+  template <typename Fn>
+  void ForEach(Fn &&fn) const {
+    for (size_t i = 0; i <= mask_; i++) {
+      auto slot = slots_[i].load(std::memory_order_relaxed);
+      if (IsEntry(slot)) {
+        fn(GetPageId(slot), GetFrameId(slot));
+      }
+    }
+  }
+
+ private:
+  /** Slots that never held an entry end a probe. */
+  static constexpr uint64_t EMPTY = UINT64_MAX;
+  /** Slots whose entry was removed are skipped by a probe and reused by Insert(). */
+  static constexpr uint64_t TOMBSTONE = UINT64_MAX - 1;
+
+  static auto MakeSlot(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32 | static_cast<uint32_t>(frame_id);
+  }
+  static auto GetPageId(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto GetFrameId(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & UINT32_MAX); }
+  /** Both markers have INVALID_PAGE_ID in the page id half, which no entry has. */
+  static auto IsEntry(uint64_t slot) -> bool { return GetPageId(slot) != INVALID_PAGE_ID; }
+
+  /** @return the slot a probe for page_id starts at */
+  auto Home(page_id_t page_id) const -> size_t {
+    // A shard's page ids are all congruent modulo the number of shards, so scramble them before taking the low bits.
+    return static_cast<size_t>((static_cast<uint32_t>(page_id) * 0x9E3779B97F4A7C15ULL) >> 32) & mask_;
+  }
+
+  /** Put back all entries without tombstones in between. Concurrent Find() calls may miss entries meanwhile. */
+  void Rebuild();
+
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** The number of slots minus one; the number of slots is a power of two. */
+  size_t mask_;
+  /** The number of entries. */
+  size_t size_{0};
+  /** The number of tombstones. */
+  size_t tombstones_{0};
+};
+
+}  // namespace bustub
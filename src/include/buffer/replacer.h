@@ -12,12 +12,21 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+enum class AccessType { Unknown = 0, Get, Scan };
+
 /**
  * Replacer is an abstract class that tracks page usage.
+ *
+ * The buffer pool manager drives every replacer the same way: a frame is registered by its first RecordAccess() and
+ * starts out non-evictable, SetEvictable() marks it as a candidate once it is unpinned, and Evict() picks the victim
+ * according to the replacement policy. Frame ids are in [0, num_frames).
  */
 class Replacer {
  public:
@@ -25,26 +34,62 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * Find the victim frame as defined by the replacement policy and stop tracking it. Only evictable frames are
+   * candidates.
+   * @param[out] frame_id id of frame that was evicted
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record an access to a frame, starting to track it (as non-evictable) if it is not tracked yet.
+   * @param frame_id the id of the frame that was accessed
+   * @param access_type the kind of access, which scan resistant policies use as a hint
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) = 0;
+
+  /**
+   * Mark a tracked frame as evictable or non-evictable. Does nothing for frames that are not tracked.
+   * @param frame_id the id of the frame
+   * @param set_evictable whether the frame may be evicted
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Stop tracking an evictable frame whose page is gone, e.g. because it was deleted. Unlike Evict(), the page is
+   * not remembered by policies that keep a history of evicted pages. Does nothing for frames that are not tracked.
+   * @param frame_id the id of the frame
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * List evictable frames in the order Evict() would choose them, without evicting anything.
+   * @param max_frames the maximum number of frames to return
+   * @return up to max_frames evictable frames, the next victim first
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> = 0;
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * Tell the replacer which page a frame is about to hold, before the first RecordAccess() of that page. Policies
+   * that remember recently evicted pages use this to recognize a page coming back; the others ignore it.
+   * @param frame_id the id of the frame
+   * @param page_id the page now held by the frame
+   */
+  virtual void SetPageId(frame_id_t frame_id, page_id_t page_id) {}
 };
 
+/** The replacement policies a BufferPoolManager can be created with. */
+enum class ReplacerPolicy { LRU, Clock, LRUK, ARC, TwoQueue, ClockPro };
+
+/**
+ * Create a replacer implementing the given policy.
+ * @param policy the replacement policy
+ * @param num_frames the number of frames the replacer has to track
+ * @param k the lookback constant, only used by LRU-K
+ */
+auto CreateReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer>;
+
 }  // namespace bustub
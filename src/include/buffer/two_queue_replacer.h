@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full version of the 2Q policy (Johnson and Shasha, VLDB 1994).
+ *
+ * A page brought in enters A1in, a FIFO queue of about a quarter of the frames; hitting it there does not move it,
+ * so correlated references right after the miss do not count. Pages evicted from A1in are remembered in A1out, a
+ * ghost queue of page ids about half as long as the pool. Only a page that misses while in A1out has proven to be
+ * reused and is admitted to Am, the main LRU list. Evict() takes from A1in while it is above its share, and from Am
+ * otherwise.
+ *
+ * A scan access never admits a page to Am, so pages read by a sequential scan only ever cycle through A1in.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the TwoQueueReplacer will be required to store
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+  void SetPageId(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  struct Frame {
+    bool is_tracked_{false};
+    bool is_evictable_{false};
+    /** Whether the frame is in Am rather than A1in. */
+    bool in_am_{false};
+    std::list<frame_id_t>::iterator pos_;
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** @return true if the next victim should come from A1in, given the number of frames currently in it */
+  auto PreferA1in(size_t a1in_size) const -> bool { return a1in_size > a1in_target_size_; }
+
+  /** @return the oldest evictable frame of the queue, or end() if there is none */
+  auto FindVictim(std::list<frame_id_t> *queue) -> std::list<frame_id_t>::iterator;
+
+  /** Frames in A1in, oldest in front. */
+  std::list<frame_id_t> a1in_;
+  /** Frames in Am, least recently used in front. */
+  std::list<frame_id_t> am_;
+  /** Ids of pages recently evicted from A1in, oldest in front. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_index_;
+  std::vector<Frame> frames_;
+  /** Kin in the paper: A1in gives up frames once it holds more than this. */
+  const size_t a1in_target_size_;
+  /** Kout in the paper: the number of page ids A1out remembers. */
+  const size_t a1out_size_;
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -23,7 +23,9 @@
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
+#include "storage/index/generic_key.h"
 #include "storage/index/index.h"
+#include "storage/index/key_encoder.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -106,6 +108,9 @@ class Catalog {
   /** Indicates that an operation returning a `IndexInfo*` failed */
   static constexpr IndexInfo *NULL_INDEX_INFO{nullptr};
 
+  /** The size of the largest GenericKey an index can be created with. */
+  static constexpr size_t MAX_INDEX_KEY_SIZE{256};
+
   /**
    * Construct a new Catalog instance.
    * @param bpm The buffer pool manager backing tables created by this catalog
@@ -136,7 +141,7 @@ class Catalog {
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
     if (create_table_heap) {
-      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn, bpm_->CreateSegment());
     }
 
     // Fetch the table OID for the new table
@@ -196,17 +201,25 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param internal_layout The layout of the internal pages of the B+ tree, which must be SORTED for keys wider than
+   * EYTZINGER_MAX_KEY_SIZE bytes
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function,
+                   InternalPageLayout internal_layout = InternalPageLayout::SORTED) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
     }
 
+    // Reject a layout that the internal pages cannot have with keys of this type
+    if (!BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>::SupportsLayout(internal_layout)) {
+      return NULL_INDEX_INFO;
+    }
+
     // If the table exists, an entry for the table should already be present in index_names_
     BUSTUB_ASSERT((index_names_.find(table_name) != index_names_.end()), "Broken Invariant");
 
@@ -226,14 +239,24 @@ class Catalog {
     // just the key, value, and comparator types
 
     // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                     internal_layout);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap, building the tree bottom-up from the sorted keys
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
-    }
+    auto tuple = heap->Begin(txn);
+    index->BulkLoad(
+        [&](Tuple *key, RID *rid) {
+          if (tuple == heap->End()) {
+            return false;
+          }
+          *key = tuple->KeyFromTuple(schema, key_schema, key_attrs);
+          *rid = tuple->GetRid();
+          ++tuple;
+          return true;
+        },
+        txn);
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
@@ -250,6 +273,41 @@ class Catalog {
     return tmp;
   }
 
+  /**
+   * Create a new B+ tree index keyed by the smallest GenericKey that holds the encoded keys of key_schema, see
+   * KeyEncoder, populate existing data of the table and return its metadata.
+   * @return A (non-owning) pointer to the metadata of the new index, NULL_INDEX_INFO if the keys are longer than
+   * MAX_INDEX_KEY_SIZE bytes or the other CreateIndex() fails
+   */
+  auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
+                   const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                   InternalPageLayout internal_layout = InternalPageLayout::SORTED) -> IndexInfo * {
+    auto key_size = KeyEncoder::EncodedSize(key_schema);
+    if (key_size <= 4) {
+      return CreateIndexWithKeySize<4>(txn, index_name, table_name, schema, key_schema, key_attrs, internal_layout);
+    }
+    if (key_size <= 8) {
+      return CreateIndexWithKeySize<8>(txn, index_name, table_name, schema, key_schema, key_attrs, internal_layout);
+    }
+    if (key_size <= 16) {
+      return CreateIndexWithKeySize<16>(txn, index_name, table_name, schema, key_schema, key_attrs, internal_layout);
+    }
+    if (key_size <= 32) {
+      return CreateIndexWithKeySize<32>(txn, index_name, table_name, schema, key_schema, key_attrs, internal_layout);
+    }
+    if (key_size <= 64) {
+      return CreateIndexWithKeySize<64>(txn, index_name, table_name, schema, key_schema, key_attrs, internal_layout);
+    }
+    if (key_size <= 128) {
+      return CreateIndexWithKeySize<128>(txn, index_name, table_name, schema, key_schema, key_attrs, internal_layout);
+    }
+    if (key_size <= MAX_INDEX_KEY_SIZE) {
+      return CreateIndexWithKeySize<MAX_INDEX_KEY_SIZE>(txn, index_name, table_name, schema, key_schema, key_attrs,
+                                                        internal_layout);
+    }
+    return NULL_INDEX_INFO;
+  }
+
   /**
    * Get the index `index_name` for table `table_name`.
    * @param index_name The name of the index for which to query
@@ -342,6 +400,17 @@ class Catalog {
   }
 
  private:
+  /** Create a B+ tree index keyed by GenericKey<KeySize>. */
+  template <size_t KeySize>
+  auto CreateIndexWithKeySize(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                              const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                              InternalPageLayout internal_layout) -> IndexInfo * {
+    return CreateIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>(txn, index_name, table_name, schema,
+                                                                             key_schema, key_attrs, KeySize,
+                                                                             HashFunction<GenericKey<KeySize>>{},
+                                                                             internal_layout);
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
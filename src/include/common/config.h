@@ -16,6 +16,11 @@
 #include <chrono>  // NOLINT
 #include <cstdint>
 
+// The page size is picked with -DBUSTUB_PAGE_SIZE=<bytes> when configuring the build.
+#ifndef BUSTUB_PAGE_SIZE_BYTES
+#define BUSTUB_PAGE_SIZE_BYTES 4096
+#endif
+
 namespace bustub {
 
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
@@ -27,23 +32,56 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The buffer pool's background flusher re-checks the dirty ratio every BPM_FLUSHER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds bpm_flusher_interval;
+
+/** True if buffer pools created from now on should back their frames with 2 MB huge pages when possible. */
+extern bool bpm_use_huge_pages;
+
+/** The NUMA node buffer pools created from now on place their frames on, or -1 for the default placement. */
+extern int bpm_numa_node;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
-static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_PAGE_SIZE = BUSTUB_PAGE_SIZE_BYTES;                      // size of a data page in byte
+static constexpr int BUSTUB_PAGE_CHECKSUM_SIZE = 4;                                  // trailing checksum of a page
+static constexpr int BUSTUB_PAGE_USABLE_SIZE = BUSTUB_PAGE_SIZE - BUSTUB_PAGE_CHECKSUM_SIZE;  // bytes page layouts use
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int DISK_SCHEDULER_WORKERS = 4;           // worker threads of the disk scheduler without io_uring
+static constexpr int DISK_SCHEDULER_QUEUE_DEPTH = 64;      // io_uring entries, i.e. max I/Os in flight
+static constexpr double BPM_FLUSHER_HIGH_WATERMARK = 0.5;  // dirty frame ratio at which the flusher starts writing
+static constexpr double BPM_FLUSHER_LOW_WATERMARK = 0.25;  // dirty frame ratio the flusher writes down to
+static constexpr int BPM_ACCESS_LOG_SIZE = 64;             // latch-free page accesses a shard batches for its replacer
+static constexpr int TABLE_READAHEAD_MIN_PAGES = 2;        // first read-ahead window of a sequential table scan
+static constexpr int TABLE_READAHEAD_MAX_PAGES = 32;       // largest read-ahead window of a sequential table scan
+static constexpr double INDEX_FILL_FACTOR = 0.9;           // how full a bulk-loaded B+ tree fills its pages
+static constexpr int INDEX_SCAN_READAHEAD_PAGES = 8;       // leaves a B+ tree range scan prefetches from their parent
+static constexpr int INDEX_SORT_MEMORY_PAGES = 256;        // pages of entries an index build sorts in memory
+static constexpr int CACHE_LINE_SIZE = 64;                 // alignment of per-frame metadata
+static constexpr int SEGMENT_PAGE_BITS = 22;               // low page id bits numbering a page within its segment
+static constexpr int DISK_EXTENT_SIZE = 1 << 20;           // segment files grow in extents of this many bytes
+
+// Pages are the unit of direct I/O and are aligned to their size, so the size must be a power of two.
+static_assert(BUSTUB_PAGE_SIZE >= 4096 && BUSTUB_PAGE_SIZE <= 32768 && (BUSTUB_PAGE_SIZE & (BUSTUB_PAGE_SIZE - 1)) == 0,
+              "BUSTUB_PAGE_SIZE must be 4096, 8192, 16384 or 32768");
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
+using segment_id_t = int32_t;  // segment id type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
 
 static constexpr int VARCHAR_DEFAULT_LENGTH = 128;  // default length for varchar when constructing the column
 
+static constexpr segment_id_t DEFAULT_SEGMENT_ID = 0;                        // the segment kept in the database file
+static constexpr segment_id_t INVALID_SEGMENT_ID = -1;                       // invalid segment id
+static constexpr segment_id_t MAX_SEGMENTS = 1 << (31 - SEGMENT_PAGE_BITS);  // segments a database can have
+
 }  // namespace bustub
@@ -39,6 +39,12 @@ class ReaderWriterLatch {
    */
   void RLock() { mutex_.lock_shared(); }
 
+  /**
+   * Acquire a read latch if no writer holds the latch.
+   * @return true if the read latch was acquired
+   */
+  auto TryRLock() -> bool { return mutex_.try_lock_shared(); }
+
   /**
    * Release a read latch.
    */
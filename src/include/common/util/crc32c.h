@@ -0,0 +1,39 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * CRC-32C (Castagnoli), the checksum used for pages on disk. It uses the SSE4.2 crc32 instruction when the CPU has
+ * it, and a lookup table otherwise; both give the same result.
+ */
+class Crc32c {
+ public:
+  /**
+   * Compute the CRC-32C of a buffer.
+   * @param data the buffer
+   * @param length the number of bytes to checksum
+   * @param crc the checksum of the preceding bytes, to checksum a buffer in parts
+   * @return the checksum
+   */
+  static auto Compute(const char *data, size_t length, uint32_t crc = 0) -> uint32_t;
+
+  /** @return true if Compute() uses the crc32 instruction */
+  static auto IsHardwareAccelerated() -> bool;
+};
+
+}  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -44,5 +45,13 @@ class IndexScanExecutor : public AbstractExecutor {
  private:
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The index to scan and the table it is on. */
+  IndexInfo *index_info_{nullptr};
+  TableInfo *table_info_{nullptr};
+  /** Where a scan of all keys is in the index; it fetches the next batch of RIDs once rids_ runs out. */
+  IndexScanCursor scan_cursor_;
+  /** The RIDs of the tuples to return next, in key order, and the position of the next one. */
+  std::vector<RID> rids_;
+  size_t cursor_{0};
 };
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
@@ -28,26 +29,49 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /**
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
-   * @param table_oid the identifier of table to be scanned
+   * @param index_oid the identifier of the index to be scanned
+   * @param key_values the key to look up, one value per key column; all keys in order if empty
+   * @param reverse whether a scan of all keys goes through them in reverse order
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, std::vector<Value> key_values = {}, bool reverse = false)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        key_values_(std::move(key_values)),
+        reverse_(reverse) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the identifier of the table that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  /** @return the key to look up, empty for a scan of all keys */
+  auto GetKeyValues() const -> const std::vector<Value> & { return key_values_; }
+
+  /** @return true if a scan of all keys goes through them in reverse order */
+  auto IsReverse() const -> bool { return reverse_; }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** The key to look up, one value per key column of the index. */
+  std::vector<Value> key_values_;
+
+  /** Whether a scan of all keys goes through them in reverse order. */
+  bool reverse_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    if (key_values_.empty()) {
+      return reverse_ ? fmt::format("IndexScan {{ index_oid={}, reverse=true }}", index_oid_)
+                      : fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    }
+    std::vector<std::string> keys;
+    for (const auto &value : key_values_) {
+      keys.push_back(value.ToString());
+    }
+    return fmt::format("IndexScan {{ index_oid={}, key=[{}] }}", index_oid_, fmt::join(keys, ", "));
   }
 };
 
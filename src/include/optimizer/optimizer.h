@@ -85,6 +85,12 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief look up the rows of a filter on a sequential scan in an index if the filter fixes all key columns of the
+   * index to constants, e.g. `SELECT * FROM t WHERE name = 'a' AND id = 1` with an index on (id, name)
+   */
+  auto OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /** @brief check if the index can be matched */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
@@ -61,6 +61,9 @@ class LogManager {
 
   char *log_buffer_;
   char *flush_buffer_;
+  // The largest record, an update of a tuple that fills a page, must fit in the log buffer.
+  static_assert(LOG_BUFFER_SIZE >=
+                LogRecord::HEADER_SIZE + sizeof(RID) + 2 * (sizeof(int32_t) + static_cast<size_t>(BUSTUB_PAGE_SIZE)));
 
   std::mutex latch_;
 
@@ -13,31 +13,77 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
 
 namespace bustub {
 
+/** When a DiskManager forces the pages it has written to stable storage with fdatasync(). */
+enum class DiskSyncPolicy {
+  /** Never; durability is left to the operating system. */
+  None,
+  /** On Sync(), i.e. whenever the buffer pool flushes pages, and on ShutDown(). */
+  OnFlush,
+  /** After every page write. */
+  EveryWrite,
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * In direct I/O mode the database file is opened with O_DIRECT, so pages bypass the kernel page cache instead of being
+ * cached twice, once there and once in the buffer pool. Direct I/O needs page-aligned buffers; buffer pool frames
+ * are, and any other buffer goes through an aligned bounce buffer.
+ *
+ * Pages are grouped into segments, e.g. one per table heap or index. The segment of a page is held in the high bits of
+ * its page id, above SEGMENT_PAGE_BITS. The default segment lives in the database file itself, and every other
+ * segment in a file of its own, named after the database file and the segment id. That keeps the pages of a table
+ * together on disk, lets a table be dropped by unlinking its file, and lets segments on different devices be read in
+ * parallel. Segment files are reserved DISK_EXTENT_SIZE bytes at a time, so the file system can lay them out in
+ * contiguous runs.
+ *
+ * The disk manager also keeps track of which pages are allocated, in allocation map pages stored in each segment file.
+ * Every map page is a bitmap over the PAGES_PER_MAP pages that follow it, so a file is laid out as
+ *  ---------------------------------------------------------------------------------------
+ *  | Map 0 | Page 0 | ... | Page PAGES_PER_MAP - 1 | Map 1 | Page PAGES_PER_MAP | ... |
+ *  ---------------------------------------------------------------------------------------
+ * and map pages never show up as page ids. An allocation is written out before the page it covers is, so a page that
+ * reached disk is never mistaken for a free one after a crash. A deallocation only becomes durable when the buffer
+ * pool says that no page on disk still refers to the page (PersistDeallocations()); a crash before that leaks the page
+ * rather than handing out a page that is still in use.
+ *
+ * With page checksums on, the last BUSTUB_PAGE_CHECKSUM_SIZE bytes of every page hold the CRC-32C of the rest of the
+ * page. The checksum is stamped when the page is written and verified when it is read back, so a page that was torn by
+ * a crash or corrupted on disk is refused instead of being handed to the buffer pool. A zero checksum means that the
+ * page was written without one and is not verified. Page layouts never use those bytes (BUSTUB_PAGE_USABLE_SIZE).
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io whether to bypass the page cache with O_DIRECT. Falls back to buffered I/O if the file system
+   * does not support it.
+   * @param sync_policy when written pages are forced to stable storage
+   * @param page_checksums whether to stamp a checksum into every page written and verify it when the page is read
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false,
+                       DiskSyncPolicy sync_policy = DiskSyncPolicy::OnFlush, bool page_checksums = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
-  DiskManager() = default;
+  DiskManager();
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -45,18 +91,138 @@ class DiskManager {
   void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Remove the files of a database that is not open: the database file, its log file and all of its segment files.
+   * A new database adopts the segment files it finds next to the database file, so removing only the database file
+   * would hand its segments to the next database of that name.
+   * @param db_file the database file name
+   */
+  static void RemoveDatabase(const std::string &db_file);
+
+  /**
+   * Write a page to the database file. Pages are read and written with positional I/O, so this may be called
+   * concurrently from several threads.
    * @param page_id id of the page
    * @param page_data raw page data
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. Reading past the end of the file fills the page with zeros.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @return false if the page could not be read or failed its checksum
+   */
+  virtual auto ReadPage(page_id_t page_id, char *page_data) -> bool;
+
+  /** Force the pages written so far to stable storage. Does nothing unless the sync policy is OnFlush. */
+  void Sync();
+
+  /** Mark a page as allocated. */
+  void AllocatePage(page_id_t page_id);
+
+  /**
+   * Mark a page as free. The deallocation is only kept in memory until it is passed to PersistDeallocations().
+   * @return false if the page was not allocated
+   */
+  auto DeallocatePage(page_id_t page_id) -> bool;
+
+  /** @return true if the page is allocated */
+  auto IsPageAllocated(page_id_t page_id) -> bool;
+
+  /** @return the number of allocated pages of a segment */
+  auto GetNumAllocatedPages(segment_id_t segment_id = DEFAULT_SEGMENT_ID) -> size_t;
+
+  /**
+   * @return one past the highest page id that was ever allocated in a segment, i.e. where its fresh page ids start,
+   * or its first page id if it is empty
+   */
+  auto GetPageIdLimit(segment_id_t segment_id = DEFAULT_SEGMENT_ID) -> page_id_t;
+
+  /** @return the free page ids of a segment below GetPageIdLimit(), in ascending order */
+  auto GetFreePages(segment_id_t segment_id = DEFAULT_SEGMENT_ID) -> std::vector<page_id_t>;
+
+  /**
+   * Get ready for a page write that bypasses WritePage(): write the allocation of the page out before the page itself
+   * is, reserve the extent the page lies in and stamp the checksum into a copy of the page, since the caller's page may
+   * be read concurrently.
+   * @param copy BUSTUB_PAGE_SIZE bytes for the stamped copy, which must stay valid until the write completes
+   * @return the data to write, page_data itself if pages have no checksums
+   */
+  auto PrepareWrite(page_id_t page_id, const char *page_data, char *copy) -> const char *;
+
+  /**
+   * Verify the checksum of a page read without ReadPage().
+   * @return true if the checksum matches, or if there is none to verify
    */
-  virtual void ReadPage(page_id_t page_id, char *page_data);
+  auto VerifyPage(page_id_t page_id, const char *page_data) -> bool;
+
+  /** @return the checksum of a page, as stamped into its last BUSTUB_PAGE_CHECKSUM_SIZE bytes */
+  static auto ComputeChecksum(const char *page_data) -> uint32_t;
+
+  /** @return true if pages are stamped with a checksum and verified */
+  auto HasPageChecksums() const -> bool { return page_checksums_; }
+
+  /** @return the number of pages that failed their checksum so far */
+  auto GetNumChecksumFailures() const -> int { return num_checksum_failures_; }
+
+  /** @return the pages deallocated since the last call, to be passed to PersistDeallocations() later */
+  auto TakeDeallocatedPages() -> std::vector<page_id_t>;
+
+  /**
+   * Make the deallocation of the given pages durable, unless they have been allocated or deallocated again since.
+   * Only call this once every page that referred to them has been written and synced, e.g. after flushing the whole
+   * buffer pool.
+   */
+  void PersistDeallocations(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * Give the space of durably deallocated pages back to the file system: every segment file is truncated after its
+   * last allocated page and the free pages before it become holes. Only run this while nobody else uses the files.
+   * @return the number of free pages whose space was given back
+   */
+  auto Compact() -> size_t;
+
+  /** @return the offset of a page in its segment file */
+  static auto GetPageOffset(page_id_t page_id) -> int64_t {
+    int64_t page_no = page_id & ((1 << SEGMENT_PAGE_BITS) - 1);
+    return (page_no + page_no / PAGES_PER_MAP + 1) * static_cast<int64_t>(BUSTUB_PAGE_SIZE);
+  }
+
+  /** @return the file descriptor of the database file, or -1 if pages are not kept in a file */
+  auto GetDbFileDescriptor() const -> int { return db_fd_; }
+
+  /** @return the file descriptor of the segment file holding a page, or -1 if it is not kept in a file */
+  auto GetFileDescriptor(page_id_t page_id) -> int;
+
+  /**
+   * Create a new, empty segment.
+   * @return the id of the segment, or INVALID_SEGMENT_ID if there are MAX_SEGMENTS segments already
+   */
+  auto CreateSegment() -> segment_id_t;
+
+  /**
+   * Drop a segment along with all of its pages, unlinking its file. The default segment cannot be dropped.
+   * @return false if the segment does not exist
+   */
+  virtual auto DropSegment(segment_id_t segment_id) -> bool;
+
+  /** @return true if the segment exists */
+  auto HasSegment(segment_id_t segment_id) -> bool;
+
+  /** @return the ids of all segments, in ascending order */
+  auto GetSegments() -> std::vector<segment_id_t>;
+
+  /** @return the segment a page belongs to */
+  static auto GetSegmentId(page_id_t page_id) -> segment_id_t { return page_id >> SEGMENT_PAGE_BITS; }
+
+  /** @return the first page id of a segment */
+  static auto GetFirstPageId(segment_id_t segment_id) -> page_id_t { return segment_id << SEGMENT_PAGE_BITS; }
+
+  /** @return true if the database file is opened with O_DIRECT, i.e. page I/O needs page-aligned buffers */
+  auto IsDirectIO() const -> bool { return direct_io_; }
+
+  /** @return the sync policy of the database file */
+  auto GetSyncPolicy() const -> DiskSyncPolicy { return sync_policy_; }
 
   /**
    * Flush the entire log buffer into disk.
@@ -93,19 +259,96 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
+  /** Number of pages covered by one allocation map page, one bit each. */
+  static constexpr int64_t PAGES_PER_MAP = BUSTUB_PAGE_SIZE * 8;
+
+  /** The file of a segment and the allocation map of its pages. Bits of the maps are numbered within the segment. */
+  struct SegmentFile {
+    /** The first page id of the segment. */
+    page_id_t first_page_id_{0};
+    /** The file descriptor of the segment file, or -1 if the segment is kept in memory. */
+    int fd_{-1};
+    std::string file_name_;
+    /** Bytes at the start of the file that are reserved on disk. */
+    std::atomic<int64_t> reserved_size_{0};
+    /** Protects reserving extents. */
+    std::mutex extent_latch_;
+    /** Protects the allocation maps. */
+    std::mutex latch_;
+    /** The allocation bitmap, one bit per page and one BUSTUB_PAGE_SIZE block per map page. */
+    std::vector<uint8_t> map_;
+    /** The allocation bitmap as it may be written to disk: allocations show up right away, deallocations only once
+     * persisted. */
+    std::vector<uint8_t> durable_map_;
+    /** Map pages whose durable image has not been written yet. */
+    std::vector<bool> map_dirty_;
+    /** True if any entry of map_dirty_ is set, so page writes can skip the latch. */
+    std::atomic<bool> has_dirty_maps_{false};
+    /** Pages deallocated since the last TakeDeallocatedPages(). */
+    std::unordered_set<page_id_t> deallocated_pages_;
+    size_t num_allocated_pages_{0};
+    /** One past the highest page number ever allocated. */
+    int64_t page_limit_{0};
+  };
+
+  /** @return the offset of the allocation map page covering the given group of PAGES_PER_MAP pages */
+  static auto GetMapOffset(size_t group) -> int64_t {
+    return static_cast<int64_t>(group) * (PAGES_PER_MAP + 1) * static_cast<int64_t>(BUSTUB_PAGE_SIZE);
+  }
+
+  /** @return the number of a page within its segment */
+  static auto GetPageNumber(page_id_t page_id) -> int64_t { return page_id & ((1 << SEGMENT_PAGE_BITS) - 1); }
+
   auto GetFileSize(const std::string &file_name) -> int;
+  /** @return the name of the file of a segment */
+  auto GetSegmentFileName(segment_id_t segment_id) const -> std::string;
+  /** Open a segment file, creating it if it does not exist, with O_DIRECT in direct I/O mode. */
+  auto OpenFile(const std::string &file_name) const -> int;
+  /** Add a segment kept in the given file, or in memory if fd is -1, and read its allocation maps. Caller should
+   * acquire segments_latch_ exclusively before calling this function. */
+  void AddSegment(segment_id_t segment_id, int fd, const std::string &file_name);
+  /** @return the segment of a page, or nullptr. Caller should acquire segments_latch_ before calling this function. */
+  auto FindSegment(page_id_t page_id) -> SegmentFile *;
+  /** Make sure the first end bytes of a segment file are reserved on disk, reserving whole extents. */
+  static void ReserveExtents(SegmentFile *segment, int64_t end);
+  /** Stamp the checksum into a page. */
+  static void StampChecksum(char *page_data);
+  /** Write one page of data at the given offset of a segment file, reserving another extent if needed. */
+  void WriteAt(SegmentFile *segment, int64_t offset, const char *page_data);
+  /**
+   * Read one page of data at the given offset of a segment file, filling what lies past its end with zeros.
+   * @return false on an I/O error
+   */
+  auto ReadAt(SegmentFile *segment, int64_t offset, char *page_data) -> bool;
+  /** Make room in the maps for the given page. Caller should acquire the segment latch before calling this function. */
+  static void GrowAllocationMap(SegmentFile *segment, int64_t page_no);
+  /** Write the map pages whose durable image changed. Caller should acquire the segment latch before calling this
+   * function. */
+  void WriteDirtyMaps(SegmentFile *segment);
+  /** Write the allocation of a page, which belongs to the segment, out before the page itself is written. */
+  void PersistAllocation(SegmentFile *segment, page_id_t page_id);
+  /** Give the space of the durably deallocated pages of a segment back to the file system. */
+  auto CompactSegment(SegmentFile *segment) -> size_t;
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file, accessed with pread / pwrite so concurrent page I/O needs no latch
+  int db_fd_{-1};
+  bool direct_io_{false};
+  DiskSyncPolicy sync_policy_{DiskSyncPolicy::None};
+  bool page_checksums_{false};
+  std::atomic<int> num_checksum_failures_{0};
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+
+  /** Protects the set of segments. Page I/O holds it shared, creating and dropping segments exclusively. */
+  std::shared_mutex segments_latch_;
+  /** The segments, indexed by segment id; nullptr if a segment does not exist. */
+  std::vector<std::unique_ptr<SegmentFile>> segments_;
 };
 
 }  // namespace bustub
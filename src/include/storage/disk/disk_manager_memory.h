@@ -13,12 +13,14 @@
 #include <cstring>
 #include <fstream>
 #include <future>  // NOLINT
+#include <iterator>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <optional>
 #include <shared_mutex>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -50,8 +52,9 @@ class DiskManagerMemory : public DiskManager {
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @return true
    */
-  void ReadPage(page_id_t page_id, char *page_data) override;
+  auto ReadPage(page_id_t page_id, char *page_data) -> bool override;
 
  private:
   char *memory_;
@@ -76,13 +79,11 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     }
 
     std::unique_lock<std::mutex> l(mutex_);
-    if (page_id >= static_cast<int>(data_.size())) {
-      data_.resize(page_id + 1);
+    auto &slot = data_[page_id];
+    if (slot == nullptr) {
+      slot = std::make_shared<ProtectedPage>();
     }
-    if (data_[page_id] == nullptr) {
-      data_[page_id] = std::make_shared<ProtectedPage>();
-    }
-    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
+    std::shared_ptr<ProtectedPage> ptr = slot;
     std::unique_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
@@ -93,26 +94,37 @@ class DiskManagerUnlimitedMemory : public DiskManager {
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @return true, pages that were never written are left as they are
    */
-  void ReadPage(page_id_t page_id, char *page_data) override {
+  auto ReadPage(page_id_t page_id, char *page_data) -> bool override {
     if (latency_ > 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
     }
 
     std::unique_lock<std::mutex> l(mutex_);
-    if (page_id >= static_cast<int>(data_.size()) || page_id < 0) {
-      LOG_WARN("page not exist");
-      return;
-    }
-    if (data_[page_id] == nullptr) {
+    auto it = data_.find(page_id);
+    if (it == data_.end()) {
       LOG_WARN("page not exist");
-      return;
+      return true;
     }
-    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
+    std::shared_ptr<ProtectedPage> ptr = it->second;
     std::shared_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
+    return true;
+  }
+
+  /** Drop a segment and free the memory of its pages. */
+  auto DropSegment(segment_id_t segment_id) -> bool override {
+    if (!DiskManager::DropSegment(segment_id)) {
+      return false;
+    }
+    std::scoped_lock l(mutex_);
+    for (auto it = data_.begin(); it != data_.end();) {
+      it = GetSegmentId(it->first) == segment_id ? data_.erase(it) : std::next(it);
+    }
+    return true;
   }
 
   void SetLatency(size_t latency_ms) { latency_ = latency_ms; }
@@ -121,7 +133,8 @@ class DiskManagerUnlimitedMemory : public DiskManager {
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
   using ProtectedPage = std::pair<Page, std::shared_mutex>;
-  std::vector<std::shared_ptr<ProtectedPage>> data_;
+  /** Pages by id. Page ids of segments other than the default one are far apart, so they are not kept in an array. */
+  std::unordered_map<page_id_t, std::shared_ptr<ProtectedPage>> data_;
   size_t latency_{0};
 };
 
@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <memory>
+#include <optional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/channel.h"
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * @brief Represents a Write or Read request for the DiskManager to execute.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+
+  /**
+   *  Pointer to the start of the memory location where a page is either:
+   *   1. being read into from disk (on a read).
+   *   2. being written out to disk (on a write).
+   */
+  char *data_;
+
+  /** ID of the page being read from / written to disk. */
+  page_id_t page_id_;
+
+  /** Callback used to signal to the request issuer when the request has been completed. */
+  std::promise<bool> callback_;
+};
+
+class IoUring;
+
+/**
+ * @brief The DiskScheduler schedules disk read and write operations.
+ *
+ * A request is scheduled by calling DiskScheduler::Schedule() with an appropriate DiskRequest object. The caller keeps
+ * the future of the request's promise and waits on it; the promise is set to true once the I/O has completed, or to
+ * false if it failed or the page read failed its checksum. With page checksums on, a write may stamp the checksum into
+ * the page it is given. Requests are executed out of order and several of them are kept in flight at once, so requests
+ * that must be ordered (e.g. a write and a later read of the same page) must wait on the first future before the
+ * second request is scheduled.
+ *
+ * If the disk manager is backed by a file and the kernel supports io_uring, a single background thread submits the
+ * requests to an io_uring of DISK_SCHEDULER_QUEUE_DEPTH entries. Otherwise, a pool of worker threads calls the disk
+ * manager's ReadPage() / WritePage() directly, which is also the path taken by the in-memory disk managers. If the
+ * kernel rejects a submission for good, the io_uring thread executes the requests the kernel has not taken through
+ * the disk manager and carries on that way; requests whose completion is lost with the ring fail.
+ */
+class DiskScheduler {
+ public:
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DISK_SCHEDULER_WORKERS);
+  ~DiskScheduler();
+
+  /**
+   * @brief Schedules a request for the DiskManager to execute.
+   *
+   * @param r The request to be scheduled.
+   */
+  void Schedule(DiskRequest r);
+
+  /**
+   * @brief Schedules a batch of requests. They may complete in any order.
+   *
+   * @param requests The requests to be scheduled.
+   */
+  void Schedule(std::vector<DiskRequest> requests);
+
+  /**
+   * @brief Create a Promise object. If you want to implement your own version of promise, you can change this function
+   * so that our test cases can use your promise implementation.
+   *
+   * @return std::promise<bool>
+   */
+  auto CreatePromise() -> std::promise<bool> { return {}; };
+
+  /** @return true if requests are executed through io_uring rather than the worker pool */
+  auto UsesIoUring() const -> bool { return io_uring_ != nullptr; }
+
+ private:
+  /** Worker pool loop: executes requests through the disk manager one at a time. */
+  void StartWorkerThread();
+
+  /** io_uring loop: keeps up to DISK_SCHEDULER_QUEUE_DEPTH requests in flight. */
+  void StartIoUringThread();
+
+  /** Execute a request through the disk manager's ReadPage() / WritePage() and complete its promise. */
+  void ExecuteDirectly(DiskRequest *r);
+
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_;
+  /** The ring used to submit requests, or nullptr if the worker pool is used. */
+  std::unique_ptr<IoUring> io_uring_;
+  /** A shared queue to concurrently schedule and process requests. When the DiskScheduler's destructor is called,
+   * `std::nullopt` is put into the queue once per background thread to signal them to stop. */
+  Channel<std::optional<DiskRequest>> request_queue_;
+  /** The background threads responsible for issuing scheduled requests to the disk. */
+  std::vector<std::thread> background_threads_;
+};
+
+}  // namespace bustub
@@ -21,10 +21,15 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
 #include <optional>
 #include <queue>
 #include <shared_mutex>
+#include <utility>
 #include <vector>
 
 #include "common/config.h"
@@ -41,8 +46,9 @@ namespace bustub {
 /**
  * @brief Definition of the Context class.
  *
- * Hint: This class is designed to help you keep track of the pages
- * that you're modifying or accessing.
+ * Keeps track of the pages that a writer latched on its way down: the header page while the root may change, and the
+ * path from the highest page that may change down to the leaf. The back of write_set_ is the page being worked on and
+ * the entry before it its parent.
  */
 class Context {
  public:
@@ -56,6 +62,16 @@ class Context {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 // Main class providing the API for the Interactive B+ Tree.
+//
+// Readers use optimistic lock coupling: they walk down without latching any page, remember the version of every page
+// they look at (see OptimisticPageGuard), and start over when a writer changed one of them before they were done.
+// After a few attempts they fall back to latch crabbing with read latches. Writers first take the same optimistic path
+// and write latch only the leaf; when the leaf has to split or merge, they start over with write latch crabbing from
+// the header page.
+//
+// Pages that leave the tree are not deleted right away, since an optimistic reader may still be about to fetch them.
+// Optimistic readers announce the epoch they started in, each in a slot of its own, and a page is deleted once every
+// reader still active started in a later epoch than the one the page left the tree in.
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
@@ -64,7 +80,13 @@ class BPlusTree {
  public:
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
-                     int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int internal_max_size = INTERNAL_PAGE_SIZE,
+                     InternalPageLayout internal_layout = InternalPageLayout::SORTED);
+
+  // Deletes the pages that left the tree and are still waiting for readers.
+  ~BPlusTree();
+
+  DISALLOW_COPY_AND_MOVE(BPlusTree);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -72,12 +94,25 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *txn = nullptr) -> bool;
 
+  // Insert a batch of key-value pairs in key order, latching each leaf once for all pairs that go to it. Returns how
+  // many pairs were inserted; duplicate keys are skipped.
+  auto InsertBatch(const std::vector<MappingType> &items, Transaction *txn = nullptr) -> size_t;
+
   // Remove a key and its value from this B+ tree.
-  void Remove(const KeyType &key, Transaction *txn);
+  void Remove(const KeyType &key, Transaction *txn = nullptr);
+
+  // Build the empty tree bottom-up from entries that come in key order, filling pages to fill_factor. Returns false
+  // without consuming any entry if the tree is not empty.
+  auto BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor = INDEX_FILL_FACTOR) -> bool;
 
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
+  // Look up a batch of keys in key order, each starting down from the lowest page it shares with the key before. The
+  // value of keys[i] is appended to (*results)[i]. Returns how many keys were found.
+  auto GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *txn = nullptr) -> size_t;
+
   // Return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
@@ -88,6 +123,19 @@ class BPlusTree {
 
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  // Reverse index iterator, from the last key or from the last key not greater than the given key. Incrementing it
+  // goes to the key before; it ends at End().
+  auto RBegin() -> INDEXITERATOR_TYPE;
+
+  auto RBegin(const KeyType &key) -> INDEXITERATOR_TYPE;
+
+  // Visit the entries with keys from lo up to hi, both included and left empty if open, in key order or in reverse
+  // order if reverse is set. Rather than one entry at a time, visit gets all entries of a leaf in one batch, copied out
+  // while the leaf is read latched, and returns false to stop the scan. The leaf is still latched during the call, so
+  // visit must not use the tree. Returns how many entries were visited.
+  auto ScanRange(const std::optional<KeyType> &lo, const std::optional<KeyType> &hi,
+                 const std::function<bool(const MappingType *, size_t)> &visit, bool reverse = false) -> size_t;
+
   // Print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -101,6 +149,131 @@ class BPlusTree {
   void RemoveFromFile(const std::string &file_name, Transaction *txn = nullptr);
 
  private:
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+
+  /**
+   * Counts the current thread as an optimistic reader while it is in scope, by holding an epoch slot with the epoch it
+   * started in. On the way out it deletes the pages that it was the last one to hold back.
+   */
+  class EpochGuard {
+   public:
+    explicit EpochGuard(BPlusTree *tree);
+    ~EpochGuard();
+    DISALLOW_COPY_AND_MOVE(EpochGuard);
+
+   private:
+    BPlusTree *tree_;
+    std::atomic<uint64_t> *slot_;
+  };
+
+  /** The slot of an optimistic reader, on a cache line of its own so that readers do not write to a shared one. */
+  struct alignas(CACHE_LINE_SIZE) EpochSlot {
+    /** The epoch the reader holding the slot started in, or 0 if the slot is free. */
+    std::atomic<uint64_t> epoch_{0};
+  };
+
+  /** The number of epoch slots; readers beyond that many wait for a slot. */
+  static constexpr size_t EPOCH_SLOTS = 64;
+
+  /** How often an optimistic operation starts over before it falls back to latching. */
+  static constexpr int MAX_OPTIMISTIC_ATTEMPTS = 8;
+
+  /**
+   * The pages from the header page down to a leaf that a batch operation went through, each with the key that all keys
+   * in the page are less than, if any. A batch goes through its keys in order, so the next key can start down from the
+   * lowest page whose high key it is less than, as long as the page did not change since.
+   */
+  struct BatchPath {
+    std::vector<OptimisticPageGuard> pages_;
+    std::vector<std::optional<KeyType>> high_keys_;
+  };
+
+  /**
+   * Walk down to the leaf that the key belongs to without latching any page.
+   * @param[out] parent the parent of the leaf, or the header page if the leaf is the root or the tree is empty
+   * @param[out] leaf the leaf, unless the tree is empty
+   * @param[out] leaf_page_id the page id of the leaf, INVALID_PAGE_ID if the tree is empty
+   * @return false if a writer got in the way and the walk has to start over
+   */
+  auto DescendOptimistic(const KeyType &key, OptimisticPageGuard *parent, OptimisticPageGuard *leaf,
+                         page_id_t *leaf_page_id) -> bool;
+
+  /**
+   * Move the path down to the leaf that the key belongs to without latching any page, starting from the lowest page of
+   * the path that the key belongs to. The path ends at the header page if the tree is empty.
+   * @return false if a writer got in the way; the path has to be cleared then
+   */
+  auto DescendBatch(const KeyType &key, BatchPath *path) -> bool;
+
+  /** @return the indexes of the given items, in the order of their keys */
+  template <typename T, typename KeyFn>
+  auto SortedOrder(const std::vector<T> &items, KeyFn key_of) -> std::vector<size_t>;
+
+  /** @return the result of GetValue(), or nothing if the optimistic lookup kept running into writers */
+  auto GetValueOptimistic(const KeyType &key, std::vector<ValueType> *result) -> std::optional<bool>;
+
+  /** @return the result of Insert(), or nothing if the leaf has to split or the optimistic path kept failing */
+  auto InsertOptimistic(const KeyType &key, const ValueType &value) -> std::optional<bool>;
+
+  /** @return true if the key was removed or is not in the tree, false if the leaf has to be merged or redistributed */
+  auto RemoveOptimistic(const KeyType &key) -> bool;
+
+  /**
+   * Latch crab down to the leaf that the key belongs to with write latches, releasing the header page and the pages
+   * above a page that stays in place whatever the operation does to the page.
+   * @param is_safe tells whether an operation on the page can leave it in place
+   * @return false if the tree is empty; the header page is still latched in ctx then
+   */
+  template <typename SafeFn>
+  auto DescendPessimistic(const KeyType &key, Context *ctx, SafeFn is_safe) -> bool;
+
+  /**
+   * Latch crab down to a leaf for a range scan with read latches, going to the child that child_index picks in each
+   * internal page. The siblings of the leaf that the scan goes to next, up to INDEX_SCAN_READAHEAD_PAGES of them that
+   * hold keys from lo to hi, are prefetched from its parent.
+   * @param[out] leaf the read latched leaf
+   * @param[out] low_key if not null, the key that all keys of the leaf are at least; none for the first leaf
+   * @return false if the tree is empty
+   */
+  template <typename ChildFn>
+  auto DescendScan(ChildFn child_index, const std::optional<KeyType> &lo, const std::optional<KeyType> &hi,
+                   bool reverse, ReadPageGuard *leaf, std::optional<KeyType> *low_key) -> bool;
+
+  /**
+   * Move a reverse scan from a read latched leaf to the leaf before it. Writers latch leaves from left to right, so the
+   * scan takes the latch of the leaf that the previous page id points to only if it is free right away. Otherwise it
+   * lets go of the leaf and starts over from the root, down to the leaf with the greatest key less than key. The leaf
+   * it moves to may be empty, if a writer is about to merge it into its left sibling.
+   * @param key the first key of the leaf, or of the closest leaf after it with any keys; none if there is no such leaf
+   * @return false if no leaf holds keys less than key; the leaf is released then
+   */
+  auto PrevLeaf(ReadPageGuard *leaf, const std::optional<KeyType> &key) -> bool;
+
+  /** Insert the new page that split off old_page_id into the parent of old_page_id, the back of ctx. */
+  void InsertIntoParent(Context *ctx, page_id_t old_page_id, const KeyType &key, page_id_t new_page_id);
+
+  /** Merge or redistribute the page at the back of ctx if it holds too few entries, and so on up the tree. */
+  void HandleUnderflow(Context *ctx);
+
+  /** @return the size below which a page underflows, which depends on the keys of a leaf */
+  static auto MinSize(const BPlusTreePage *page) -> int;
+
+  /**
+   * @return how many of the remaining pages of a level go to its next internal page when building the tree bottom-up:
+   * target, unless the last one or two pages have to share what is left so that none gets more than max_size or less
+   * than min_size
+   */
+  static auto BulkLoadPageSize(size_t remaining, int target, int min_size, int max_size) -> int;
+
+  /** Allocate a page for the tree in the tree's segment. Throws if no frame is free. */
+  auto NewTreePage(page_id_t *page_id) -> BasicPageGuard;
+
+  /** Hand a page that left the tree to the garbage collector. */
+  void FreePage(page_id_t page_id);
+
+  /** Delete the pages that left the tree before every optimistic reader that is still active started. */
+  void CollectGarbage();
+
   /* Debug Routines for FREE!! */
   void ToGraph(page_id_t page_id, const BPlusTreePage *page, std::ofstream &out);
 
@@ -119,7 +292,20 @@ class BPlusTree {
   std::vector<std::string> log;  // NOLINT
   int leaf_max_size_;
   int internal_max_size_;
+  /** The layout of the internal pages the tree creates, see BPlusTreeInternalPage::SupportsLayout(). */
+  InternalPageLayout internal_layout_;
   page_id_t header_page_id_;
+  /** The segment that the pages of the tree are allocated in, the one of the header page. */
+  segment_id_t segment_id_;
+  /** The current epoch, which only moves on when pages are collected. 0 marks a free epoch slot. */
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> epoch_{1};
+  /** True while garbage_ is not empty, so that readers only take garbage_latch_ if there is something to delete. */
+  std::atomic<bool> has_garbage_{false};
+  std::array<EpochSlot, EPOCH_SLOTS> epoch_slots_;
+  /** Protects garbage_. */
+  alignas(CACHE_LINE_SIZE) std::mutex garbage_latch_;
+  /** Pages that left the tree and wait to be deleted, with the epoch they left the tree in. */
+  std::vector<std::pair<page_id_t, uint64_t>> garbage_;
 };
 
 }  // namespace bustub
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -27,7 +28,8 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 InternalPageLayout internal_layout = InternalPageLayout::SORTED);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -35,6 +37,26 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) override;
+
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                Transaction *transaction) override;
+
+  void ScanAll(std::vector<RID> *result, Transaction *transaction) override;
+
+  void ScanRange(const Tuple *lo, const Tuple *hi, std::vector<RID> *result, bool reverse,
+                 Transaction *transaction) override;
+
+  auto ScanRangeBatch(const Tuple *lo, const Tuple *hi, bool reverse, IndexScanCursor *cursor,
+                      std::vector<RID> *result, Transaction *transaction) -> bool override;
+
+  /**
+   * Fill the index with entries that come in any order, faster than inserting them one at a time. The entries are
+   * sorted, on disk if they do not fit in memory, and the tree is built bottom-up if it is empty.
+   * @param next produces the key and RID of the next entry, returns false when there are none left
+   */
+  void BulkLoad(const std::function<bool(Tuple *, RID *)> &next, Transaction *transaction);
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
@@ -42,6 +64,8 @@ class BPlusTreeIndex : public Index {
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
  protected:
+  // buffer pool the index lives in
+  BufferPoolManager *bpm_;
   // comparator for key
   KeyComparator comparator_;
   // container
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/storage/index/external_sort.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORT_TYPE ExternalSort<KeyType, ValueType, KeyComparator>
+
+/**
+ * Sorts index entries by key, for building a B+ tree bottom-up.
+ *
+ * Entries are collected in memory until memory_pages pages worth of them are buffered. The buffer is then sorted and
+ * written out as a run to pages of a segment of its own. Once all entries are in, the runs are merged, at most
+ * memory_pages of them at a time, and the last merge feeds Next(). Nothing goes to disk if all entries fit in memory.
+ *
+ * The sort is stable: entries with equal keys come out in the order they were added.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSort {
+ public:
+  explicit ExternalSort(BufferPoolManager *bpm, const KeyComparator &comparator,
+                        int memory_pages = INDEX_SORT_MEMORY_PAGES);
+
+  /** Drops the pages of the runs. */
+  ~ExternalSort();
+
+  DISALLOW_COPY_AND_MOVE(ExternalSort);
+
+  /** Add an entry. Must not be called after Finish(). */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /** Sort the entries added so far, so that Next() can return them. */
+  void Finish();
+
+  /**
+   * @param[out] item the next entry in key order
+   * @return false if all entries have been returned
+   */
+  auto Next(MappingType *item) -> bool;
+
+  /** @return the number of runs that were written to disk so far */
+  auto GetRunCount() const -> size_t { return run_count_; }
+
+ private:
+  /** Entries that fit in one page of a run. */
+  static constexpr size_t ENTRIES_PER_PAGE = BUSTUB_PAGE_USABLE_SIZE / sizeof(MappingType);
+
+  /** A sorted run of entries, ENTRIES_PER_PAGE to a page. */
+  struct Run {
+    std::vector<page_id_t> pages_;
+    size_t size_{0};
+  };
+
+  /** Reads the entries of a run in order, keeping only the current page pinned. */
+  class RunReader {
+   public:
+    RunReader(BufferPoolManager *bpm, const Run *run);
+
+    auto IsEnd() const -> bool { return index_ == run_->size_; }
+    auto Get() -> const MappingType &;
+    void Advance() { index_++; }
+
+   private:
+    BufferPoolManager *bpm_;
+    const Run *run_;
+    size_t index_{0};
+    /** The page of the run that guard_ holds. */
+    size_t page_index_{SIZE_MAX};
+    BasicPageGuard guard_;
+  };
+
+  /** Writes entries to a new run. */
+  class RunWriter {
+   public:
+    RunWriter(BufferPoolManager *bpm, segment_id_t segment_id) : bpm_(bpm), segment_id_(segment_id) {}
+
+    void Append(const MappingType &item);
+
+    /** @return the run, with its last page unpinned */
+    auto Finish() -> Run;
+
+   private:
+    BufferPoolManager *bpm_;
+    segment_id_t segment_id_;
+    Run run_;
+    BasicPageGuard guard_;
+  };
+
+  /** Sort the buffered entries in memory. */
+  void SortBuffer();
+
+  /** Sort the buffered entries and write them out as a run. */
+  void SpillBuffer();
+
+  /** Start merging the given runs; their entries then come out of NextMerged(). */
+  void StartMerge(size_t begin, size_t end);
+
+  /** @return true if the current entry of reader a comes after the one of reader b */
+  auto MergesAfter(size_t a, size_t b) -> bool;
+
+  /** @return false if the runs being merged are used up */
+  auto NextMerged(MappingType *item) -> bool;
+
+  /** Unpin the runs being merged and delete their pages. */
+  void EndMerge(size_t begin, size_t end);
+
+  BufferPoolManager *bpm_;
+  KeyComparator comparator_;
+  /** How many entries are sorted in memory, and how many runs are merged at once. */
+  size_t buffer_capacity_;
+  size_t fan_in_;
+  /** The segment the runs are written to, created with the first run. */
+  segment_id_t segment_id_{INVALID_SEGMENT_ID};
+  size_t run_count_{0};
+  bool finished_{false};
+
+  /** Entries not written to a run yet; after Finish(), the sorted entries if no run was written. */
+  std::vector<MappingType> buffer_;
+  size_t buffer_pos_{0};
+  std::vector<Run> runs_;
+
+  /** The runs being merged, and a min-heap of the indexes of those that are not used up, by key and then by run. */
+  std::vector<RunReader> readers_;
+  std::vector<size_t> heap_;
+};
+
+}  // namespace bustub
@@ -12,10 +12,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
+#include <type_traits>
 
+#include "common/exception.h"
+#include "storage/index/key_encoder.h"
 #include "storage/table/tuple.h"
-#include "type/value.h"
 
 namespace bustub {
 
@@ -24,43 +27,31 @@ namespace bustub {
  *
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
- * with a template argument.
+ * with a template argument. Keys are stored encoded by KeyEncoder, so
+ * that they compare byte by byte.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
-    // intialize to 0
-    memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    if (!KeyEncoder::Encode(tuple, key_schema, data_, KeySize)) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "index key is too long for its key type");
+    }
   }
 
   // NOTE: for test purpose only
+  // encode the key as the only column of a bigint key schema, or of an integer one if the key has less than 8 bytes
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
-  }
-
-  inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
-    }
-    return Value::DeserializeFrom(data_ptr, column_type);
+    KeyEncoder::EncodeInteger(key, INTEGER_KEY_SIZE, data_);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline auto ToString() const -> int64_t { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // decode a key set by SetFromInteger()
+  inline auto ToString() const -> int64_t { return KeyEncoder::DecodeInteger(data_, INTEGER_KEY_SIZE); }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // decode a key set by SetFromInteger()
   friend auto operator<<(std::ostream &os, const GenericKey &key) -> std::ostream & {
     os << key.ToString();
     return os;
@@ -68,39 +59,60 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  static constexpr size_t INTEGER_KEY_SIZE = KeySize < sizeof(int64_t) ? sizeof(int32_t) : sizeof(int64_t);
 };
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys compare byte by byte, see KeyEncoder. Keys without varchars only compare the bytes their encoding takes, and
+ * those that take 4 or 8 bytes, such as keys of a single INTEGER or BIGINT column, compare as one integer.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
-      }
+    if (compare_size_ == sizeof(uint64_t)) {
+      return Compare(KeyEncoder::LoadBigEndian<uint64_t>(lhs.data_), KeyEncoder::LoadBigEndian<uint64_t>(rhs.data_));
+    }
+    if (compare_size_ == sizeof(uint32_t)) {
+      return Compare(KeyEncoder::LoadBigEndian<uint32_t>(lhs.data_), KeyEncoder::LoadBigEndian<uint32_t>(rhs.data_));
     }
-    // equals
-    return 0;
+    int cmp = memcmp(lhs.data_, rhs.data_, compare_size_);
+    return (cmp > 0) - (cmp < 0);
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other) = default;
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {
+    // Fixed-size keys are zero-padded behind their encoding, so the padding needs no comparing.
+    if (key_schema_ != nullptr && KeyEncoder::IsFixedSize(*key_schema_)) {
+      compare_size_ = std::min(KeySize, KeyEncoder::EncodedSize(*key_schema_));
+    }
+  }
 
  private:
+  template <typename T>
+  static inline auto Compare(T lhs, T rhs) -> int {
+    return (lhs > rhs) - (lhs < rhs);
+  }
+
   Schema *key_schema_;
+  /** The number of leading bytes that tell keys apart. */
+  size_t compare_size_{KeySize};
 };
 
+/**
+ * Tells if a comparator orders keys like memcmp() over all of their bytes, so that B+ tree pages can search the bytes
+ * of their keys directly, see KeySearch. GenericComparator does, since keys are zero-padded past the bytes it compares.
+ */
+template <typename KeyComparator>
+struct IsByteComparable : std::false_type {};
+
+template <size_t KeySize>
+struct IsByteComparable<GenericComparator<KeySize>> : std::true_type {};
+
 }  // namespace bustub
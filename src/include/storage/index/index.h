@@ -18,6 +18,8 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
+#include "fmt/format.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -96,6 +98,14 @@ class IndexMetadata {
   std::shared_ptr<Schema> key_schema_;
 };
 
+/** Where a range scan that returns its entries one batch at a time is, see Index::ScanRangeBatch(). */
+struct IndexScanCursor {
+  /** The last key returned so far, as the index stores it; empty before the first batch. */
+  std::string last_key_;
+  /** Whether all entries have been returned. */
+  bool done_{false};
+};
+
 /////////////////////////////////////////////////////////////////////
 // Index class definition
 /////////////////////////////////////////////////////////////////////
@@ -175,6 +185,75 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  ///////////////////////////////////////////////////////////////////
+  // Batch Operations
+  ///////////////////////////////////////////////////////////////////
+
+  /**
+   * Insert a batch of entries into the index. Indexes that can share work between neighbouring keys override this.
+   * @param entries The index keys and the RIDs associated with them
+   * @param transaction The transaction context
+   */
+  virtual void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+    for (const auto &[key, rid] : entries) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
+  /**
+   * Search the index for a batch of keys. Indexes that can share work between neighbouring keys override this.
+   * @param keys The index keys
+   * @param result The RIDs of keys[i] go to (*result)[i]
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                        Transaction *transaction) {
+    result->assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*result)[i], transaction);
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Ordered Scans
+  ///////////////////////////////////////////////////////////////////
+
+  /**
+   * Return the RIDs of all entries in key order. Only indexes that keep their keys in order support this.
+   * @param result The collection of RIDs that is populated with the entries
+   * @param transaction The transaction context
+   */
+  virtual void ScanAll(std::vector<RID> *result, Transaction *transaction) {
+    throw NotImplementedException(fmt::format("index {} does not keep its keys in order", GetName()));
+  }
+
+  /**
+   * Return the RIDs of the entries with keys from lo up to hi, both included, in key order or in reverse key order.
+   * Only indexes that keep their keys in order support this.
+   * @param lo The lowest index key, or nullptr to start at the first key
+   * @param hi The highest index key, or nullptr to end at the last key
+   * @param result The collection of RIDs that is populated with the entries
+   * @param reverse Whether to return the entries in reverse key order
+   * @param transaction The transaction context
+   */
+  virtual void ScanRange(const Tuple *lo, const Tuple *hi, std::vector<RID> *result, bool reverse,
+                         Transaction *transaction) {
+    throw NotImplementedException(fmt::format("index {} does not keep its keys in order", GetName()));
+  }
+
+  /**
+   * Like ScanRange(), but return the next batch of entries only, such as the entries of one page, so that a scan can
+   * stop early without going through all of them. No latches are held between batches: the scan goes on after the
+   * last key it returned, wherever that key is by then.
+   * @param[in,out] cursor Where the scan is, default constructed for the first batch
+   * @param result The collection of RIDs that is populated with the entries of the batch
+   * @return false once there are no entries left, cursor->done_ is set then
+   */
+  virtual auto ScanRangeBatch(const Tuple *lo, const Tuple *hi, bool reverse, IndexScanCursor *cursor,
+                              std::vector<RID> *result, Transaction *transaction) -> bool {
+    throw NotImplementedException(fmt::format("index {} does not keep its keys in order", GetName()));
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
@@ -14,16 +14,37 @@
  */
 #pragma once
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = B_PLUS_TREE_LEAF_PAGE_TYPE;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Constructs the end iterator. */
   IndexIterator();
+
+  /**
+   * Constructs an iterator that starts at the given entry of a leaf, or at the first entry of the next leaf if index
+   * is past the end of the leaf.
+   */
+  IndexIterator(BufferPoolManager *bpm, ReadPageGuard guard, int index);
+
+  /**
+   * Constructs an iterator that goes through the keys of a tree in reverse order. It starts at the given entry of a
+   * leaf, or at the last entry of the leaf before if index is negative.
+   */
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, ReadPageGuard guard, int index);
+
+  IndexIterator(IndexIterator &&that) noexcept = default;
+  auto operator=(IndexIterator &&that) noexcept -> IndexIterator & = default;
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
@@ -32,12 +53,29 @@ class IndexIterator {
 
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator==(const IndexIterator &itr) const -> bool { return page_id_ == itr.page_id_ && index_ == itr.index_; }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  /** Move on to the next leaf while the iterator is past the end of the current one. */
+  void SkipToNextLeaf();
+
+  /** Move back to the leaf before while a reverse iterator is before the start of the current one. */
+  void SkipToPrevLeaf();
+
+  BufferPoolManager *bpm_{nullptr};
+  /** The tree of a reverse iterator, which may have to come down the tree again to get to the leaf before. */
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  /**
+   * Read latch on the current leaf. Leaves are latched left to right, the next one before this one is released; a
+   * reverse iterator only latches the leaf before this one if it does not have to wait, see BPlusTree::PrevLeaf().
+   */
+  ReadPageGuard guard_;
+  page_id_t page_id_{INVALID_PAGE_ID};
+  int index_{0};
+  /** The current entry, decoded from the leaf since leaves store their keys compressed. */
+  MappingType item_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.h
+//
+// Identification: src/include/storage/index/key_encoder.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * Encodes index keys into bytes that order like the keys: one key is less than another if and only if its encoding
+ * is, compared byte by byte with memcmp(). Comparing keys then needs no Value objects.
+ *
+ * The columns of a key are encoded one after the other:
+ *  - Integers and timestamps big-endian, with the sign bit of signed types flipped. BusTub stores NULL as the lowest
+ *    value of a signed type, so NULL comes first.
+ *  - Decimals by their IEEE 754 bits, big-endian, with the sign bit flipped for positive numbers and all bits flipped
+ *    for negative ones.
+ *  - Varchars as a flag byte, 0 for NULL and 1 otherwise, then the characters in groups of 8, each padded with 0
+ *    bytes and followed by a marker byte: 0xFF minus the number of padding bytes. The last group is the first one
+ *    that is not full, so a string comes before any longer string it is a prefix of, and the size of the
+ *    encoding only depends on the length of the string.
+ * No encoding of a column is a prefix of another one, so the encodings of whole keys order column by column.
+ */
+class KeyEncoder {
+ public:
+  /** @return the size of the longest encoding of a key with the given schema, whose strings fit their columns */
+  static auto EncodedSize(const Schema &key_schema) -> size_t;
+
+  /** @return true if all keys with the given schema take exactly EncodedSize() bytes, i.e. it has no varchars */
+  static auto IsFixedSize(const Schema &key_schema) -> bool;
+
+  /**
+   * Encode a key, padding it with 0 bytes to size bytes.
+   * @return false if the encoding takes more than size bytes, which only happens to strings longer than their column
+   */
+  static auto Encode(const Tuple &key, const Schema &key_schema, char *out, size_t size) -> bool;
+
+  /** Encode a key of a single INTEGER (size 4) or BIGINT (size 8) column. */
+  static void EncodeInteger(int64_t value, size_t size, char *out);
+
+  /** @return the value of a key of a single INTEGER (size 4) or BIGINT (size 8) column */
+  static auto DecodeInteger(const char *data, size_t size) -> int64_t;
+
+  /**
+   * @return the first sizeof(T) bytes of data as a big-endian unsigned integer. Two such integers compare like the
+   * bytes they were loaded from do with memcmp().
+   */
+  template <typename T>
+  static auto LoadBigEndian(const char *data) -> T {
+    static_assert(sizeof(T) == sizeof(uint32_t) || sizeof(T) == sizeof(uint64_t), "only 4 and 8 byte words");
+    T bits;
+    std::memcpy(&bits, data, sizeof(T));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if constexpr (sizeof(T) == sizeof(uint64_t)) {
+      bits = __builtin_bswap64(bits);
+    } else {
+      bits = __builtin_bswap32(bits);
+    }
+#endif
+    return bits;
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Searches the keys of a B+ tree page that are short enough to compare as integers.
+ *
+ * The keys are sorted, 1 to 8 bytes wide and compare like memcmp() over their bytes, which is how GenericKey and the
+ * leaf page entries store them. Key i starts at keys + i * stride. A search narrows the keys down with a branch-free
+ * binary search, then counts the keys in the remaining window with AVX2 compares if the CPU has them, and one by one
+ * otherwise; both give the same result.
+ *
+ * Keys of up to 4 bytes are read as 4 byte words and wider ones as 8 byte words, so the memory behind a key has to be
+ * readable up to that size.
+ */
+class KeySearch {
+ public:
+  /** The number of keys a search counts one by one or with SIMD compares rather than halving them. */
+  static constexpr int WINDOW_SIZE = 16;
+
+  /**
+   * @return the number of keys less than target, or not greater than target if or_equal is set; i.e. the index of
+   * the lower (upper) bound of target
+   * @param keys the first key
+   * @param stride the distance between two keys in bytes
+   * @param count the number of keys
+   * @param width the size of a key in bytes, 0 to 8
+   * @param target the key to search for, as returned by Load()
+   */
+  static auto Count(const char *keys, size_t stride, int count, size_t width, uint64_t target, bool or_equal) -> int;
+
+  /** Count() without SIMD compares. */
+  static auto CountScalar(const char *keys, size_t stride, int count, size_t width, uint64_t target, bool or_equal)
+      -> int;
+
+  /** @return the width bytes of a key as a big-endian integer, which compares like the bytes do with memcmp() */
+  static auto Load(const char *key, size_t width) -> uint64_t;
+
+  /** @return true if Count() uses AVX2 compares */
+  static auto IsVectorized() -> bool;
+};
+
+}  // namespace bustub
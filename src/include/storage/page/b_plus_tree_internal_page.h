@@ -10,6 +10,8 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <algorithm>
+#include <optional>
 #include <queue>
 
 #include "storage/page/b_plus_tree_page.h"
@@ -17,8 +19,21 @@
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 32
+#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_USABLE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+
+/**
+ * How an internal page lays out its keys for lookups. Each index picks one when it is created; see
+ * BPlusTreeInternalPage.
+ */
+enum class InternalPageLayout { SORTED = 0, EYTZINGER };
+
+/**
+ * The widest keys whose internal pages can be laid out EYTZINGER. The summary halves the entries of a page with wider
+ * keys, and their lookups are no faster than in a SORTED page.
+ */
+static constexpr size_t EYTZINGER_MAX_KEY_SIZE = 8;
+
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -31,18 +46,155 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * The header is the one of BPlusTreePage followed by the layout (4) and the summary height (4).
+ *
+ * A binary search over the entries of a SORTED page touches a cache line at nearly every step. An EYTZINGER page
+ * splits its keys into blocks of BLOCK_SIZE entries, about two cache lines each, and keeps a copy of the first key of
+ * every block but the first at the end of the page, in Eytzinger order (the order of a breadth-first walk of a
+ * complete binary search tree, so the children of slot k are the slots 2k and 2k+1), padded with copies of its last
+ * key. The few cache lines of that summary, fetched at once, tell which block a key belongs to, and only that block
+ * of the entries is searched. The summary takes some room, so the page holds fewer entries, see Capacity():
+ *  ----------------------------------------------------------------------------------
+ * | HEADER | KEY(1)+PAGE_ID(1) | ... | KEY(n)+PAGE_ID(n) | ... | SUMMARY | (unused) |
+ *  ----------------------------------------------------------------------------------
+ * The entries stay sorted either way, so only lookups differ between the layouts; every change to the keys rebuilds
+ * the summary.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
+  /** The number of entries in a block of an EYTZINGER page, which is searched once the summary picked it. */
+  static constexpr int BLOCK_SIZE = std::max<int>(1, 128 / sizeof(MappingType));
+
+  /** @return true if pages with keys of this type can have the given layout, see EYTZINGER_MAX_KEY_SIZE */
+  static constexpr auto SupportsLayout(InternalPageLayout layout) -> bool {
+    return layout == InternalPageLayout::SORTED || sizeof(KeyType) <= EYTZINGER_MAX_KEY_SIZE;
+  }
+
+  /** @return the most entries a page with the given layout holds */
+  static constexpr auto Capacity(InternalPageLayout layout) -> int {
+    int capacity = INTERNAL_PAGE_SIZE;
+    if (layout == InternalPageLayout::EYTZINGER) {
+      while (INTERNAL_PAGE_HEADER_SIZE + capacity * sizeof(MappingType) > SummaryOffset(capacity)) {
+        capacity--;
+      }
+    }
+    return capacity;
+  }
+
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            InternalPageLayout layout = InternalPageLayout::SORTED);
+
+  auto GetLayout() const -> InternalPageLayout;
 
   auto KeyAt(int index) const -> KeyType;
   void SetKeyAt(int index, const KeyType &key);
   auto ValueAt(int index) const -> ValueType;
+  void SetValueAt(int index, const ValueType &value);
+  auto GetItem(int index) const -> const MappingType &;
+
+  /** @return the index of the given child pointer, or -1 if it is not in the page */
+  auto ValueIndex(const ValueType &value) const -> int;
+
+  /** @return the child pointer of the subtree that the given key belongs to */
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+
+  /**
+   * Like Lookup(), and also narrow high_key down to the key that all keys in the subtree are less than. high_key stays
+   * as it is if the subtree is the last one of the page.
+   */
+  auto Lookup(const KeyType &key, const KeyComparator &comparator, std::optional<KeyType> *high_key) const
+      -> ValueType;
+
+  /**
+   * @return the index of the child pointer of the subtree that the given key belongs to, or if or_equal is unset, of
+   * the subtree that holds the greatest keys less than the given key
+   */
+  auto LookupIndex(const KeyType &key, const KeyComparator &comparator, bool or_equal = true) const -> int;
+
+  /** Turn this page into a new root with two children, after the old root split. */
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+
+  /** Insert a key and child pointer right after the entry of old_value. The page must not be full. */
+  void InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+
+  /** Remove the entry at the given index. */
+  void Remove(int index);
+
+  /** Replace the entries of the page with the given ones. */
+  void CopyFrom(const MappingType *items, int size);
+
+  /**
+   * Move all entries to the end of the page right before this one. middle_key is the key in the parent that separates
+   * the two pages, and becomes the key of the first entry moved.
+   */
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+
+  /**
+   * Move the first entry to the end of the page right before this one. middle_key is the key in the parent that
+   * separates the two pages. The new separator is KeyAt(0) afterwards.
+   */
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+
+  /**
+   * Move the last entry to the front of the page right after this one. middle_key is the key in the parent that
+   * separates the two pages. The new separator is recipient->KeyAt(0) afterwards.
+   */
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
 
  private:
+  /** @return the height of the summary of an EYTZINGER page of size entries, which has a key per block but the first */
+  static constexpr auto SummaryHeight(int size) -> int {
+    int blocks = (size - 1 + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int height = 0;
+    while ((1 << height) < blocks) {
+      height++;
+    }
+    return height;
+  }
+
+  /**
+   * @return the offset of the summary of an EYTZINGER page of size entries, slot 0 included. It ends with the usable
+   * part of the page or a little before, to start at a cache line.
+   */
+  static constexpr auto SummaryOffset(int size) -> size_t {
+    size_t bytes = (size_t{1} << SummaryHeight(size)) * sizeof(KeyType);
+    auto usable = static_cast<size_t>(BUSTUB_PAGE_USABLE_SIZE);
+    return bytes > usable ? 0 : (usable - bytes) / 64 * 64;
+  }
+
+  /**
+   * @return the index of the last entry whose key is not greater than the given key, or less than it if or_equal is
+   * unset; the invalid first key counts as less than any key
+   * @param[out] size if not null, the number of entries that were searched
+   */
+  auto FindIndex(const KeyType &key, const KeyComparator &comparator, bool or_equal, int *size) const -> int;
+
+  /**
+   * @return the index of the last of count entries from begin whose key is not greater than the given key, or less
+   * than it if or_equal is unset, or begin - 1 if there is none
+   */
+  auto SearchEntries(int begin, int count, const KeyType &key, const KeyComparator &comparator, bool or_equal) const
+      -> int;
+
+  /** @return the summary keys of an EYTZINGER page, slot 0 is unused */
+  auto SummaryKeys() const -> const KeyType *;
+  auto SummaryKeys() -> KeyType *;
+
+  /** Rebuild the summary of an EYTZINGER page after its keys changed. */
+  void UpdateSummary();
+
+  /**
+   * Fill the summary subtree at slot with the first keys of the blocks from *block on, in order, and the last first
+   * key once the blocks run out.
+   */
+  void FillSummary(uint64_t slot, int *block);
+
+  InternalPageLayout layout_;
+  // the height of the summary of an EYTZINGER page, which has 2^height - 1 keys
+  int summary_height_;
   // Flexible array member for page data.
   MappingType array_[1];
 };
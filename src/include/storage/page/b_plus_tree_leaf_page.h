@@ -10,6 +10,8 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -18,8 +20,10 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 36
+#define LEAF_PAGE_DATA_SIZE (BUSTUB_PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType))
+#define LEAF_PAGE_SIZE \
+  std::min(2 * (LEAF_PAGE_DATA_SIZE / sizeof(MappingType)) + 1, LEAF_PAGE_DATA_SIZE / sizeof(ValueType) + 1)
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -28,16 +32,25 @@ namespace bustub {
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ * | HEADER | AFFIX | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 36 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ---------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4) | PrefixSize (2) | SuffixSize (2)
+ *  ---------------------------------------------------------------------
+ *
+ * Keys are compressed: the first PrefixSize and the last SuffixSize bytes that all keys of the page have in common are
+ * stored once, in the key sized AFFIX, and every entry only keeps the bytes in between. Key bytes are compared as
+ * whole keys, so this only saves space: it drops the zero padding of keys that are shorter than the key type, the high
+ * bytes of integers that are close together, and leading columns with the same value.
+ *
+ * How many entries fit in a page thus depends on its keys. A page holds at most MaxSize - 1 entries and splits when
+ * one more does not fit, which always works out since MaxSize is at most twice the number of uncompressed entries
+ * that fit in a page. See LEAF_PAGE_SIZE.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -48,11 +61,136 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
   auto KeyAt(int index) const -> KeyType;
+  auto ValueAt(int index) const -> ValueType;
+  auto GetItem(int index) const -> MappingType;
+
+  /** Copy the entries from begin up to end to items, decoding them in one go. */
+  void CopyItems(int begin, int end, MappingType *items) const;
+
+  /** @return the number of entries the page can hold with the keys it has, at most GetMaxSize() - 1 */
+  auto GetCapacity() const -> int;
+
+  /**
+   * @return the size below which the page underflows: half of what it holds if no key has bytes in common with the
+   * others, so that a page and its sibling can always either merge or share their entries, see RedistributeWith()
+   */
+  auto GetMinSize() const -> int;
+
+  /**
+   * @return the index of the first key that is not less than the given key, or the size of the page if there is none
+   */
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /**
+   * Look up a key in the page.
+   * @param[out] value the value of the key, if it is in the page
+   * @return true if the key is in the page
+   */
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+
+  /** @return true if the page has room for the key, so that Insert() does not have to split it */
+  auto CanInsert(const KeyType &key) const -> bool;
+
+  /**
+   * Insert a key and its value in key order. The page must have room for it, see CanInsert().
+   * @return false if the key is already in the page
+   */
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> bool;
+
+  /**
+   * Remove a key and its value.
+   * @return false if the key is not in the page
+   */
+  auto Remove(const KeyType &key, const KeyComparator &comparator) -> bool;
+
+  /** Replace the entries of the page with the given ones, which have to fit, see Capacity(). */
+  void CopyFrom(const MappingType *items, int size);
+
+  /**
+   * Insert a key that is not in the page yet and that the page has no room for. The upper half of the entries then
+   * moves to an empty page that is linked in right after this one. The page after the recipient, if any, still has to
+   * be linked back to it.
+   */
+  void InsertAndSplit(const KeyType &key, const ValueType &value, const KeyComparator &comparator,
+                      BPlusTreeLeafPage *recipient);
+
+  /** @return true if the entries of this page and the one right after it fit in one page */
+  auto CanMergeWith(const BPlusTreeLeafPage *right) const -> bool;
+
+  /**
+   * Move all entries to the end of the page right before this one, and unlink this page from the leaf chain. The page
+   * after this one, if any, still has to be linked back to the recipient.
+   */
+  void MoveAllTo(BPlusTreeLeafPage *recipient);
+
+  /**
+   * Share the entries of this page and the page right after it, which do not fit in one page, evenly between the two
+   * as far as the bytes their keys have in common allow. Both pages then have at least GetMinSize() entries.
+   */
+  void RedistributeWith(BPlusTreeLeafPage *right);
+
+  /** @return the number of entries a page with the given max size can hold if it starts with the given ones */
+  static auto Capacity(const MappingType *items, int size, int max_size) -> int;
+
+  /**
+   * @return how many of the given entries, taken from the front, fill a page with the given max size up to
+   * fill_factor of what it can hold, and at least half way
+   */
+  static auto FillSize(const MappingType *items, int size, int max_size, double fill_factor) -> int;
 
  private:
+  static constexpr int KEY_SIZE = sizeof(KeyType);
+
+  /** Where the entries are, read once per operation since optimistic readers may see a page change under them. */
+  struct Layout {
+    int prefix_size_;
+    int suffix_size_;
+    /** The bytes of a key that an entry keeps. */
+    size_t key_size_;
+    size_t entry_size_;
+    /** The size of the page, capped to the entries that fit. */
+    int size_;
+  };
+
+  auto GetLayout() const -> Layout;
+  static auto MakeLayout(int prefix_size, int suffix_size, int size) -> Layout;
+  static auto CapacityOf(const Layout &layout, int max_size) -> int;
+
+  /**
+   * Shrink the prefix and suffix given by affix, prefix_size and suffix_size to the bytes they have in common with
+   * key. If affix holds a single key, prefix_size and suffix_size are both KEY_SIZE.
+   */
+  static void NarrowAffix(const char *affix, const char *key, int *prefix_size, int *suffix_size);
+
+  /** Compute the affix of the page if it had the given key, too. */
+  void AffixWith(const KeyType &key, int *prefix_size, int *suffix_size) const;
+
+  /** Compute the affix of the page if it had the keys of the given page, too. */
+  void AffixWith(const BPlusTreeLeafPage *other, int *prefix_size, int *suffix_size) const;
+
+  auto EntryAt(const Layout &layout, int index) const -> const char *;
+  auto EntryAt(const Layout &layout, int index) -> char *;
+  auto DecodeKey(const Layout &layout, int index) const -> KeyType;
+  auto DecodeValue(const Layout &layout, int index) const -> ValueType;
+  void Encode(const Layout &layout, int index, const KeyType &key, const ValueType &value);
+
+  /** Store the entries with a shorter prefix and suffix. */
+  void Widen(int prefix_size, int suffix_size);
+
+  /** Insert an entry at the given index, with room for it. */
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+
+  /** Remove the entry at the given index. */
+  void RemoveAt(int index);
+
   page_id_t next_page_id_;
-  // Flexible array member for page data.
-  MappingType array_[1];
+  page_id_t prev_page_id_;
+  uint16_t prefix_size_;
+  uint16_t suffix_size_;
+  // The common bytes of the keys; the entries follow right after them.
+  char affix_[sizeof(KeyType)];
 };
 }  // namespace bustub
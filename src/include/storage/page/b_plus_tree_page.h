@@ -39,6 +39,10 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * ----------------------------------------------------------------------------
  * | ParentPageId (4) | PageId(4) |
  * ----------------------------------------------------------------------------
+ *
+ * ParentPageId is recorded when a page is created and not kept up to date when its entries move to other pages, which
+ * would mean latching every moved child. The tree finds the parent of a page through the pages it latched on its way
+ * down (see Context), so the field is only a hint.
  */
 class BPlusTreePage {
  public:
@@ -64,12 +68,12 @@ class BPlusTreePage {
 
  private:
   // member variable, attributes that both internal and leaf page share
-  IndexPageType page_type_ __attribute__((__unused__));
-  lsn_t lsn_ __attribute__((__unused__));
-  int size_ __attribute__((__unused__));
-  int max_size_ __attribute__((__unused__));
-  page_id_t parent_page_id_ __attribute__((__unused__));
-  page_id_t page_id_ __attribute__((__unused__));
+  IndexPageType page_type_;
+  lsn_t lsn_;
+  int size_;
+  int max_size_;
+  page_id_t parent_page_id_;
+  page_id_t page_id_;
 };
 
 }  // namespace bustub
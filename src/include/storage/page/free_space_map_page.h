@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A free space map (FSM) page records, for a run of table pages, how many bytes each of them still has free. A table
+ * heap keeps a chain of these pages next to its table pages so that an insert can jump straight to a page with room
+ * instead of walking the whole table page chain.
+ *
+ * Free space is not stored exactly but rounded down into one-byte buckets of FSM_BUCKET_WIDTH bytes. A page in bucket
+ * b is guaranteed to have at least b * FSM_BUCKET_WIDTH free bytes, so the map never promises space that is not there,
+ * although it may be stale in the other direction. Callers must treat it as a hint and re-check on the table page.
+ *
+ * The first FSM page of a table heap (the root) additionally remembers the last table page and the last FSM page of
+ * the heap, so that appends do not need to walk either chain.
+ *
+ * FSM page format (sizes in bytes):
+ *  -------------------------------------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | EntryCount (4) | LastTablePageId (4) |
+ *  -------------------------------------------------------------------------------------------
+ *  -------------------------------------------------------------------------------------------
+ *  | LastFsmPageId (4) | TablePageId_1 (4) | ... | TablePageId_n (4) | Bucket_1 (1) | ... | Bucket_n (1) |
+ *  -------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage : public Page {
+ public:
+  /** Number of bytes represented by one free space bucket. */
+  static constexpr uint32_t FSM_BUCKET_WIDTH = BUSTUB_PAGE_SIZE / 256;
+  static_assert(BUSTUB_PAGE_SIZE % 256 == 0, "free space buckets must cover a page exactly");
+
+  /**
+   * Initialize the FSM page header.
+   * @param page_id the page ID of this FSM page
+   */
+  void Init(page_id_t page_id);
+
+  /** @return the page ID of this FSM page */
+  auto GetFsmPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the page ID of the next FSM page of the table heap */
+  auto GetNextPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next FSM page of the table heap. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return (root only) the page ID of the last table page of the table heap */
+  auto GetLastTablePageId() -> page_id_t {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_LAST_TABLE_PAGE_ID);
+  }
+
+  /** (root only) Set the page ID of the last table page of the table heap. */
+  void SetLastTablePageId(page_id_t page_id) {
+    memcpy(GetData() + OFFSET_LAST_TABLE_PAGE_ID, &page_id, sizeof(page_id_t));
+  }
+
+  /** @return (root only) the page ID of the last FSM page of the table heap */
+  auto GetLastFsmPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_LAST_FSM_PAGE_ID); }
+
+  /** (root only) Set the page ID of the last FSM page of the table heap. */
+  void SetLastFsmPageId(page_id_t page_id) {
+    memcpy(GetData() + OFFSET_LAST_FSM_PAGE_ID, &page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of table pages tracked by this FSM page */
+  auto GetEntryCount() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRY_COUNT); }
+
+  /** @return true if no more table pages can be tracked by this FSM page */
+  auto IsFull() -> bool { return GetEntryCount() >= FSM_MAX_ENTRIES; }
+
+  /** @return the ID of the table page tracked in slot slot_num */
+  auto GetTablePageId(uint32_t slot_num) -> page_id_t {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_ENTRIES + sizeof(page_id_t) * slot_num);
+  }
+
+  /**
+   * Start tracking a table page.
+   * @param table_page_id the table page to track
+   * @param free_space the number of bytes free on the table page
+   * @param[out] slot_num the slot the table page was recorded in
+   * @return false if this FSM page is full
+   */
+  auto AppendEntry(page_id_t table_page_id, uint32_t free_space, uint32_t *slot_num) -> bool;
+
+  /**
+   * Record the free space of the table page tracked in slot slot_num.
+   * @return true if the recorded bucket changed
+   */
+  auto SetFreeSpace(uint32_t slot_num, uint32_t free_space) -> bool;
+
+  /** @return the free space recorded for slot slot_num, rounded down to the bucket width */
+  auto GetFreeSpace(uint32_t slot_num) -> uint32_t {
+    return static_cast<uint32_t>(GetBucket(slot_num)) * FSM_BUCKET_WIDTH;
+  }
+
+  /**
+   * Find a table page that has at least the requested number of bytes free.
+   * @param required_space bytes the caller needs on the table page
+   * @param[out] slot_num the slot of the table page that was found
+   * @return true if such a page is tracked by this FSM page
+   */
+  auto FindFreeSpace(uint32_t required_space, uint32_t *slot_num) -> bool;
+
+  /** @return the bucket that is guaranteed to be satisfied by free_space bytes */
+  static auto FreeSpaceToBucket(uint32_t free_space) -> uint8_t {
+    auto bucket = free_space / FSM_BUCKET_WIDTH;
+    return static_cast<uint8_t>(bucket > UINT8_MAX ? UINT8_MAX : bucket);
+  }
+
+  /** @return the smallest bucket whose pages are guaranteed to fit required_space bytes */
+  static auto RequiredSpaceToBucket(uint32_t required_space) -> uint32_t {
+    return (required_space + FSM_BUCKET_WIDTH - 1) / FSM_BUCKET_WIDTH;
+  }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_ENTRY_COUNT = 12;
+  static constexpr size_t OFFSET_LAST_TABLE_PAGE_ID = 16;
+  static constexpr size_t OFFSET_LAST_FSM_PAGE_ID = 20;
+  static constexpr size_t OFFSET_ENTRIES = 24;
+  static constexpr size_t FSM_MAX_ENTRIES =
+      (BUSTUB_PAGE_USABLE_SIZE - OFFSET_ENTRIES) / (sizeof(page_id_t) + sizeof(uint8_t));
+  static constexpr size_t OFFSET_BUCKETS = OFFSET_ENTRIES + sizeof(page_id_t) * FSM_MAX_ENTRIES;
+
+  /** Set the number of table pages tracked by this FSM page. */
+  void SetEntryCount(uint32_t entry_count) { memcpy(GetData() + OFFSET_ENTRY_COUNT, &entry_count, sizeof(uint32_t)); }
+
+  /** @return the free space bucket of slot slot_num */
+  auto GetBucket(uint32_t slot_num) -> uint8_t {
+    return *reinterpret_cast<uint8_t *>(GetData() + OFFSET_BUCKETS + slot_num);
+  }
+};
+
+}  // namespace bustub
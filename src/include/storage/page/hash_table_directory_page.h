@@ -194,4 +194,6 @@ class HashTableDirectoryPage {
   page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
 };
 
+static_assert(sizeof(HashTableDirectoryPage) <= BUSTUB_PAGE_USABLE_SIZE, "the directory page does not fit in a page");
+
 }  // namespace bustub
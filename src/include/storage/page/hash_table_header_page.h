@@ -98,4 +98,7 @@ class HashTableHeaderPage {
   __attribute__((unused)) page_id_t block_page_ids_[1];
 };
 
+static_assert(sizeof(HashTableHeaderPage) <= BUSTUB_PAGE_USABLE_SIZE,
+              "the hash table header page does not fit in a page");
+
 }  // namespace bustub
@@ -26,7 +26,7 @@
  * (MappingType) + 1) = BUSTUB_PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
  * to maintain the occupied and readable flags for a key value pair.
  */
-#define BLOCK_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BLOCK_ARRAY_SIZE (4 * BUSTUB_PAGE_USABLE_SIZE / (4 * sizeof(MappingType) + 1))
 
 /**
  * Extendible Hashing Definitions
@@ -38,7 +38,7 @@
  * The computation is the same as the above BLOCK_ARRAY_SIZE, but blocks and buckets have different implementations
  * of search, insertion, removal, and helper methods.
  */
-#define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_USABLE_SIZE / (4 * sizeof(MappingType) + 1))
 
 /**
  * DIRECTORY_ARRAY_SIZE is the number of page_ids that can fit in the directory page of an extendible hash index.
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,14 +27,21 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The page data itself lives in the buffer pool's FrameArena; Page only points to it, so that the metadata of all
+ * frames forms a compact array and the data stays page aligned. Page is aligned to a cache line, so no two frames
+ * share one; with the latch, the metadata of a frame takes two cache lines on x86-64.
  */
-class Page {
+class alignas(CACHE_LINE_SIZE) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor for a page outside of any buffer pool, which owns its zeroed data. */
+  Page() : owned_data_(new char[BUSTUB_PAGE_SIZE]()), data_(owned_data_.get()) {}
+
+  /** Constructor for a buffer pool frame, whose data lives in the pool's arena. */
+  explicit Page(char *data) : data_(data) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -40,26 +50,50 @@ class Page {
   inline auto GetData() -> char * { return data_; }
 
   /** @return the page id of this page */
-  inline auto GetPageId() -> page_id_t { return page_id_; }
+  inline auto GetPageId() -> page_id_t { return page_id_.load(std::memory_order_relaxed); }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int { return std::max(pin_count_.load(std::memory_order_relaxed), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
-  inline auto IsDirty() -> bool { return is_dirty_; }
+  inline auto IsDirty() -> bool { return is_dirty_.load(std::memory_order_relaxed); }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    // Make the odd version visible before any of the writes it guards.
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page read latch if that does not have to wait. @return true if the latch was acquired */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * @return the version of the page, for readers that look at the page without latching it. The version is odd while a
+   * writer holds the write latch, and changes whenever one has held it.
+   */
+  inline auto GetVersion() const -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /** @return true if no writer has latched the page since GetVersion() returned the given (even) version */
+  inline auto ValidateVersion(uint64_t version) const -> bool {
+    // Order the reads of the page data before the second read of the version.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & 1) == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,16 +112,25 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
+  /** The data of a page that is not a buffer pool frame. */
+  std::unique_ptr<char[]> owned_data_;
+  /** The actual data that is stored within a page, BUSTUB_PAGE_SIZE bytes usually owned by the buffer pool's arena. */
+  char *data_{nullptr};
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /**
+   * The pin count of this page. Threads pin a resident page without the buffer pool latch, so the buffer pool claims
+   * a frame it is about to reuse by swapping a pin count of 0 for -1, which keeps everybody else from pinning it.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /** True while the page is being prefetched, until the buffer pool has seen the read complete. */
+  std::atomic<bool> io_pending_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Version for optimistic readers, bumped when the write latch is taken and when it is released. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
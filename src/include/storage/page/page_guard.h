@@ -15,8 +15,7 @@ class BasicPageGuard {
   BasicPageGuard(const BasicPageGuard &) = delete;
   auto operator=(const BasicPageGuard &) -> BasicPageGuard & = delete;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move constructor for BasicPageGuard
    *
    * When you call BasicPageGuard(std::move(other_guard)), you
@@ -27,8 +26,7 @@ class BasicPageGuard {
    */
   BasicPageGuard(BasicPageGuard &&that) noexcept;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Drop a page guard
    *
    * Dropping a page guard should clear all contents
@@ -38,8 +36,7 @@ class BasicPageGuard {
    */
   void Drop();
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move assignment for BasicPageGuard
    *
    * Similar to a move constructor, except that the move
@@ -50,8 +47,7 @@ class BasicPageGuard {
    */
   auto operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard &;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Destructor for BasicPageGuard
    *
    * When a page guard goes out of scope, it should behave as if
@@ -79,14 +75,54 @@ class BasicPageGuard {
   }
 
  private:
+  friend class OptimisticPageGuard;
   friend class ReadPageGuard;
   friend class WritePageGuard;
 
-  [[maybe_unused]] BufferPoolManager *bpm_{nullptr};
+  BufferPoolManager *bpm_{nullptr};
   Page *page_{nullptr};
   bool is_dirty_{false};
 };
 
+/**
+ * A pin on a page that is read without latching it. The guard remembers the version of the page when it was taken, and
+ * everything read through it must be checked with Validate() before it is trusted: a writer may have changed the page
+ * in the meantime, in which case the reader has to start over.
+ */
+class OptimisticPageGuard {
+ public:
+  OptimisticPageGuard() = default;
+
+  OptimisticPageGuard(BufferPoolManager *bpm, Page *page)
+      : guard_(bpm, page), version_(page == nullptr ? 1 : page->GetVersion()) {}
+
+  OptimisticPageGuard(const OptimisticPageGuard &) = delete;
+  auto operator=(const OptimisticPageGuard &) -> OptimisticPageGuard & = delete;
+  OptimisticPageGuard(OptimisticPageGuard &&that) noexcept = default;
+  auto operator=(OptimisticPageGuard &&that) noexcept -> OptimisticPageGuard & = default;
+  ~OptimisticPageGuard() = default;
+
+  /** Drop the pin. */
+  void Drop() { guard_.Drop(); }
+
+  /** @return true if what was read through the guard so far is consistent, i.e. no writer latched the page since */
+  auto Validate() -> bool { return guard_.page_ != nullptr && guard_.page_->ValidateVersion(version_); }
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+  /** The version of the page when the guard was taken; odd (never valid) if the page could not be fetched. */
+  uint64_t version_{1};
+};
+
 class ReadPageGuard {
  public:
   ReadPageGuard() = default;
@@ -94,8 +130,7 @@ class ReadPageGuard {
   ReadPageGuard(const ReadPageGuard &) = delete;
   auto operator=(const ReadPageGuard &) -> ReadPageGuard & = delete;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move constructor for ReadPageGuard
    *
    * Very similar to BasicPageGuard. You want to create
@@ -104,8 +139,7 @@ class ReadPageGuard {
    */
   ReadPageGuard(ReadPageGuard &&that) noexcept;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move assignment for ReadPageGuard
    *
    * Very similar to BasicPageGuard. Given another ReadPageGuard,
@@ -113,8 +147,7 @@ class ReadPageGuard {
    */
   auto operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard &;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Drop a ReadPageGuard
    *
    * ReadPageGuard's Drop should behave similarly to BasicPageGuard,
@@ -124,8 +157,7 @@ class ReadPageGuard {
    */
   void Drop();
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Destructor for ReadPageGuard
    *
    * Just like with BasicPageGuard, this should behave
@@ -143,7 +175,6 @@ class ReadPageGuard {
   }
 
  private:
-  // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
 
@@ -154,8 +185,7 @@ class WritePageGuard {
   WritePageGuard(const WritePageGuard &) = delete;
   auto operator=(const WritePageGuard &) -> WritePageGuard & = delete;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move constructor for WritePageGuard
    *
    * Very similar to BasicPageGuard. You want to create
@@ -164,8 +194,7 @@ class WritePageGuard {
    */
   WritePageGuard(WritePageGuard &&that) noexcept;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move assignment for WritePageGuard
    *
    * Very similar to BasicPageGuard. Given another WritePageGuard,
@@ -173,8 +202,7 @@ class WritePageGuard {
    */
   auto operator=(WritePageGuard &&that) noexcept -> WritePageGuard &;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Drop a WritePageGuard
    *
    * WritePageGuard's Drop should behave similarly to BasicPageGuard,
@@ -184,8 +212,7 @@ class WritePageGuard {
    */
   void Drop();
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Destructor for WritePageGuard
    *
    * Just like with BasicPageGuard, this should behave
@@ -210,7 +237,6 @@ class WritePageGuard {
   }
 
  private:
-  // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
 
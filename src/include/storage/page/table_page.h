@@ -138,11 +138,21 @@ class TablePage : public Page {
    */
   auto GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool;
 
+  /** @return the number of bytes that can still be claimed by new tuples and their slots */
+  auto GetFreeSpaceRemaining() -> uint32_t {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
+  /** @return the number of free bytes a page needs for InsertTuple to accept the given tuple */
+  static auto GetRequiredSpace(const Tuple &tuple) -> uint32_t { return tuple.size_ + SIZE_TUPLE; }
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
   static constexpr size_t SIZE_TUPLE = 8;
+  // Offsets and sizes in the slot array are 32 bit, and a page must hold at least one tuple of the default varchar.
+  static_assert(SIZE_TABLE_PAGE_HEADER + SIZE_TUPLE + VARCHAR_DEFAULT_LENGTH <= BUSTUB_PAGE_USABLE_SIZE);
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
@@ -167,10 +177,6 @@ class TablePage : public Page {
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  auto GetFreeSpaceRemaining() -> uint32_t {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   /** @return tuple offset at slot slot_num */
   auto GetTupleOffsetAtSlot(uint32_t slot_num) -> uint32_t {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
@@ -31,6 +31,8 @@ class TmpTuplePage : public Page {
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+  // The header holds the page id and the free space pointer.
+  static_assert(sizeof(page_id_t) + sizeof(uint32_t) < BUSTUB_PAGE_USABLE_SIZE);
 };
 
 }  // namespace bustub
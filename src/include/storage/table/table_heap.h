@@ -12,8 +12,14 @@
 
 #pragma once
 
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
+#include "storage/page/free_space_map_page.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
@@ -22,7 +28,8 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages, plus a free space map (see FreeSpaceMapPage) that lets inserts find a
+ * page with room without walking that list.
  */
 class TableHeap {
   friend class TableIterator;
@@ -35,10 +42,12 @@ class TableHeap {
    * @param buffer_pool_manager the buffer pool manager
    * @param lock_manager the lock manager
    * @param log_manager the log manager
-   * @param first_page_id the id of the first page
+   * @param first_page_id the id of the first page, which also gives the segment of the table
+   * @param fsm_page_id the root free space map page the table had, see GetFreeSpaceMapPageId(), which the map is
+   * rebuilt in; INVALID_PAGE_ID builds it in new pages
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            page_id_t first_page_id);
+            page_id_t first_page_id, page_id_t fsm_page_id = INVALID_PAGE_ID);
 
   /**
    * Create a table heap with a transaction. (create table)
@@ -46,9 +55,10 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param segment_id the segment to keep the pages of the table in
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, segment_id_t segment_id = DEFAULT_SEGMENT_ID);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
@@ -108,11 +118,71 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the segment the pages of the table are kept in */
+  inline auto GetSegmentId() const -> segment_id_t { return segment_id_; }
+
+  /** @return the id of the root free space map page of this table, to keep with its metadata */
+  inline auto GetFreeSpaceMapPageId() const -> page_id_t { return fsm_page_id_; }
+
  private:
+  /**
+   * Predict the pages a sequential scan will visit after a table page. The free space map tracks table pages in the
+   * order they were appended to the chain, so this reads only FSM pages, never the table pages themselves.
+   * @param page_id the table page the scan is on
+   * @param max_pages the maximum number of pages to return
+   * @param[out] page_ids the predicted pages, in scan order
+   */
+  void GetNextTablePageIds(page_id_t page_id, size_t max_pages, std::vector<page_id_t> *page_ids);
+
+  /** Location of a table page's entry in the free space map: (FSM page id, slot). */
+  using FsmSlot = std::pair<page_id_t, uint32_t>;
+
+  /**
+   * Walk the table page chain and build the free space map. Changes to the map are not logged, so it may not match the
+   * table pages after a crash, and an opened heap always builds it again. The root FSM page is reused if there is one,
+   * and the rest of its old chain is deleted.
+   */
+  void BuildFreeSpaceMap();
+
+  /**
+   * Start tracking a table page in the free space map. The caller must hold the write latch on the root FSM page.
+   * @param fsm_root the latched root FSM page
+   * @param table_page_id the table page to track
+   * @param free_space the number of bytes free on the table page
+   * @return false if a new FSM page was needed but could not be allocated
+   */
+  auto TrackTablePage(FreeSpaceMapPage *fsm_root, page_id_t table_page_id, uint32_t free_space) -> bool;
+
+  /** Record the current free space of a tracked table page in the free space map. */
+  void UpdateFreeSpace(page_id_t table_page_id, uint32_t free_space);
+
+  /**
+   * Use the free space map to find a table page that should have room for a tuple.
+   * @param required_space the number of free bytes needed
+   * @return the id of a candidate table page, or INVALID_PAGE_ID if no tracked page has enough room
+   */
+  auto FindPageWithSpace(uint32_t required_space) -> page_id_t;
+
+  /**
+   * Append a new table page to the end of the heap and insert the tuple into it.
+   * @return true iff the insert is successful
+   */
+  auto AppendTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** The segment every page of the table is allocated in. */
+  segment_id_t segment_id_{DEFAULT_SEGMENT_ID};
+  /** The root page of the free space map. */
+  page_id_t fsm_page_id_{INVALID_PAGE_ID};
+  /** Protects fsm_slots_ and fsm_hint_page_id_. */
+  std::mutex fsm_latch_;
+  /** Where each table page is tracked in the free space map. */
+  std::unordered_map<page_id_t, FsmSlot> fsm_slots_;
+  /** The FSM page where the last successful lookup found room, where the next lookup starts. */
+  page_id_t fsm_hint_page_id_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
@@ -24,6 +24,11 @@ class TableHeap;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ *
+ * Once the iterator follows a next-page link, it reads ahead: it asks the buffer pool to prefetch the next pages of
+ * the chain (predicted from the table's free space map) with AccessType::Scan. The window starts at
+ * TABLE_READAHEAD_MIN_PAGES and doubles each time the scan reaches the pages prefetched last time, up to
+ * TABLE_READAHEAD_MAX_PAGES or a quarter of the buffer pool. It halves when the pool cannot take the whole window.
  */
 class TableIterator {
   friend class Cursor;
@@ -32,7 +37,13 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        readahead_window_(other.readahead_window_),
+        readahead_trigger_page_id_(other.readahead_trigger_page_id_),
+        readahead_last_page_id_(other.readahead_last_page_id_),
+        pages_since_readahead_(other.pages_since_readahead_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,13 +65,28 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    readahead_window_ = other.readahead_window_;
+    readahead_trigger_page_id_ = other.readahead_trigger_page_id_;
+    readahead_last_page_id_ = other.readahead_last_page_id_;
+    pages_since_readahead_ = other.pages_since_readahead_;
     return *this;
   }
 
  private:
+  /** Called when the scan has moved on to page_id by following a next-page link. Issues read-ahead if it is due. */
+  void ReadAhead(page_id_t page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Size of the last read-ahead window, 0 before the scan first moved to another page. */
+  size_t readahead_window_{0};
+  /** The first page of the last window. Reaching it issues the next window. */
+  page_id_t readahead_trigger_page_id_{INVALID_PAGE_ID};
+  /** The last page of the last window. The next window starts after it. */
+  page_id_t readahead_last_page_id_{INVALID_PAGE_ID};
+  /** Pages visited since the last window was issued, to notice when the scan left the predicted pages. */
+  size_t pages_since_readahead_{0};
 };
 
 }  // namespace bustub
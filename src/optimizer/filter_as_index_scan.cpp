@@ -0,0 +1,93 @@
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** Collect the `column = constant` terms of a conjunction, by column. */
+void CollectEqualities(const AbstractExpressionRef &expr, std::unordered_map<uint32_t, Value> *equalities) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(expr.get());
+      logic != nullptr && logic->logic_type_ == LogicType::And) {
+    CollectEqualities(logic->GetChildAt(0), equalities);
+    CollectEqualities(logic->GetChildAt(1), equalities);
+    return;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (comparison == nullptr || comparison->comp_type_ != ComparisonType::Equal) {
+    return;
+  }
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1).get());
+  if (column == nullptr || constant == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0).get());
+  }
+  // Nothing equals NULL, so such terms are left to the filter.
+  if (column == nullptr || constant == nullptr || constant->val_.IsNull()) {
+    return;
+  }
+  equalities->emplace(column->GetColIdx(), constant->val_);
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(filter_plan.children_.size() == 1, "Filter with multiple children?? Impossible!");
+  const auto &child_plan = filter_plan.children_[0];
+  if (child_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+
+  std::unordered_map<uint32_t, Value> equalities;
+  CollectEqualities(filter_plan.GetPredicate(), &equalities);
+  if (equalities.empty()) {
+    return optimized_plan;
+  }
+
+  const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+  for (const auto *index : catalog_.GetTableIndexes(table_info->name_)) {
+    // Every key column has to be fixed by an equality on a constant of its own type.
+    std::vector<Value> key_values;
+    for (auto column_id : index->index_->GetKeyAttrs()) {
+      auto equality = equalities.find(column_id);
+      if (equality == equalities.end() ||
+          equality->second.GetTypeId() != table_info->schema_.GetColumn(column_id).GetType()) {
+        break;
+      }
+      key_values.push_back(equality->second);
+    }
+    if (key_values.size() == index->index_->GetKeyAttrs().size()) {
+      // The filter stays on top for the terms the index does not cover.
+      auto index_scan =
+          std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, index->index_oid_, std::move(key_values));
+      return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, filter_plan.GetPredicate(),
+                                              std::move(index_scan));
+    }
+  }
+  return optimized_plan;
+}
+
+}  // namespace bustub
@@ -13,6 +13,7 @@ auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanN
   p = OptimizeMergeFilterNLJ(p);
   p = OptimizeNLJAsIndexJoin(p);
   // p = OptimizeNLJAsHashJoin(p);  // Enable this rule after you have implemented hash join.
+  p = OptimizeFilterAsIndexScan(p);
   p = OptimizeOrderByAsIndexScan(p);
   p = OptimizeSortLimitAsTopN(p);
   return p;
@@ -37,11 +37,12 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       return optimized_plan;
     }
 
-    // Order type is asc or default
+    // Order type is asc, default or desc; a descending order scans the index in reverse
     const auto &[order_type, expr] = order_bys[0];
-    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+    if (order_type == OrderByType::INVALID) {
       return optimized_plan;
     }
+    bool reverse = order_type == OrderByType::DESC;
 
     // Order expression is a column value expression
     const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
@@ -62,10 +63,11 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
 
       for (const auto *index : indices) {
         const auto &columns = index->key_schema_.GetColumns();
-        if (columns.size() == 1 &&
-            columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
+        // Keys are ordered by their first column first, so composite indexes match as well.
+        if (!columns.empty() && columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
           // Index matched, return index scan instead
-          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_,
+                                                     std::vector<Value>{}, reverse);
         }
       }
     }
@@ -10,30 +10,49 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/crc32c.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** @return a page-aligned buffer for direct I/O on a caller's unaligned buffer, one per thread */
+static auto BounceBuffer() -> char * {
+  alignas(BUSTUB_PAGE_SIZE) static thread_local char buffer[BUSTUB_PAGE_SIZE];
+  return buffer;
+}
+
+static auto IsPageAligned(const char *data) -> bool {
+  return reinterpret_cast<uintptr_t>(data) % BUSTUB_PAGE_SIZE == 0;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io, DiskSyncPolicy sync_policy, bool page_checksums)
+    : sync_policy_(sync_policy), page_checksums_(page_checksums), file_name_(db_file), segments_(MAX_SEGMENTS) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
+    AddSegment(DEFAULT_SEGMENT_ID, -1, "");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
@@ -49,18 +68,47 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // open the file, or create it if it does not exist
+#ifdef O_DIRECT
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+    if (!direct_io_ && errno == EINVAL) {
+      LOG_DEBUG("the file system does not support O_DIRECT, using buffered I/O");
     }
   }
+#endif
+  if (!direct_io_) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
   buffer_used = nullptr;
+  AddSegment(DEFAULT_SEGMENT_ID, db_fd_, file_name_);
+
+  // pick up the segment files of an existing database
+  for (segment_id_t segment_id = DEFAULT_SEGMENT_ID + 1; segment_id < MAX_SEGMENTS; segment_id++) {
+    auto segment_file_name = GetSegmentFileName(segment_id);
+    if (GetFileSize(segment_file_name) < 0) {
+      continue;
+    }
+    int fd = OpenFile(segment_file_name);
+    if (fd < 0) {
+      throw Exception("can't open segment file " + segment_file_name);
+    }
+    AddSegment(segment_id, fd, segment_file_name);
+  }
+}
+
+DiskManager::DiskManager() : segments_(MAX_SEGMENTS) { AddSegment(DEFAULT_SEGMENT_ID, -1, ""); }
+
+DiskManager::~DiskManager() {
+  for (auto &segment : segments_) {
+    if (segment != nullptr && segment->fd_ >= 0) {
+      close(segment->fd_);
+    }
+  }
 }
 
 /**
@@ -68,58 +116,574 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
  */
 void DiskManager::ShutDown() {
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    std::unique_lock lock(segments_latch_);
+    for (auto &segment : segments_) {
+      if (segment == nullptr || segment->fd_ < 0) {
+        continue;
+      }
+      {
+        std::scoped_lock segment_lock(segment->latch_);
+        WriteDirtyMaps(segment.get());
+      }
+      if (sync_policy_ != DiskSyncPolicy::None) {
+        fdatasync(segment->fd_);
+      }
+      close(segment->fd_);
+      segment->fd_ = -1;
+    }
+    db_fd_ = -1;
   }
   log_io_.close();
 }
 
+void DiskManager::RemoveDatabase(const std::string &db_file) {
+  std::string::size_type n = db_file.rfind('.');
+  if (n != std::string::npos) {
+    unlink((db_file.substr(0, n) + ".log").c_str());
+  }
+  for (segment_id_t segment_id = DEFAULT_SEGMENT_ID + 1; segment_id < MAX_SEGMENTS; segment_id++) {
+    unlink((db_file + "." + std::to_string(segment_id)).c_str());
+  }
+  unlink(db_file.c_str());
+}
+
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+  std::shared_lock lock(segments_latch_);
+  auto *segment = FindSegment(page_id);
+  if (segment == nullptr) {
+    LOG_DEBUG("writing a page of a segment that does not exist");
+    return;
+  }
+  PersistAllocation(segment, page_id);
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  if (page_checksums_) {
+    // Stamp a copy, the caller's page may be read concurrently.
+    auto *stamped = static_cast<char *>(memcpy(BounceBuffer(), page_data, BUSTUB_PAGE_SIZE));
+    StampChecksum(stamped);
+    page_data = stamped;
+  }
+  WriteAt(segment, GetPageOffset(page_id), page_data);
+  if (sync_policy_ == DiskSyncPolicy::EveryWrite) {
+    fdatasync(segment->fd_);
+  }
+}
+
+/**
+ * Force the pages written so far to stable storage
+ */
+void DiskManager::Sync() {
+  if (sync_policy_ != DiskSyncPolicy::OnFlush) {
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  std::shared_lock lock(segments_latch_);
+  for (auto &segment : segments_) {
+    if (segment != nullptr && segment->fd_ >= 0 && fdatasync(segment->fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing");
+    }
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
+auto DiskManager::ReadPage(page_id_t page_id, char *page_data) -> bool {
+  std::shared_lock lock(segments_latch_);
+  auto *segment = FindSegment(page_id);
+  if (segment == nullptr) {
+    LOG_DEBUG("reading a page of a segment that does not exist");
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return true;
+  }
+  if (!ReadAt(segment, GetPageOffset(page_id), page_data)) {
+    return false;
+  }
+  return VerifyPage(page_id, page_data);
+}
+
+/**
+ * Page checksums
+ */
+auto DiskManager::ComputeChecksum(const char *page_data) -> uint32_t {
+  auto checksum = Crc32c::Compute(page_data, BUSTUB_PAGE_USABLE_SIZE);
+  // Zero marks a page without a checksum.
+  return checksum == 0 ? 1 : checksum;
+}
+
+void DiskManager::StampChecksum(char *page_data) {
+  auto checksum = ComputeChecksum(page_data);
+  memcpy(page_data + BUSTUB_PAGE_USABLE_SIZE, &checksum, sizeof(checksum));
+}
+
+auto DiskManager::VerifyPage(page_id_t page_id, const char *page_data) -> bool {
+  if (!page_checksums_) {
+    return true;
+  }
+  uint32_t checksum;
+  memcpy(&checksum, page_data + BUSTUB_PAGE_USABLE_SIZE, sizeof(checksum));
+  if (checksum == 0 || checksum == ComputeChecksum(page_data)) {
+    return true;
+  }
+  num_checksum_failures_++;
+  LOG_WARN("page %d failed its checksum", page_id);
+  return false;
+}
+
+void DiskManager::WriteAt(SegmentFile *segment, int64_t offset, const char *page_data) {
+  if (segment->fd_ < 0) {
+    return;
+  }
+  ReserveExtents(segment, offset + BUSTUB_PAGE_SIZE);
+  if (direct_io_ && !IsPageAligned(page_data)) {
+    page_data = static_cast<const char *>(memcpy(BounceBuffer(), page_data, BUSTUB_PAGE_SIZE));
+  }
+  size_t written = 0;
+  while (written < BUSTUB_PAGE_SIZE) {
+    auto ret = pwrite(segment->fd_, page_data + written, BUSTUB_PAGE_SIZE - written, offset + written);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (ret <= 0) {
+      LOG_DEBUG("I/O error while writing");
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+    written += ret;
+  }
+}
+
+void DiskManager::ReserveExtents(SegmentFile *segment, int64_t end) {
+  if (end <= segment->reserved_size_) {
+    return;
+  }
+  // Reserve whole extents ahead of the writes, so the file system can place the pages of a segment contiguously.
+  std::scoped_lock lock(segment->extent_latch_);
+  int64_t reserved = segment->reserved_size_;
+  if (end > reserved) {
+    auto new_reserved = (end + DISK_EXTENT_SIZE - 1) / DISK_EXTENT_SIZE * DISK_EXTENT_SIZE;
+#ifdef FALLOC_FL_KEEP_SIZE
+    fallocate(segment->fd_, FALLOC_FL_KEEP_SIZE, reserved, new_reserved - reserved);
+#endif
+    segment->reserved_size_ = new_reserved;
+  }
+}
+
+auto DiskManager::ReadAt(SegmentFile *segment, int64_t offset, char *page_data) -> bool {
+  char *out = page_data;
+  if (direct_io_ && !IsPageAligned(page_data)) {
+    page_data = BounceBuffer();
+  }
+  size_t read_count = 0;
+  while (segment->fd_ >= 0 && read_count < BUSTUB_PAGE_SIZE) {
+    auto ret = pread(segment->fd_, page_data + read_count, BUSTUB_PAGE_SIZE - read_count, offset + read_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      LOG_DEBUG("I/O error while reading");
+      return false;
+    }
+    // the file ends before the page does
+    if (ret == 0) {
+      break;
+    }
+    read_count += ret;
+  }
+  if (read_count < BUSTUB_PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+  if (out != page_data) {
+    memcpy(out, page_data, BUSTUB_PAGE_SIZE);
+  }
+  return true;
+}
+
+/**
+ * Segment operations
+ */
+auto DiskManager::GetSegmentFileName(segment_id_t segment_id) const -> std::string {
+  return file_name_ + "." + std::to_string(segment_id);
+}
+
+auto DiskManager::OpenFile(const std::string &file_name) const -> int {
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io_) {
+    flags |= O_DIRECT;
+  }
+#endif
+  return open(file_name.c_str(), flags, 0644);
+}
+
+void DiskManager::AddSegment(segment_id_t segment_id, int fd, const std::string &file_name) {
+  auto segment = std::make_unique<SegmentFile>();
+  segment->first_page_id_ = GetFirstPageId(segment_id);
+  segment->fd_ = fd;
+  segment->file_name_ = file_name;
+
+  struct stat stat_buf;
+  if (fd >= 0 && fstat(fd, &stat_buf) == 0 && stat_buf.st_size > 0) {
+    segment->reserved_size_ = (stat_buf.st_size + DISK_EXTENT_SIZE - 1) / DISK_EXTENT_SIZE * DISK_EXTENT_SIZE;
+    auto group_size = (PAGES_PER_MAP + 1) * static_cast<int64_t>(BUSTUB_PAGE_SIZE);
+    auto num_groups = static_cast<size_t>((stat_buf.st_size + group_size - 1) / group_size);
+    segment->map_.resize(num_groups * BUSTUB_PAGE_SIZE);
+    for (size_t group = 0; group < num_groups; group++) {
+      ReadAt(segment.get(), GetMapOffset(group),
+             reinterpret_cast<char *>(segment->map_.data() + group * BUSTUB_PAGE_SIZE));
+    }
+    segment->durable_map_ = segment->map_;
+    segment->map_dirty_.assign(num_groups, false);
+    for (size_t i = 0; i < segment->map_.size(); i++) {
+      if (segment->map_[i] != 0) {
+        segment->num_allocated_pages_ += __builtin_popcount(segment->map_[i]);
+        // one past the highest bit set in this byte
+        segment->page_limit_ = static_cast<int64_t>(i * 8 + 32 - __builtin_clz(segment->map_[i]));
+      }
+    }
+  }
+  segments_[segment_id] = std::move(segment);
+}
+
+auto DiskManager::FindSegment(page_id_t page_id) -> SegmentFile * {
+  auto segment_id = GetSegmentId(page_id);
+  if (segment_id < 0 || segment_id >= MAX_SEGMENTS) {
+    return nullptr;
+  }
+  return segments_[segment_id].get();
+}
+
+auto DiskManager::GetFileDescriptor(page_id_t page_id) -> int {
+  std::shared_lock lock(segments_latch_);
+  auto *segment = FindSegment(page_id);
+  return segment == nullptr ? -1 : segment->fd_;
+}
+
+auto DiskManager::CreateSegment() -> segment_id_t {
+  std::unique_lock lock(segments_latch_);
+  for (segment_id_t segment_id = DEFAULT_SEGMENT_ID + 1; segment_id < MAX_SEGMENTS; segment_id++) {
+    if (segments_[segment_id] != nullptr) {
+      continue;
+    }
+    // Segments of a disk manager without a database file live in memory only.
+    int fd = -1;
+    std::string segment_file_name;
+    if (segments_[DEFAULT_SEGMENT_ID]->fd_ >= 0) {
+      segment_file_name = GetSegmentFileName(segment_id);
+      fd = OpenFile(segment_file_name);
+      if (fd < 0) {
+        throw Exception("can't create segment file " + segment_file_name);
+      }
+      if (ftruncate(fd, 0) != 0) {
+        LOG_DEBUG("cannot truncate a stale segment file");
+      }
     }
+    AddSegment(segment_id, fd, segment_file_name);
+    return segment_id;
+  }
+  return INVALID_SEGMENT_ID;
+}
+
+auto DiskManager::DropSegment(segment_id_t segment_id) -> bool {
+  std::unique_lock lock(segments_latch_);
+  if (segment_id <= DEFAULT_SEGMENT_ID || segment_id >= MAX_SEGMENTS || segments_[segment_id] == nullptr) {
+    return false;
+  }
+  auto &segment = segments_[segment_id];
+  if (segment->fd_ >= 0) {
+    close(segment->fd_);
+    unlink(segment->file_name_.c_str());
+  }
+  segment.reset();
+  return true;
+}
+
+auto DiskManager::HasSegment(segment_id_t segment_id) -> bool {
+  std::shared_lock lock(segments_latch_);
+  return segment_id >= 0 && segment_id < MAX_SEGMENTS && segments_[segment_id] != nullptr;
+}
+
+auto DiskManager::GetSegments() -> std::vector<segment_id_t> {
+  std::shared_lock lock(segments_latch_);
+  std::vector<segment_id_t> segment_ids;
+  for (segment_id_t segment_id = 0; segment_id < MAX_SEGMENTS; segment_id++) {
+    if (segments_[segment_id] != nullptr) {
+      segment_ids.push_back(segment_id);
+    }
+  }
+  return segment_ids;
+}
+
+/**
+ * Allocation map operations
+ */
+void DiskManager::GrowAllocationMap(SegmentFile *segment, int64_t page_no) {
+  auto num_groups = static_cast<size_t>(page_no / PAGES_PER_MAP + 1);
+  if (segment->map_dirty_.size() < num_groups) {
+    segment->map_.resize(num_groups * BUSTUB_PAGE_SIZE, 0);
+    segment->durable_map_.resize(num_groups * BUSTUB_PAGE_SIZE, 0);
+    segment->map_dirty_.resize(num_groups, false);
+  }
+}
+
+void DiskManager::WriteDirtyMaps(SegmentFile *segment) {
+  if (!segment->has_dirty_maps_) {
+    return;
+  }
+  for (size_t group = 0; group < segment->map_dirty_.size(); group++) {
+    if (segment->map_dirty_[group]) {
+      WriteAt(segment, GetMapOffset(group),
+              reinterpret_cast<const char *>(segment->durable_map_.data() + group * BUSTUB_PAGE_SIZE));
+    }
+    segment->map_dirty_[group] = false;
+  }
+  segment->has_dirty_maps_ = false;
+}
+
+void DiskManager::AllocatePage(page_id_t page_id) {
+  std::shared_lock lock(segments_latch_);
+  auto *segment = FindSegment(page_id);
+  if (segment == nullptr) {
+    return;
+  }
+  std::scoped_lock segment_lock(segment->latch_);
+  auto page_no = GetPageNumber(page_id);
+  GrowAllocationMap(segment, page_no);
+  auto byte = static_cast<size_t>(page_no / 8);
+  uint8_t bit = 1U << (page_no % 8);
+  segment->deallocated_pages_.erase(page_id);
+  if ((segment->map_[byte] & bit) != 0) {
+    return;
+  }
+  segment->map_[byte] |= bit;
+  segment->num_allocated_pages_++;
+  segment->page_limit_ = std::max(segment->page_limit_, page_no + 1);
+  if ((segment->durable_map_[byte] & bit) == 0) {
+    segment->durable_map_[byte] |= bit;
+    segment->map_dirty_[page_no / PAGES_PER_MAP] = true;
+    segment->has_dirty_maps_ = true;
+  }
+}
+
+auto DiskManager::DeallocatePage(page_id_t page_id) -> bool {
+  std::shared_lock lock(segments_latch_);
+  auto *segment = FindSegment(page_id);
+  if (segment == nullptr || page_id < 0) {
+    return false;
+  }
+  std::scoped_lock segment_lock(segment->latch_);
+  auto page_no = GetPageNumber(page_id);
+  auto byte = static_cast<size_t>(page_no / 8);
+  uint8_t bit = 1U << (page_no % 8);
+  if (byte >= segment->map_.size() || (segment->map_[byte] & bit) == 0) {
+    return false;
+  }
+  segment->map_[byte] &= ~bit;
+  segment->num_allocated_pages_--;
+  segment->deallocated_pages_.insert(page_id);
+  return true;
+}
+
+auto DiskManager::IsPageAllocated(page_id_t page_id) -> bool {
+  std::shared_lock lock(segments_latch_);
+  auto *segment = FindSegment(page_id);
+  if (segment == nullptr || page_id < 0) {
+    return false;
+  }
+  std::scoped_lock segment_lock(segment->latch_);
+  auto page_no = GetPageNumber(page_id);
+  auto byte = static_cast<size_t>(page_no / 8);
+  return byte < segment->map_.size() && (segment->map_[byte] & (1U << (page_no % 8))) != 0;
+}
+
+auto DiskManager::GetNumAllocatedPages(segment_id_t segment_id) -> size_t {
+  std::shared_lock lock(segments_latch_);
+  auto *segment = FindSegment(GetFirstPageId(segment_id));
+  if (segment == nullptr) {
+    return 0;
+  }
+  std::scoped_lock segment_lock(segment->latch_);
+  return segment->num_allocated_pages_;
+}
+
+auto DiskManager::GetPageIdLimit(segment_id_t segment_id) -> page_id_t {
+  std::shared_lock lock(segments_latch_);
+  auto *segment = FindSegment(GetFirstPageId(segment_id));
+  if (segment == nullptr) {
+    return GetFirstPageId(segment_id);
+  }
+  std::scoped_lock segment_lock(segment->latch_);
+  return segment->first_page_id_ + static_cast<page_id_t>(segment->page_limit_);
+}
+
+auto DiskManager::GetFreePages(segment_id_t segment_id) -> std::vector<page_id_t> {
+  std::shared_lock lock(segments_latch_);
+  std::vector<page_id_t> free_pages;
+  auto *segment = FindSegment(GetFirstPageId(segment_id));
+  if (segment == nullptr) {
+    return free_pages;
+  }
+  std::scoped_lock segment_lock(segment->latch_);
+  for (int64_t page_no = 0; page_no < segment->page_limit_; page_no++) {
+    if ((segment->map_[page_no / 8] & (1U << (page_no % 8))) == 0) {
+      free_pages.push_back(segment->first_page_id_ + static_cast<page_id_t>(page_no));
+    }
+  }
+  return free_pages;
+}
+
+auto DiskManager::PrepareWrite(page_id_t page_id, const char *page_data, char *copy) -> const char * {
+  std::shared_lock lock(segments_latch_);
+  auto *segment = FindSegment(page_id);
+  if (segment != nullptr && segment->fd_ >= 0) {
+    PersistAllocation(segment, page_id);
+    ReserveExtents(segment, GetPageOffset(page_id) + BUSTUB_PAGE_SIZE);
+  }
+  if (!page_checksums_) {
+    return page_data;
+  }
+  memcpy(copy, page_data, BUSTUB_PAGE_SIZE);
+  StampChecksum(copy);
+  return copy;
+}
+
+void DiskManager::PersistAllocation(SegmentFile *segment, page_id_t page_id) {
+  if (!segment->has_dirty_maps_ || segment->fd_ < 0) {
+    return;
+  }
+  std::scoped_lock lock(segment->latch_);
+  auto group = static_cast<size_t>(GetPageNumber(page_id) / PAGES_PER_MAP);
+  if (group >= segment->map_dirty_.size() || !segment->map_dirty_[group]) {
+    return;
+  }
+  // Write every dirty map, so the next pages written do not have to come back here.
+  WriteDirtyMaps(segment);
+  if (sync_policy_ != DiskSyncPolicy::None) {
+    fdatasync(segment->fd_);
+  }
+}
+
+auto DiskManager::TakeDeallocatedPages() -> std::vector<page_id_t> {
+  std::shared_lock lock(segments_latch_);
+  std::vector<page_id_t> page_ids;
+  for (auto &segment : segments_) {
+    if (segment == nullptr) {
+      continue;
+    }
+    std::scoped_lock segment_lock(segment->latch_);
+    page_ids.insert(page_ids.end(), segment->deallocated_pages_.begin(), segment->deallocated_pages_.end());
+    segment->deallocated_pages_.clear();
+  }
+  return page_ids;
+}
+
+void DiskManager::PersistDeallocations(const std::vector<page_id_t> &page_ids) {
+  std::shared_lock lock(segments_latch_);
+  for (auto page_id : page_ids) {
+    // The segment may have been dropped meanwhile.
+    auto *segment = FindSegment(page_id);
+    if (segment == nullptr) {
+      continue;
+    }
+    std::scoped_lock segment_lock(segment->latch_);
+    auto page_no = GetPageNumber(page_id);
+    auto byte = static_cast<size_t>(page_no / 8);
+    uint8_t bit = 1U << (page_no % 8);
+    // The page was allocated again since, or deallocated again and still referenced until the next flush.
+    if ((segment->map_[byte] & bit) != 0 || segment->deallocated_pages_.count(page_id) > 0) {
+      continue;
+    }
+    if ((segment->durable_map_[byte] & bit) != 0) {
+      segment->durable_map_[byte] &= ~bit;
+      segment->map_dirty_[page_no / PAGES_PER_MAP] = true;
+      segment->has_dirty_maps_ = true;
+    }
+  }
+  for (auto &segment : segments_) {
+    if (segment == nullptr || !segment->has_dirty_maps_ || segment->fd_ < 0) {
+      continue;
+    }
+    std::scoped_lock segment_lock(segment->latch_);
+    WriteDirtyMaps(segment.get());
+    if (sync_policy_ != DiskSyncPolicy::None) {
+      fdatasync(segment->fd_);
+    }
+  }
+}
+
+/**
+ * Give the space of free pages back to the file system
+ */
+auto DiskManager::Compact() -> size_t {
+  std::unique_lock lock(segments_latch_);
+  size_t reclaimed = 0;
+  for (auto &segment : segments_) {
+    if (segment != nullptr && segment->fd_ >= 0) {
+      reclaimed += CompactSegment(segment.get());
+    }
+  }
+  return reclaimed;
+}
+
+auto DiskManager::CompactSegment(SegmentFile *segment) -> size_t {
+  std::scoped_lock lock(segment->latch_);
+  WriteDirtyMaps(segment);
+  // Only deallocations that are durable may be reclaimed: the others can still be referenced by pages on disk.
+  auto &map = segment->durable_map_;
+  auto is_allocated = [&](int64_t page_no) { return (map[page_no / 8] & (1U << (page_no % 8))) != 0; };
+  int64_t limit = 0;
+  for (int64_t page_no = 0; static_cast<size_t>(page_no) < map.size() * 8; page_no++) {
+    if (is_allocated(page_no)) {
+      limit = page_no + 1;
+    }
+  }
+
+  size_t reclaimed = 0;
+  struct stat stat_buf;
+  if (fstat(segment->fd_, &stat_buf) != 0) {
+    return 0;
+  }
+  int64_t old_size = stat_buf.st_size;
+  auto new_size = limit == 0 ? 0 : GetPageOffset(static_cast<page_id_t>(limit - 1)) + BUSTUB_PAGE_SIZE;
+  if (old_size > new_size) {
+    if (ftruncate(segment->fd_, new_size) != 0) {
+      LOG_DEBUG("cannot truncate the db file");
+      return 0;
+    }
+    reclaimed += static_cast<size_t>((old_size - new_size) / BUSTUB_PAGE_SIZE);
+  }
+  segment->reserved_size_ = new_size;
+
+#ifdef FALLOC_FL_PUNCH_HOLE
+  // Punch out runs of free pages; a run never spans a map page, which stays in place.
+  int64_t page_no = 0;
+  while (page_no < limit) {
+    if (is_allocated(page_no)) {
+      page_no++;
+      continue;
+    }
+    auto run_start = page_no;
+    while (page_no < limit && !is_allocated(page_no) && (page_no == run_start || page_no % PAGES_PER_MAP != 0)) {
+      page_no++;
+    }
+    auto offset = GetPageOffset(static_cast<page_id_t>(run_start));
+    auto length = (page_no - run_start) * BUSTUB_PAGE_SIZE;
+    if (fallocate(segment->fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, length) == 0) {
+      reclaimed += page_no - run_start;
+    }
+  }
+#endif
+
+  segment->map_ = segment->durable_map_;
+  segment->page_limit_ = limit;
+  segment->deallocated_pages_.clear();
+  segment->num_allocated_pages_ = 0;
+  for (auto byte : segment->map_) {
+    segment->num_allocated_pages_ += __builtin_popcount(byte);
   }
+  return reclaimed;
 }
 
 /**
@@ -42,9 +42,10 @@ void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
 /**
  * Read the contents of the specified page into the given memory area
  */
-void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
+auto DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) -> bool {
   int64_t offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
   memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
+  return true;
 }
 
 }  // namespace bustub
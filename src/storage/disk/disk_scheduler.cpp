@@ -0,0 +1,429 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/fs.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+#ifdef __linux__
+
+/**
+ * A minimal io_uring talking to the kernel through the raw system calls, so that no liburing is needed. It is only
+ * ever used by the single io_uring thread of a DiskScheduler, so neither side of the ring needs a lock.
+ */
+class IoUring {
+ public:
+  /**
+   * @param entries the queue depth
+   * @return the ring, or nullptr if the kernel does not support (or does not allow) io_uring
+   */
+  static auto Create(unsigned entries) -> std::unique_ptr<IoUring> {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd < 0) {
+      LOG_DEBUG("io_uring is not available, using the worker pool instead");
+      return nullptr;
+    }
+    auto ring = std::unique_ptr<IoUring>(new IoUring(ring_fd));
+    if (!ring->SupportsReadWrite()) {
+      LOG_DEBUG("io_uring does not support IORING_OP_READ and IORING_OP_WRITE, using the worker pool instead");
+      return nullptr;
+    }
+    if (!ring->Map(params)) {
+      LOG_DEBUG("cannot map the io_uring, using the worker pool instead");
+      return nullptr;
+    }
+    return ring;
+  }
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_len_);
+    }
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_len_);
+    }
+    if (sq_ptr_ != MAP_FAILED) {
+      munmap(sq_ptr_, sq_len_);
+    }
+    close(ring_fd_);
+  }
+
+  DISALLOW_COPY_AND_MOVE(IoUring);
+
+  /** @return the number of requests that can be in flight at once */
+  auto Capacity() const -> unsigned { return sq_entries_; }
+
+  /**
+   * Put a request into the submission queue. The caller must not exceed Capacity() requests in flight.
+   * @param fd the segment file holding the requested page
+   * @param dsync whether a write has to reach stable storage before it completes
+   */
+  void Prepare(const DiskRequest &r, const char *data, int fd, uint64_t user_data, bool dsync) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = r.is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = BUSTUB_PAGE_SIZE;
+    sqe->off = static_cast<uint64_t>(DiskManager::GetPageOffset(r.page_id_));
+    sqe->user_data = user_data;
+    if (dsync && r.is_write_) {
+      sqe->rw_flags = RWF_DSYNC;
+    }
+    sq_array_[index] = index;
+    // The kernel may only see the new tail after the entry is written.
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  }
+
+  /**
+   * Submit prepared requests, then wait until at least min_complete requests have completed. While the kernel is out
+   * of resources (EAGAIN) or its completion queue is full (EBUSY), the call returns at once if there are completions to
+   * reap, which makes room, and otherwise retries with a growing sleep for up to SUBMIT_TIMEOUT.
+   * @param to_submit the number of prepared requests the kernel has not consumed yet
+   * @return the number of requests the kernel consumed, which are submitted in the order they were prepared, or -1 if
+   * the kernel rejected the submission (errno says why)
+   */
+  auto Submit(unsigned to_submit, unsigned min_complete) -> int {
+    auto backoff = std::chrono::microseconds(1);
+    auto deadline = std::chrono::steady_clock::now() + SUBMIT_TIMEOUT;
+    while (true) {
+      auto ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (ret >= 0) {
+        return static_cast<int>(ret);
+      }
+      if (errno == EINTR) {
+        continue;
+      }
+      if ((errno != EAGAIN && errno != EBUSY) || std::chrono::steady_clock::now() >= deadline) {
+        return -1;
+      }
+      if (HasCompletion()) {
+        return 0;
+      }
+      std::this_thread::sleep_for(backoff);
+      backoff = std::min(backoff * 2, MAX_SUBMIT_BACKOFF);
+    }
+  }
+
+  /** @return true if there is a completion to take off the completion queue */
+  auto HasCompletion() const -> bool { return *cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE); }
+
+  /**
+   * Take one completion off the completion queue.
+   * @return false if there are no completions
+   */
+  auto PopCompletion(uint64_t *user_data, int32_t *res) -> bool {
+    if (!HasCompletion()) {
+      return false;
+    }
+    unsigned head = *cq_head_;
+    const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+    *user_data = cqe.user_data;
+    *res = cqe.res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+ private:
+  /** How long Submit() keeps retrying while the kernel is out of resources. */
+  static constexpr auto SUBMIT_TIMEOUT = std::chrono::seconds(1);
+  /** The longest sleep between two of those retries. */
+  static constexpr auto MAX_SUBMIT_BACKOFF = std::chrono::microseconds(1000);
+
+  explicit IoUring(int ring_fd) : ring_fd_(ring_fd) {}
+
+  /**
+   * Kernels before 5.6 set up a ring but fail every IORING_OP_READ and IORING_OP_WRITE with EINVAL. They do not know
+   * IORING_REGISTER_PROBE either, so a failed probe means the opcodes are missing too.
+   */
+  auto SupportsReadWrite() const -> bool {
+    constexpr unsigned num_ops = 256;
+    std::vector<char> buffer(sizeof(io_uring_probe) + num_ops * sizeof(io_uring_probe_op), 0);
+    auto *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+    if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PROBE, probe, num_ops) < 0) {
+      return false;
+    }
+    auto supported = [probe](unsigned op) {
+      return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+    };
+    return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+  }
+
+  auto Map(const io_uring_params &params) -> bool {
+    sq_entries_ = params.sq_entries;
+    sq_len_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_len_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_len_ = std::max(sq_len_, cq_len_);
+    }
+    sq_ptr_ = mmap(nullptr, sq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+      return false;
+    }
+    if (single_mmap) {
+      cq_ptr_ = sq_ptr_;
+    } else {
+      cq_ptr_ = mmap(nullptr, cq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+      if (cq_ptr_ == MAP_FAILED) {
+        return false;
+      }
+    }
+    sqes_len_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(
+        mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+      return false;
+    }
+
+    auto *sq = static_cast<char *>(sq_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  /** The io_uring instance. */
+  int ring_fd_;
+  unsigned sq_entries_{0};
+
+  void *sq_ptr_{MAP_FAILED};
+  size_t sq_len_{0};
+  void *cq_ptr_{MAP_FAILED};
+  size_t cq_len_{0};
+  io_uring_sqe *sqes_{static_cast<io_uring_sqe *>(MAP_FAILED)};
+  size_t sqes_len_{0};
+
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+#else
+
+/** io_uring is Linux only; everywhere else the worker pool is used. */
+class IoUring {
+ public:
+  static auto Create(unsigned entries) -> std::unique_ptr<IoUring> { return nullptr; }
+};
+
+#endif
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers) : disk_manager_(disk_manager) {
+  if (disk_manager_->GetDbFileDescriptor() >= 0) {
+    io_uring_ = IoUring::Create(DISK_SCHEDULER_QUEUE_DEPTH);
+  }
+  if (io_uring_ != nullptr) {
+    background_threads_.emplace_back([this] { StartIoUringThread(); });
+    return;
+  }
+  BUSTUB_ASSERT(num_workers > 0, "The disk scheduler needs at least one worker.");
+  for (size_t i = 0; i < num_workers; ++i) {
+    background_threads_.emplace_back([this] { StartWorkerThread(); });
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  // Put a `std::nullopt` in the queue for every thread to signal them to exit
+  for (size_t i = 0; i < background_threads_.size(); ++i) {
+    request_queue_.Put(std::nullopt);
+  }
+  for (auto &thread : background_threads_) {
+    thread.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) { request_queue_.Put(std::make_optional(std::move(r))); }
+
+void DiskScheduler::Schedule(std::vector<DiskRequest> requests) {
+  for (auto &r : requests) {
+    request_queue_.Put(std::make_optional(std::move(r)));
+  }
+}
+
+void DiskScheduler::StartWorkerThread() {
+  while (true) {
+    auto r = request_queue_.Get();
+    if (!r.has_value()) {
+      return;
+    }
+    ExecuteDirectly(&*r);
+  }
+}
+
+void DiskScheduler::ExecuteDirectly(DiskRequest *r) {
+  bool ok = true;
+  if (r->is_write_) {
+    disk_manager_->WritePage(r->page_id_, r->data_);
+  } else {
+    ok = disk_manager_->ReadPage(r->page_id_, r->data_);
+  }
+  r->callback_.set_value(ok);
+}
+
+void DiskScheduler::StartIoUringThread() {
+#ifdef __linux__
+  // Requests in flight, indexed by the user data of their submission queue entry.
+  std::vector<std::optional<DiskRequest>> in_flight(io_uring_->Capacity());
+  std::vector<uint64_t> free_slots;
+  for (uint64_t slot = in_flight.size(); slot > 0; --slot) {
+    free_slots.push_back(slot - 1);
+  }
+  // Writes go out from a page aligned copy per slot when the disk manager stamps checksums into them.
+  auto free_buffers = [](char *buffers) { ::operator delete[](buffers, std::align_val_t{BUSTUB_PAGE_SIZE}); };
+  std::unique_ptr<char, decltype(free_buffers)> write_buffers(
+      static_cast<char *>(::operator new[](in_flight.size() * BUSTUB_PAGE_SIZE, std::align_val_t{BUSTUB_PAGE_SIZE})),
+      free_buffers);
+  // Slots of the prepared requests the kernel has not consumed yet, oldest first.
+  std::vector<uint64_t> unsubmitted;
+  size_t num_in_flight = 0;
+  bool stopping = false;
+
+  auto complete = [&](uint64_t slot, int32_t res) {
+    auto &r = in_flight[slot];
+    bool ok = res >= 0;
+    if (ok && !r->is_write_ && res < BUSTUB_PAGE_SIZE) {
+      // Reading at or past the end of the file returns fewer bytes; the rest of the page is zeros.
+      memset(r->data_ + res, 0, BUSTUB_PAGE_SIZE - res);
+    } else if (ok && r->is_write_ && res < BUSTUB_PAGE_SIZE) {
+      LOG_DEBUG("Short write of page %d", r->page_id_);
+      ok = false;
+    } else if (!ok) {
+      LOG_DEBUG("I/O error on page %d: %s", r->page_id_, strerror(-res));
+    }
+    if (ok && !r->is_write_) {
+      ok = disk_manager_->VerifyPage(r->page_id_, r->data_);
+    }
+    r->callback_.set_value(ok);
+    r.reset();
+    free_slots.push_back(slot);
+    num_in_flight--;
+  };
+
+  while (!stopping || num_in_flight > 0) {
+    // Fill the ring. Block for the next request only if there is nothing else to wait for.
+    while (!stopping && !free_slots.empty()) {
+      std::optional<DiskRequest> r;
+      if (num_in_flight == 0) {
+        r = request_queue_.Get();
+      } else if (auto next = request_queue_.TryGet(); next.has_value()) {
+        r = std::move(*next);
+      } else {
+        break;
+      }
+      if (!r.has_value()) {
+        stopping = true;
+        break;
+      }
+      int fd = disk_manager_->GetFileDescriptor(r->page_id_);
+      if (fd < 0 || (disk_manager_->IsDirectIO() && reinterpret_cast<uintptr_t>(r->data_) % BUSTUB_PAGE_SIZE != 0)) {
+        // O_DIRECT would reject the buffer; the disk manager copies it through an aligned one. It also deals with
+        // pages of segments that do not exist.
+        ExecuteDirectly(&*r);
+        continue;
+      }
+      uint64_t slot = free_slots.back();
+      free_slots.pop_back();
+      const char *data = r->data_;
+      if (r->is_write_) {
+        data = disk_manager_->PrepareWrite(r->page_id_, r->data_, write_buffers.get() + slot * BUSTUB_PAGE_SIZE);
+      }
+      io_uring_->Prepare(*r, data, fd, slot, disk_manager_->GetSyncPolicy() == DiskSyncPolicy::EveryWrite);
+      in_flight[slot] = std::move(r);
+      unsubmitted.push_back(slot);
+      num_in_flight++;
+    }
+    if (num_in_flight == 0) {
+      continue;
+    }
+
+    // Submit the new requests and wait for at least one completion.
+    int submitted = io_uring_->Submit(static_cast<unsigned>(unsubmitted.size()), 1);
+    if (submitted < 0) {
+      LOG_WARN("io_uring_enter failed: %s, using the disk manager directly", strerror(errno));
+      break;
+    }
+    unsubmitted.erase(unsubmitted.begin(), unsubmitted.begin() + submitted);
+    uint64_t slot;
+    int32_t res;
+    while (io_uring_->PopCompletion(&slot, &res)) {
+      complete(slot, res);
+    }
+  }
+  if (num_in_flight == 0) {
+    return;
+  }
+
+  // The ring failed. The requests the kernel never consumed are executed directly, and those it did are waited for;
+  // if even waiting fails, the kernel may still be using their pages, so they are failed rather than retried.
+  for (auto slot : unsubmitted) {
+    ExecuteDirectly(&*in_flight[slot]);
+    in_flight[slot].reset();
+    num_in_flight--;
+  }
+  while (num_in_flight > 0 && io_uring_->Submit(0, 1) >= 0) {
+    uint64_t slot;
+    int32_t res;
+    while (io_uring_->PopCompletion(&slot, &res)) {
+      complete(slot, res);
+    }
+  }
+  for (auto &r : in_flight) {
+    if (r.has_value()) {
+      LOG_WARN("lost the completion of page %d", r->page_id_);
+      r->callback_.set_value(false);
+      r.reset();
+    }
+  }
+  // Serve the remaining requests like a worker of the pool.
+  if (!stopping) {
+    StartWorkerThread();
+  }
+#endif
+}
+
+}  // namespace bustub
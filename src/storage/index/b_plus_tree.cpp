@@ -1,28 +1,57 @@
+#include <numeric>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/rid.h"
+#include "fmt/format.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/disk/disk_manager.h"
 #include "storage/page/header_page.h"
 
 namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size,
+                          InternalPageLayout internal_layout)
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
       comparator_(std::move(comparator)),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size),
-      header_page_id_(header_page_id) {}
+      // The summary of an EYTZINGER page takes some room, so it may hold fewer entries than the default.
+      internal_max_size_(std::min(internal_max_size, InternalPage::Capacity(internal_layout))),
+      internal_layout_(internal_layout),
+      header_page_id_(header_page_id),
+      segment_id_(DiskManager::GetSegmentId(header_page_id)) {
+  if (!InternalPage::SupportsLayout(internal_layout)) {
+    throw Exception(ExceptionType::INVALID,
+                    fmt::format("EYTZINGER internal pages need keys of at most {} bytes", EYTZINGER_MAX_KEY_SIZE));
+  }
+  WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
+  auto root_page = guard.AsMut<BPlusTreeRootPage>();
+  root_page->root_page_id_ = INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  // Nobody reads the tree any more.
+  for (const auto &[page_id, epoch] : garbage_) {
+    bpm_->DeletePage(page_id);
+  }
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  return guard.As<BPlusTreeRootPage>()->root_page_id_ == INVALID_PAGE_ID;
+}
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -33,10 +62,194 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn) -> bool {
-  // Declaration of context instance.
-  Context ctx;
-  (void)ctx;
-  return false;
+  if (auto found = GetValueOptimistic(key, result); found.has_value()) {
+    return *found;
+  }
+
+  // Writers kept getting in the way, so queue up for the latches instead.
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  auto page_id = guard.As<BPlusTreeRootPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  guard = bpm_->FetchPageRead(page_id);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    guard = bpm_->FetchPageRead(guard.As<InternalPage>()->Lookup(key, comparator_));
+  }
+  ValueType value;
+  if (!guard.As<LeafPage>()->Lookup(key, &value, comparator_)) {
+    return false;
+  }
+  result->push_back(value);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::DescendOptimistic(const KeyType &key, OptimisticPageGuard *parent, OptimisticPageGuard *leaf,
+                                       page_id_t *leaf_page_id) -> bool {
+  auto node = bpm_->FetchPageOptimistic(header_page_id_);
+  if (!node.Validate()) {
+    return false;
+  }
+  auto page_id = node.As<BPlusTreeRootPage>()->root_page_id_;
+  if (!node.Validate()) {
+    return false;
+  }
+  while (page_id != INVALID_PAGE_ID) {
+    // The page id was read from a page that is still unchanged, so the child is still where it was. The child only
+    // counts once the parent is still unchanged after the child's version was taken.
+    auto child = bpm_->FetchPageOptimistic(page_id);
+    if (!child.Validate()) {
+      return false;
+    }
+    bool is_leaf = child.As<BPlusTreePage>()->IsLeafPage();
+    if (!node.Validate() || !child.Validate()) {
+      return false;
+    }
+    if (is_leaf) {
+      *leaf = std::move(child);
+      break;
+    }
+    auto child_page_id = child.As<InternalPage>()->Lookup(key, comparator_);
+    if (!child.Validate()) {
+      return false;
+    }
+    node = std::move(child);
+    page_id = child_page_id;
+  }
+  *parent = std::move(node);
+  *leaf_page_id = page_id;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValueOptimistic(const KeyType &key, std::vector<ValueType> *result) -> std::optional<bool> {
+  EpochGuard reader(this);
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+    OptimisticPageGuard parent;
+    OptimisticPageGuard leaf;
+    page_id_t leaf_page_id;
+    if (!DescendOptimistic(key, &parent, &leaf, &leaf_page_id)) {
+      continue;
+    }
+    if (leaf_page_id == INVALID_PAGE_ID) {
+      return false;
+    }
+    ValueType value;
+    bool found = leaf.As<LeafPage>()->Lookup(key, &value, comparator_);
+    if (!leaf.Validate()) {
+      continue;
+    }
+    if (found) {
+      result->push_back(value);
+    }
+    return found;
+  }
+  return std::nullopt;
+}
+
+/*
+ * Look up a batch of keys. The keys are visited in key order, so that
+ * neighbouring keys share the way down: a key starts from the lowest page of
+ * the previous key's path whose range it falls in, and keys in the same leaf
+ * only cost a search of that leaf.
+ * @return : the number of keys found
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *txn) -> size_t {
+  results->assign(keys.size(), {});
+  auto order = SortedOrder(keys, [](const KeyType &key) -> const KeyType & { return key; });
+  size_t found = 0;
+  EpochGuard reader(this);
+  BatchPath path;
+  for (auto i : order) {
+    std::optional<bool> hit;
+    for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS && !hit.has_value(); attempt++) {
+      if (!DescendBatch(keys[i], &path)) {
+        path = BatchPath();
+        continue;
+      }
+      if (path.pages_.size() == 1) {
+        hit = false;
+        break;
+      }
+      OptimisticPageGuard &leaf = path.pages_.back();
+      ValueType value;
+      bool in_leaf = leaf.As<LeafPage>()->Lookup(keys[i], &value, comparator_);
+      if (!leaf.Validate()) {
+        path = BatchPath();
+        continue;
+      }
+      if (in_leaf) {
+        (*results)[i].push_back(value);
+      }
+      hit = in_leaf;
+    }
+    if (!hit.has_value()) {
+      hit = GetValue(keys[i], &(*results)[i], txn);
+    }
+    found += *hit ? 1 : 0;
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::DescendBatch(const KeyType &key, BatchPath *path) -> bool {
+  while (!path->pages_.empty() && path->high_keys_.back().has_value() &&
+         comparator_(key, *path->high_keys_.back()) >= 0) {
+    path->pages_.pop_back();
+    path->high_keys_.pop_back();
+  }
+  if (path->pages_.empty()) {
+    path->pages_.push_back(bpm_->FetchPageOptimistic(header_page_id_));
+    path->high_keys_.emplace_back(std::nullopt);
+  }
+  // The page keeps the range of keys it had as long as it does not change, since keys only move in or out of a page
+  // by changing it.
+  if (!path->pages_.back().Validate()) {
+    return false;
+  }
+  while (true) {
+    OptimisticPageGuard &node = path->pages_.back();
+    std::optional<KeyType> high_key = path->high_keys_.back();
+    page_id_t child_page_id;
+    if (path->pages_.size() == 1) {
+      child_page_id = node.As<BPlusTreeRootPage>()->root_page_id_;
+      if (child_page_id == INVALID_PAGE_ID) {
+        return node.Validate();
+      }
+    } else {
+      bool is_leaf = node.As<BPlusTreePage>()->IsLeafPage();
+      if (!node.Validate()) {
+        return false;
+      }
+      if (is_leaf) {
+        return true;
+      }
+      child_page_id = node.As<InternalPage>()->Lookup(key, comparator_, &high_key);
+    }
+    if (!node.Validate()) {
+      return false;
+    }
+    auto child = bpm_->FetchPageOptimistic(child_page_id);
+    if (!child.Validate() || !node.Validate()) {
+      return false;
+    }
+    path->pages_.push_back(std::move(child));
+    path->high_keys_.push_back(high_key);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename T, typename KeyFn>
+auto BPLUSTREE_TYPE::SortedOrder(const std::vector<T> &items, KeyFn key_of) -> std::vector<size_t> {
+  std::vector<size_t> order(items.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return comparator_(key_of(items[a]), key_of(items[b])) < 0;
+  });
+  return order;
 }
 
 /*****************************************************************************
@@ -51,10 +264,324 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
-  // Declaration of context instance.
+  if (auto inserted = InsertOptimistic(key, value); inserted.has_value()) {
+    return *inserted;
+  }
+
   Context ctx;
-  (void)ctx;
-  return false;
+  auto is_safe = [&key](const BPlusTreePage *page, bool /* is_root */) {
+    return page->IsLeafPage() ? reinterpret_cast<const LeafPage *>(page)->CanInsert(key)
+                              : page->GetSize() < page->GetMaxSize();
+  };
+  if (!DescendPessimistic(key, &ctx, is_safe)) {
+    // Start a new tree.
+    page_id_t root_page_id;
+    BasicPageGuard root_guard = NewTreePage(&root_page_id);
+    auto root = root_guard.AsMut<LeafPage>();
+    root->Init(root_page_id, INVALID_PAGE_ID, leaf_max_size_);
+    root->Insert(key, value, comparator_);
+    ctx.header_page_->AsMut<BPlusTreeRootPage>()->root_page_id_ = root_page_id;
+    return true;
+  }
+
+  auto &leaf_guard = ctx.write_set_.back();
+  auto leaf = leaf_guard.AsMut<LeafPage>();
+  if (leaf->CanInsert(key)) {
+    return leaf->Insert(key, value, comparator_);
+  }
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    return false;
+  }
+
+  page_id_t new_page_id;
+  BasicPageGuard new_guard = NewTreePage(&new_page_id);
+  auto new_leaf = new_guard.AsMut<LeafPage>();
+  new_leaf->Init(new_page_id, leaf->GetParentPageId(), leaf_max_size_);
+  leaf->InsertAndSplit(key, value, comparator_, new_leaf);
+  if (new_leaf->GetNextPageId() != INVALID_PAGE_ID) {
+    // Latching the page after the leaf keeps to the left to right order.
+    WritePageGuard next_guard = bpm_->FetchPageWrite(new_leaf->GetNextPageId());
+    next_guard.AsMut<LeafPage>()->SetPrevPageId(new_page_id);
+  }
+  InsertIntoParent(&ctx, leaf_guard.PageId(), new_leaf->KeyAt(0), new_page_id);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertOptimistic(const KeyType &key, const ValueType &value) -> std::optional<bool> {
+  EpochGuard reader(this);
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+    OptimisticPageGuard parent;
+    OptimisticPageGuard leaf;
+    page_id_t leaf_page_id;
+    if (!DescendOptimistic(key, &parent, &leaf, &leaf_page_id)) {
+      continue;
+    }
+    if (leaf_page_id == INVALID_PAGE_ID) {
+      return std::nullopt;
+    }
+    leaf.Drop();
+    // The leaf is the right one as long as its parent did not change until the leaf was latched; after that, nobody can
+    // split or merge the leaf without its latch.
+    auto guard = bpm_->FetchPageWrite(leaf_page_id);
+    if (!parent.Validate()) {
+      continue;
+    }
+    if (!guard.As<LeafPage>()->CanInsert(key)) {
+      return std::nullopt;
+    }
+    return guard.AsMut<LeafPage>()->Insert(key, value, comparator_);
+  }
+  return std::nullopt;
+}
+
+/*
+ * Insert a batch of key & value pairs in key order. The leaf of the next
+ * pair is found like GetValues() does and write latched once for all the
+ * following pairs that go to it, as long as it does not have to split. A
+ * pair that splits its leaf goes through Insert().
+ * @return: the number of pairs inserted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertBatch(const std::vector<MappingType> &items, Transaction *txn) -> size_t {
+  auto order = SortedOrder(items, [](const MappingType &item) -> const KeyType & { return item.first; });
+  size_t inserted = 0;
+  EpochGuard reader(this);
+  BatchPath path;
+  size_t next = 0;
+  while (next < order.size()) {
+    size_t done = 0;
+    for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+      const auto &key = items[order[next]].first;
+      if (!DescendBatch(key, &path)) {
+        path = BatchPath();
+        continue;
+      }
+      if (path.pages_.size() == 1) {
+        break;
+      }
+      // Latch the leaf; it is the right one as long as its parent did not change until then, and keeps its range of
+      // keys while latched. Its version changes when the latch is released, so it leaves the path.
+      auto leaf_page_id = path.pages_.back().PageId();
+      auto high_key = path.high_keys_.back();
+      path.pages_.pop_back();
+      path.high_keys_.pop_back();
+      WritePageGuard guard = bpm_->FetchPageWrite(leaf_page_id);
+      if (!path.pages_.back().Validate()) {
+        path = BatchPath();
+        continue;
+      }
+      auto leaf = guard.AsMut<LeafPage>();
+      while (next + done < order.size()) {
+        const auto &item = items[order[next + done]];
+        if ((high_key.has_value() && comparator_(item.first, *high_key) >= 0) || !leaf->CanInsert(item.first)) {
+          break;
+        }
+        inserted += leaf->Insert(item.first, item.second, comparator_) ? 1 : 0;
+        done++;
+      }
+      break;
+    }
+    if (done == 0) {
+      // The tree is empty, the leaf is full, or writers kept getting in the way.
+      path = BatchPath();
+      const auto &item = items[order[next]];
+      inserted += Insert(item.first, item.second, txn) ? 1 : 0;
+      done = 1;
+    }
+    next += done;
+  }
+  return inserted;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename SafeFn>
+auto BPLUSTREE_TYPE::DescendPessimistic(const KeyType &key, Context *ctx, SafeFn is_safe) -> bool {
+  ctx->header_page_ = bpm_->FetchPageWrite(header_page_id_);
+  ctx->root_page_id_ = ctx->header_page_->As<BPlusTreeRootPage>()->root_page_id_;
+  if (ctx->root_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto page_id = ctx->root_page_id_;
+  while (true) {
+    ctx->write_set_.push_back(bpm_->FetchPageWrite(page_id));
+    auto page = ctx->write_set_.back().template As<BPlusTreePage>();
+    if (is_safe(page, ctx->IsRootPage(page_id))) {
+      ctx->header_page_ = std::nullopt;
+      while (ctx->write_set_.size() > 1) {
+        ctx->write_set_.pop_front();
+      }
+    }
+    if (page->IsLeafPage()) {
+      return true;
+    }
+    page_id = reinterpret_cast<const InternalPage *>(page)->Lookup(key, comparator_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParent(Context *ctx, page_id_t old_page_id, const KeyType &key,
+                                      page_id_t new_page_id) {
+  ctx->write_set_.pop_back();
+  if (ctx->write_set_.empty()) {
+    // The root split, so the tree grows a level. The header page is still latched since the root was not safe.
+    page_id_t root_page_id;
+    BasicPageGuard root_guard = NewTreePage(&root_page_id);
+    auto root = root_guard.AsMut<InternalPage>();
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_, internal_layout_);
+    root->PopulateNewRoot(old_page_id, key, new_page_id);
+    ctx->header_page_->AsMut<BPlusTreeRootPage>()->root_page_id_ = root_page_id;
+    ctx->root_page_id_ = root_page_id;
+    return;
+  }
+
+  auto &parent_guard = ctx->write_set_.back();
+  auto parent = parent_guard.AsMut<InternalPage>();
+  if (parent->GetSize() < parent->GetMaxSize()) {
+    parent->InsertNodeAfter(old_page_id, key, new_page_id);
+    return;
+  }
+
+  // The parent is full. Lay out its entries with the new one in place, then split them over the parent and a new page;
+  // the first key of the new page moves up.
+  std::vector<std::pair<KeyType, page_id_t>> items;
+  items.reserve(parent->GetSize() + 1);
+  for (int i = 0; i < parent->GetSize(); i++) {
+    items.push_back(parent->GetItem(i));
+    if (parent->ValueAt(i) == old_page_id) {
+      items.emplace_back(key, new_page_id);
+    }
+  }
+  page_id_t sibling_page_id;
+  BasicPageGuard sibling_guard = NewTreePage(&sibling_page_id);
+  auto sibling = sibling_guard.AsMut<InternalPage>();
+  sibling->Init(sibling_page_id, parent->GetParentPageId(), internal_max_size_, internal_layout_);
+  int keep = static_cast<int>(items.size()) / 2;
+  parent->CopyFrom(items.data(), keep);
+  sibling->CopyFrom(items.data() + keep, static_cast<int>(items.size()) - keep);
+  InsertIntoParent(ctx, parent_guard.PageId(), items[keep].first, sibling_page_id);
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build the tree a level at a time from the bottom: fill leaves with the
+ * entries as they come in, then build each internal level from the first
+ * keys of the pages of the level below, until a level has a single page.
+ * Only the header page is latched, so nobody can use the tree meanwhile.
+ * Entries with the key of the entry before them are skipped, the same as
+ * Insert() rejects duplicates.
+ * @return: false if the tree is not empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor) -> bool {
+  WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_);
+  if (header_guard.As<BPlusTreeRootPage>()->root_page_id_ != INVALID_PAGE_ID) {
+    return false;
+  }
+
+  // The first key and the page id of every page of the level being built.
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  BasicPageGuard last_leaf;
+  std::vector<MappingType> pending;
+  auto write_leaf = [&](int size) {
+    page_id_t page_id;
+    BasicPageGuard guard = NewTreePage(&page_id);
+    auto leaf = guard.AsMut<LeafPage>();
+    leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+    leaf->CopyFrom(pending.data(), size);
+    if (!level.empty()) {
+      last_leaf.AsMut<LeafPage>()->SetNextPageId(page_id);
+      leaf->SetPrevPageId(level.back().second);
+    }
+    level.emplace_back(pending[0].first, page_id);
+    last_leaf = std::move(guard);
+    pending.erase(pending.begin(), pending.begin() + size);
+  };
+  auto fits = [&](size_t begin, size_t size) {
+    return static_cast<int>(size) <= LeafPage::Capacity(pending.data() + begin, static_cast<int>(size), leaf_max_size_);
+  };
+
+  // How many entries fit in a leaf depends on the bytes their keys have in common. A leaf is written once enough
+  // entries for two full ones have come in, so that the last leaf never ends up with too few.
+  auto leaf_fill_size = [&]() {
+    return LeafPage::FillSize(pending.data(), static_cast<int>(pending.size()), leaf_max_size_, fill_factor);
+  };
+  MappingType item;
+  bool first = true;
+  KeyType last_key;
+  while (next(&item)) {
+    if (!first) {
+      int cmp = comparator_(last_key, item.first);
+      BUSTUB_ASSERT(cmp <= 0, "bulk load entries have to come in key order");
+      if (cmp == 0) {
+        continue;
+      }
+    }
+    first = false;
+    last_key = item.first;
+    pending.push_back(item);
+    if (static_cast<int>(pending.size()) >= 2 * (leaf_max_size_ - 1)) {
+      write_leaf(leaf_fill_size());
+    }
+  }
+  while (!pending.empty()) {
+    if (fits(0, pending.size())) {
+      write_leaf(static_cast<int>(pending.size()));
+      break;
+    }
+    // Share the entries between the last two leaves if the last one would be short of entries otherwise.
+    int size = leaf_fill_size();
+    size_t rest = pending.size() - size;
+    int rest_capacity = LeafPage::Capacity(pending.data() + size, static_cast<int>(rest), leaf_max_size_);
+    size_t half = pending.size() / 2;
+    if (static_cast<int>(rest) <= rest_capacity && static_cast<int>(rest) < (rest_capacity + 1) / 2 &&
+        fits(0, half) && fits(half, pending.size() - half)) {
+      size = static_cast<int>(half);
+    }
+    write_leaf(size);
+  }
+  last_leaf.Drop();
+  if (level.empty()) {
+    return true;
+  }
+
+  // Internal pages split once they go past internal_max_size_ entries.
+  auto target_size = [fill_factor](int min_size, int max_size) {
+    return std::clamp(static_cast<int>(fill_factor * max_size), std::max(min_size, 1), max_size);
+  };
+  int internal_min = (internal_max_size_ + 1) / 2;
+  int internal_target = target_size(internal_min, internal_max_size_);
+  while (level.size() > 1) {
+    std::vector<std::pair<KeyType, page_id_t>> parents;
+    for (size_t begin = 0; begin < level.size();) {
+      int size = BulkLoadPageSize(level.size() - begin, internal_target, internal_min, internal_max_size_);
+      page_id_t page_id;
+      BasicPageGuard guard = NewTreePage(&page_id);
+      auto page = guard.AsMut<InternalPage>();
+      page->Init(page_id, INVALID_PAGE_ID, internal_max_size_, internal_layout_);
+      page->CopyFrom(level.data() + begin, size);
+      parents.emplace_back(level[begin].first, page_id);
+      begin += size;
+    }
+    level = std::move(parents);
+  }
+  header_guard.AsMut<BPlusTreeRootPage>()->root_page_id_ = level[0].second;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadPageSize(size_t remaining, int target, int min_size, int max_size) -> int {
+  if (remaining >= static_cast<size_t>(target + min_size)) {
+    return target;
+  }
+  if (remaining <= static_cast<size_t>(max_size)) {
+    return static_cast<int>(remaining);
+  }
+  // More than max_size entries are left, so both of the last two pages get at least (max_size + 1) / 2 of them.
+  return static_cast<int>(remaining / 2);
 }
 
 /*****************************************************************************
@@ -69,9 +596,215 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
-  // Declaration of context instance.
-  Context ctx;
-  (void)ctx;
+  if (RemoveOptimistic(key)) {
+    return;
+  }
+
+  {
+    Context ctx;
+    auto is_safe = [](const BPlusTreePage *page, bool is_root) {
+      if (is_root) {
+        return page->IsLeafPage() ? page->GetSize() > 1 : page->GetSize() > 2;
+      }
+      return page->GetSize() > MinSize(page);
+    };
+    if (!DescendPessimistic(key, &ctx, is_safe)) {
+      return;
+    }
+    if (!ctx.write_set_.back().AsMut<LeafPage>()->Remove(key, comparator_)) {
+      return;
+    }
+    HandleUnderflow(&ctx);
+  }
+  CollectGarbage();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveOptimistic(const KeyType &key) -> bool {
+  EpochGuard reader(this);
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+    OptimisticPageGuard parent;
+    OptimisticPageGuard leaf;
+    page_id_t leaf_page_id;
+    if (!DescendOptimistic(key, &parent, &leaf, &leaf_page_id)) {
+      continue;
+    }
+    if (leaf_page_id == INVALID_PAGE_ID) {
+      return true;
+    }
+    leaf.Drop();
+    auto guard = bpm_->FetchPageWrite(leaf_page_id);
+    if (!parent.Validate()) {
+      continue;
+    }
+    auto page = guard.As<LeafPage>();
+    ValueType value;
+    if (!page->Lookup(key, &value, comparator_)) {
+      return true;
+    }
+    // A root leaf may go down to one entry, but not to none since the tree becomes empty then.
+    bool is_root = parent.PageId() == header_page_id_;
+    if (is_root ? page->GetSize() <= 1 : page->GetSize() <= page->GetMinSize()) {
+      return false;
+    }
+    guard.AsMut<LeafPage>()->Remove(key, comparator_);
+    return true;
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::HandleUnderflow(Context *ctx) {
+  auto page_id = ctx->write_set_.back().PageId();
+  auto page = ctx->write_set_.back().template AsMut<BPlusTreePage>();
+  if (ctx->IsRootPage(page_id)) {
+    // The header page is still latched unless the root keeps enough entries.
+    if (page->IsLeafPage() && page->GetSize() == 0) {
+      ctx->header_page_->AsMut<BPlusTreeRootPage>()->root_page_id_ = INVALID_PAGE_ID;
+      FreePage(page_id);
+    } else if (!page->IsLeafPage() && page->GetSize() == 1) {
+      ctx->header_page_->AsMut<BPlusTreeRootPage>()->root_page_id_ =
+          reinterpret_cast<InternalPage *>(page)->ValueAt(0);
+      FreePage(page_id);
+    }
+    return;
+  }
+  if (page->GetSize() >= MinSize(page)) {
+    return;
+  }
+
+  auto parent = ctx->write_set_[ctx->write_set_.size() - 2].template AsMut<InternalPage>();
+  int index = parent->ValueIndex(page_id);
+  WritePageGuard left_guard;
+  WritePageGuard right_guard;
+  if (index > 0) {
+    // Latch the left sibling before the page, since iterators latch leaves from left to right. Nobody can change the
+    // page in between: writers that did not latch the parent need to see it unchanged.
+    ctx->write_set_.pop_back();
+    left_guard = bpm_->FetchPageWrite(parent->ValueAt(index - 1));
+    right_guard = bpm_->FetchPageWrite(page_id);
+  } else {
+    left_guard = std::move(ctx->write_set_.back());
+    ctx->write_set_.pop_back();
+    right_guard = bpm_->FetchPageWrite(parent->ValueAt(index + 1));
+    index++;
+  }
+  // From here on, index is the entry of the right page in the parent.
+  bool page_is_left = left_guard.PageId() == page_id;
+
+  if (left_guard.As<BPlusTreePage>()->IsLeafPage()) {
+    auto left = left_guard.AsMut<LeafPage>();
+    auto right = right_guard.AsMut<LeafPage>();
+    if (left->CanMergeWith(right)) {
+      right->MoveAllTo(left);
+      if (left->GetNextPageId() != INVALID_PAGE_ID) {
+        WritePageGuard next_guard = bpm_->FetchPageWrite(left->GetNextPageId());
+        next_guard.AsMut<LeafPage>()->SetPrevPageId(left_guard.PageId());
+      }
+      parent->Remove(index);
+      FreePage(right_guard.PageId());
+    } else {
+      left->RedistributeWith(right);
+      parent->SetKeyAt(index, right->KeyAt(0));
+      return;
+    }
+  } else {
+    auto left = left_guard.AsMut<InternalPage>();
+    auto right = right_guard.AsMut<InternalPage>();
+    if (left->GetSize() + right->GetSize() <= left->GetMaxSize()) {
+      right->MoveAllTo(left, parent->KeyAt(index));
+      parent->Remove(index);
+      FreePage(right_guard.PageId());
+    } else {
+      if (page_is_left) {
+        right->MoveFirstToEndOf(left, parent->KeyAt(index));
+      } else {
+        left->MoveLastToFrontOf(right, parent->KeyAt(index));
+      }
+      parent->SetKeyAt(index, right->KeyAt(0));
+      return;
+    }
+  }
+  left_guard.Drop();
+  right_guard.Drop();
+  HandleUnderflow(ctx);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MinSize(const BPlusTreePage *page) -> int {
+  return page->IsLeafPage() ? reinterpret_cast<const LeafPage *>(page)->GetMinSize() : page->GetMinSize();
+}
+
+/*****************************************************************************
+ * PAGE MANAGEMENT
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewTreePage(page_id_t *page_id) -> BasicPageGuard {
+  auto *page = bpm_->NewPage(page_id, segment_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame for a new B+ tree page");
+  }
+  return {bpm_, page};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreePage(page_id_t page_id) {
+  std::scoped_lock lock(garbage_latch_);
+  garbage_.emplace_back(page_id, epoch_.load());
+  has_garbage_.store(true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CollectGarbage() {
+  std::scoped_lock lock(garbage_latch_);
+  if (garbage_.empty()) {
+    return;
+  }
+  // Every page in garbage_ had left the tree before it got there, so readers that start in the next epoch cannot reach
+  // any of them. Of the others, only the ones that are still active count.
+  auto min_epoch = epoch_.fetch_add(1) + 1;
+  for (const auto &slot : epoch_slots_) {
+    auto epoch = slot.epoch_.load();
+    if (epoch != 0) {
+      min_epoch = std::min(min_epoch, epoch);
+    }
+  }
+  std::vector<std::pair<page_id_t, uint64_t>> kept;
+  for (const auto &[page_id, epoch] : garbage_) {
+    // Deleting fails while the page is pinned by somebody outside of the tree, e.g. the background flusher.
+    if (epoch >= min_epoch || !bpm_->DeletePage(page_id)) {
+      kept.emplace_back(page_id, epoch);
+    }
+  }
+  garbage_.swap(kept);
+  has_garbage_.store(!garbage_.empty());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::EpochGuard::EpochGuard(BPlusTree *tree) : tree_(tree) {
+  // Every thread starts looking for a free slot at one of its own, so a slot is normally only written by one thread.
+  static std::atomic<size_t> next_thread{0};
+  thread_local size_t home = next_thread.fetch_add(1);
+  auto epoch = tree_->epoch_.load();
+  for (size_t i = home;; i++) {
+    auto &slot = tree_->epoch_slots_[i % EPOCH_SLOTS].epoch_;
+    uint64_t free = 0;
+    if (slot.load(std::memory_order_relaxed) == 0 && slot.compare_exchange_strong(free, epoch)) {
+      slot_ = &slot;
+      return;
+    }
+    if ((i + 1 - home) % EPOCH_SLOTS == 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::EpochGuard::~EpochGuard() {
+  slot_->store(0);
+  if (tree_->has_garbage_.load(std::memory_order_relaxed)) {
+    tree_->CollectGarbage();
+  }
 }
 
 /*****************************************************************************
@@ -83,7 +816,18 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  auto page_id = guard.As<BPlusTreeRootPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return INDEXITERATOR_TYPE();
+  }
+  guard = bpm_->FetchPageRead(page_id);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    guard = bpm_->FetchPageRead(guard.As<InternalPage>()->ValueAt(0));
+  }
+  return INDEXITERATOR_TYPE(bpm_, std::move(guard), 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -91,7 +835,178 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE()
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  auto page_id = guard.As<BPlusTreeRootPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return INDEXITERATOR_TYPE();
+  }
+  guard = bpm_->FetchPageRead(page_id);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    guard = bpm_->FetchPageRead(guard.As<InternalPage>()->Lookup(key, comparator_));
+  }
+  int index = guard.As<LeafPage>()->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(bpm_, std::move(guard), index);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ScanRange(const std::optional<KeyType> &lo, const std::optional<KeyType> &hi,
+                               const std::function<bool(const MappingType *, size_t)> &visit, bool reverse) -> size_t {
+  if (lo.has_value() && hi.has_value() && comparator_(*lo, *hi) > 0) {
+    return 0;
+  }
+  // The index of the first entry of a leaf that comes after hi.
+  auto upper_bound = [&](const LeafPage *leaf) {
+    int index = leaf->KeyIndex(*hi, comparator_);
+    return index < leaf->GetSize() && comparator_(leaf->KeyAt(index), *hi) == 0 ? index + 1 : index;
+  };
+  std::vector<MappingType> batch;
+  size_t visited = 0;
+  ReadPageGuard guard;
+
+  if (!reverse) {
+    auto first_child = [&](const InternalPage *page) {
+      return lo.has_value() ? page->LookupIndex(*lo, comparator_) : 0;
+    };
+    if (!DescendScan(first_child, lo, hi, false, &guard, nullptr)) {
+      return 0;
+    }
+    int begin = lo.has_value() ? guard.As<LeafPage>()->KeyIndex(*lo, comparator_) : 0;
+    while (true) {
+      const auto *leaf = guard.As<LeafPage>();
+      int size = leaf->GetSize();
+      int end = hi.has_value() ? upper_bound(leaf) : size;
+      page_id_t next_page_id = end == size ? leaf->GetNextPageId() : INVALID_PAGE_ID;
+      // Keep the next leaf coming in while this one is copied out and visited.
+      bpm_->PrefetchPage(next_page_id, AccessType::Scan);
+      batch.resize(std::max(end - begin, 0));
+      leaf->CopyItems(begin, begin + static_cast<int>(batch.size()), batch.data());
+      visited += batch.size();
+      if ((!batch.empty() && !visit(batch.data(), batch.size())) || next_page_id == INVALID_PAGE_ID) {
+        return visited;
+      }
+      // Latch the next leaf before letting go of this one, like the iterator does.
+      guard = bpm_->FetchPageRead(next_page_id);
+      begin = 0;
+    }
+  }
+
+  auto last_child = [&](const InternalPage *page) {
+    return hi.has_value() ? page->LookupIndex(*hi, comparator_) : page->GetSize() - 1;
+  };
+  if (!DescendScan(last_child, lo, hi, true, &guard, nullptr)) {
+    return 0;
+  }
+  // The scan is done with the keys from this one on, the first key of the last leaf it stepped back from that had any.
+  std::optional<KeyType> below;
+  while (true) {
+    const auto *leaf = guard.As<LeafPage>();
+    int end = leaf->GetSize();
+    if (below.has_value()) {
+      end = leaf->KeyIndex(*below, comparator_);
+    } else if (hi.has_value()) {
+      end = upper_bound(leaf);
+    }
+    int begin = lo.has_value() ? std::min(leaf->KeyIndex(*lo, comparator_), end) : 0;
+    bool last = lo.has_value() && leaf->GetSize() > 0 && comparator_(leaf->KeyAt(0), *lo) <= 0;
+    if (!last) {
+      bpm_->PrefetchPage(leaf->GetPrevPageId(), AccessType::Scan);
+    }
+    batch.resize(end - begin);
+    leaf->CopyItems(begin, end, batch.data());
+    std::reverse(batch.begin(), batch.end());
+    visited += batch.size();
+    if ((!batch.empty() && !visit(batch.data(), batch.size())) || last) {
+      return visited;
+    }
+    // A leaf is only empty while the writer that removed its last key waits to merge it into its left sibling, and
+    // the keys before it are still less than the first key of the leaf after it.
+    if (leaf->GetSize() > 0) {
+      below = leaf->KeyAt(0);
+    }
+    if (!PrevLeaf(&guard, below)) {
+      return visited;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::PrevLeaf(ReadPageGuard *leaf, const std::optional<KeyType> &key) -> bool {
+  page_id_t prev_page_id = leaf->As<LeafPage>()->GetPrevPageId();
+  if (prev_page_id == INVALID_PAGE_ID) {
+    leaf->Drop();
+    return false;
+  }
+  // Holding the latch of the leaf, nobody can change the link between the two leaves.
+  ReadPageGuard prev;
+  if (bpm_->TryFetchPageRead(prev_page_id, &prev)) {
+    *leaf = std::move(prev);
+    return true;
+  }
+
+  // Come down with a strict lookup for key, or to the last leaf without one. That ends at a leaf whose keys are all at
+  // least key if a separator key less than key is no longer a key, or at an empty leaf, so go on with the key that all
+  // keys of that leaf are at least, which is less.
+  leaf->Drop();
+  std::optional<KeyType> target = key;
+  std::optional<KeyType> low_key;
+  auto child_before = [&](const InternalPage *page) {
+    return target.has_value() ? page->LookupIndex(*target, comparator_, false) : page->GetSize() - 1;
+  };
+  while (DescendScan(child_before, std::nullopt, std::nullopt, true, leaf, &low_key)) {
+    const auto *page = leaf->As<LeafPage>();
+    if (page->GetSize() > 0 && (!key.has_value() || comparator_(page->KeyAt(0), *key) < 0)) {
+      return true;
+    }
+    leaf->Drop();
+    if (!low_key.has_value()) {
+      return false;
+    }
+    target = *low_key;
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename ChildFn>
+auto BPLUSTREE_TYPE::DescendScan(ChildFn child_index, const std::optional<KeyType> &lo,
+                                 const std::optional<KeyType> &hi, bool reverse, ReadPageGuard *leaf,
+                                 std::optional<KeyType> *low_key) -> bool {
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  auto page_id = guard.As<BPlusTreeRootPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  if (low_key != nullptr) {
+    low_key->reset();
+  }
+  guard = bpm_->FetchPageRead(page_id);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    const auto *page = guard.As<InternalPage>();
+    int index = child_index(page);
+    if (index > 0 && low_key != nullptr) {
+      *low_key = page->KeyAt(index);
+    }
+    ReadPageGuard child = bpm_->FetchPageRead(page->ValueAt(index));
+    if (child.As<BPlusTreePage>()->IsLeafPage()) {
+      // Child i holds the keys from key i up to key i + 1.
+      for (int step = 1; step <= INDEX_SCAN_READAHEAD_PAGES; step++) {
+        int sibling = reverse ? index - step : index + step;
+        if (sibling < 0 || sibling >= page->GetSize()) {
+          break;
+        }
+        bool in_range = reverse ? !lo.has_value() || comparator_(page->KeyAt(sibling + 1), *lo) > 0
+                                : !hi.has_value() || comparator_(page->KeyAt(sibling), *hi) <= 0;
+        if (!in_range || !bpm_->PrefetchPage(page->ValueAt(sibling), AccessType::Scan)) {
+          break;
+        }
+      }
+    }
+    guard = std::move(child);
+  }
+  *leaf = std::move(guard);
+  return true;
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -101,11 +1016,40 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return IN
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE {
+  ReadPageGuard guard;
+  auto last_child = [](const InternalPage *page) { return page->GetSize() - 1; };
+  if (!DescendScan(last_child, std::nullopt, std::nullopt, true, &guard, nullptr)) {
+    return INDEXITERATOR_TYPE();
+  }
+  int index = guard.As<LeafPage>()->GetSize() - 1;
+  return INDEXITERATOR_TYPE(this, std::move(guard), index);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  ReadPageGuard guard;
+  auto key_child = [&](const InternalPage *page) { return page->LookupIndex(key, comparator_); };
+  if (!DescendScan(key_child, std::nullopt, std::nullopt, true, &guard, nullptr)) {
+    return INDEXITERATOR_TYPE();
+  }
+  const auto *leaf = guard.As<LeafPage>();
+  int index = leaf->KeyIndex(key, comparator_);
+  if (index == leaf->GetSize() || comparator_(leaf->KeyAt(index), key) != 0) {
+    index--;
+  }
+  return INDEXITERATOR_TYPE(this, std::move(guard), index);
+}
+
 /**
  * @return Page id of the root of this tree
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return 0; }
+auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  return guard.As<BPlusTreeRootPage>()->root_page_id_;
+}
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -298,5 +1242,7 @@ template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTree<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
@@ -11,24 +11,32 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <cstring>
+#include <optional>
+
+#include "storage/index/external_sort.h"
+
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
-    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     InternalPageLayout internal_layout)
+    : Index(std::move(metadata)), bpm_(buffer_pool_manager), comparator_(GetMetadata()->GetKeySchema()) {
   page_id_t header_page_id;
-  buffer_pool_manager->NewPage(&header_page_id);
-  container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(GetMetadata()->GetName(), header_page_id,
-                                                                              buffer_pool_manager, comparator_);
+  // Keep the pages of the index together in a segment of their own.
+  buffer_pool_manager->NewPage(&header_page_id, buffer_pool_manager->CreateSegment());
+  container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(
+      GetMetadata()->GetName(), header_page_id, buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+      internal_layout);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_->Insert(index_key, rid, transaction);
 }
@@ -37,7 +45,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_->Remove(index_key, transaction);
 }
@@ -46,11 +54,127 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_->GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+  std::vector<MappingType> items(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    items[i].first.SetFromKey(entries[i].first, *GetKeySchema());
+    items[i].second = entries[i].second;
+  }
+
+  container_->InsertBatch(items, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                                    Transaction *transaction) {
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i], *GetKeySchema());
+  }
+
+  container_->GetValues(index_keys, result, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanAll(std::vector<RID> *result, Transaction *transaction) {
+  ScanRange(nullptr, nullptr, result, false, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *lo, const Tuple *hi, std::vector<RID> *result, bool reverse,
+                                     Transaction *transaction) {
+  // construct the bounds of the scan
+  auto index_key = [this](const Tuple *key) -> std::optional<KeyType> {
+    if (key == nullptr) {
+      return std::nullopt;
+    }
+    KeyType index_key;
+    index_key.SetFromKey(*key, *GetKeySchema());
+    return index_key;
+  };
+
+  container_->ScanRange(
+      index_key(lo), index_key(hi),
+      [result](const MappingType *items, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+          result->push_back(items[i].second);
+        }
+        return true;
+      },
+      reverse);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ScanRangeBatch(const Tuple *lo, const Tuple *hi, bool reverse, IndexScanCursor *cursor,
+                                          std::vector<RID> *result, Transaction *transaction) -> bool {
+  if (cursor->done_) {
+    return false;
+  }
+  std::optional<KeyType> lo_key;
+  std::optional<KeyType> hi_key;
+  if (lo != nullptr) {
+    lo_key.emplace().SetFromKey(*lo, *GetKeySchema());
+  }
+  if (hi != nullptr) {
+    hi_key.emplace().SetFromKey(*hi, *GetKeySchema());
+  }
+  // Go on from the last key returned, which may have been removed in the meantime. Keys are unique, so only that key
+  // itself is left out.
+  std::optional<KeyType> last_key;
+  if (!cursor->last_key_.empty()) {
+    BUSTUB_ASSERT(cursor->last_key_.size() == sizeof(KeyType), "the cursor comes from another index");
+    std::memcpy(static_cast<void *>(&last_key.emplace()), cursor->last_key_.data(), sizeof(KeyType));
+    (reverse ? hi_key : lo_key) = last_key;
+  }
+
+  size_t size = result->size();
+  container_->ScanRange(
+      lo_key, hi_key,
+      [&](const MappingType *items, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+          if (!last_key.has_value() || comparator_(items[i].first, *last_key) != 0) {
+            result->push_back(items[i].second);
+            last_key = items[i].first;
+          }
+        }
+        return result->size() == size;
+      },
+      reverse);
+  if (result->size() == size) {
+    cursor->done_ = true;
+    return false;
+  }
+  cursor->last_key_.assign(reinterpret_cast<const char *>(&*last_key), sizeof(KeyType));
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *, RID *)> &next, Transaction *transaction) {
+  ExternalSort<KeyType, ValueType, KeyComparator> sort(bpm_, comparator_);
+  Tuple key;
+  RID rid;
+  while (next(&key, &rid)) {
+    KeyType index_key;
+    index_key.SetFromKey(key, *GetKeySchema());
+    sort.Add(index_key, rid);
+  }
+  sort.Finish();
+
+  if (!container_->BulkLoad([&sort](MappingType *item) { return sort.Next(item); })) {
+    // The index already has entries, so merge the new ones in.
+    MappingType item;
+    while (sort.Next(&item)) {
+      container_->Insert(item.first, item.second, transaction);
+    }
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_->Begin(); }
 
@@ -65,5 +189,7 @@ template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTreeIndex<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.cpp
+//
+// Identification: src/storage/index/external_sort.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sort.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::ExternalSort(BufferPoolManager *bpm, const KeyComparator &comparator, int memory_pages)
+    : bpm_(bpm), comparator_(comparator) {
+  BUSTUB_ASSERT(memory_pages > 0, "an external sort needs memory for at least one page");
+  buffer_capacity_ = memory_pages * ENTRIES_PER_PAGE;
+  // A merge pins a page of every input run and one of its output.
+  fan_in_ = std::max<size_t>(2, std::min<size_t>(memory_pages, bpm_->GetPoolSize() / 2));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::~ExternalSort() {
+  readers_.clear();
+  if (segment_id_ == INVALID_SEGMENT_ID) {
+    return;
+  }
+  if (segment_id_ == DEFAULT_SEGMENT_ID || !bpm_->DropSegment(segment_id_)) {
+    for (const auto &run : runs_) {
+      for (auto page_id : run.pages_) {
+        bpm_->DeletePage(page_id);
+      }
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!finished_, "cannot add entries to a finished sort");
+  buffer_.emplace_back(key, value);
+  if (buffer_.size() == buffer_capacity_) {
+    SpillBuffer();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Finish() {
+  BUSTUB_ASSERT(!finished_, "a sort can only be finished once");
+  finished_ = true;
+  if (runs_.empty()) {
+    SortBuffer();
+    return;
+  }
+  if (!buffer_.empty()) {
+    SpillBuffer();
+  }
+  buffer_ = std::vector<MappingType>();
+
+  // Merge groups of neighbouring runs until one merge is enough. Merging neighbours keeps the sort stable.
+  while (runs_.size() > fan_in_) {
+    std::vector<Run> merged;
+    for (size_t begin = 0; begin < runs_.size(); begin += fan_in_) {
+      size_t end = std::min(begin + fan_in_, runs_.size());
+      StartMerge(begin, end);
+      RunWriter writer(bpm_, segment_id_);
+      MappingType item;
+      while (NextMerged(&item)) {
+        writer.Append(item);
+      }
+      EndMerge(begin, end);
+      merged.push_back(writer.Finish());
+      run_count_++;
+    }
+    runs_ = std::move(merged);
+  }
+  StartMerge(0, runs_.size());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::Next(MappingType *item) -> bool {
+  BUSTUB_ASSERT(finished_, "a sort has to be finished before its entries can be read");
+  if (runs_.empty()) {
+    if (buffer_pos_ == buffer_.size()) {
+      return false;
+    }
+    *item = buffer_[buffer_pos_++];
+    return true;
+  }
+  return NextMerged(item);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::SortBuffer() {
+  std::stable_sort(buffer_.begin(), buffer_.end(),
+                   [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::SpillBuffer() {
+  SortBuffer();
+  if (segment_id_ == INVALID_SEGMENT_ID) {
+    segment_id_ = bpm_->CreateSegment();
+  }
+  RunWriter writer(bpm_, segment_id_);
+  for (const auto &item : buffer_) {
+    writer.Append(item);
+  }
+  runs_.push_back(writer.Finish());
+  run_count_++;
+  buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::StartMerge(size_t begin, size_t end) {
+  readers_.clear();
+  heap_.clear();
+  for (size_t i = begin; i < end; i++) {
+    readers_.emplace_back(bpm_, &runs_[i]);
+    if (!readers_.back().IsEnd()) {
+      heap_.push_back(i - begin);
+    }
+  }
+  auto after = [this](size_t a, size_t b) { return MergesAfter(a, b); };
+  std::make_heap(heap_.begin(), heap_.end(), after);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::MergesAfter(size_t a, size_t b) -> bool {
+  // std::push_heap() keeps the largest element in front, so the heap order is the other way around.
+  int cmp = comparator_(readers_[a].Get().first, readers_[b].Get().first);
+  return cmp != 0 ? cmp > 0 : a > b;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::NextMerged(MappingType *item) -> bool {
+  if (heap_.empty()) {
+    return false;
+  }
+  auto after = [this](size_t a, size_t b) { return MergesAfter(a, b); };
+  std::pop_heap(heap_.begin(), heap_.end(), after);
+  auto &reader = readers_[heap_.back()];
+  *item = reader.Get();
+  reader.Advance();
+  if (reader.IsEnd()) {
+    heap_.pop_back();
+  } else {
+    std::push_heap(heap_.begin(), heap_.end(), after);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::EndMerge(size_t begin, size_t end) {
+  readers_.clear();
+  heap_.clear();
+  for (size_t i = begin; i < end; i++) {
+    for (auto page_id : runs_[i].pages_) {
+      bpm_->DeletePage(page_id);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::RunReader::RunReader(BufferPoolManager *bpm, const Run *run) : bpm_(bpm), run_(run) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::RunReader::Get() -> const MappingType & {
+  size_t page_index = index_ / ENTRIES_PER_PAGE;
+  if (page_index != page_index_) {
+    auto *page = bpm_->FetchPage(run_->pages_[page_index]);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to read a sorted run");
+    }
+    guard_ = BasicPageGuard(bpm_, page);
+    page_index_ = page_index;
+  }
+  return reinterpret_cast<const MappingType *>(guard_.GetData())[index_ % ENTRIES_PER_PAGE];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::RunWriter::Append(const MappingType &item) {
+  if (run_.size_ % ENTRIES_PER_PAGE == 0) {
+    page_id_t page_id;
+    auto *page = bpm_->NewPage(&page_id, segment_id_);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to write a sorted run");
+    }
+    guard_ = BasicPageGuard(bpm_, page);
+    run_.pages_.push_back(page_id);
+  }
+  reinterpret_cast<MappingType *>(guard_.GetDataMut())[run_.size_ % ENTRIES_PER_PAGE] = item;
+  run_.size_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::RunWriter::Finish() -> Run {
+  guard_.Drop();
+  return std::move(run_);
+}
+
+template class ExternalSort<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSort<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSort<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSort<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSort<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExternalSort<GenericKey<128>, RID, GenericComparator<128>>;
+template class ExternalSort<GenericKey<256>, RID, GenericComparator<256>>;
+
+}  // namespace bustub
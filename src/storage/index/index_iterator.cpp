@@ -2,29 +2,90 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <optional>
+#include <utility>
 
 #include "storage/index/index_iterator.h"
 
+#include "storage/index/b_plus_tree.h"
+
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, ReadPageGuard guard, int index)
+    : bpm_(bpm), guard_(std::move(guard)), index_(index) {
+  page_id_ = guard_.PageId();
+  SkipToNextLeaf();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, ReadPageGuard guard, int index)
+    : bpm_(tree->bpm_), tree_(tree), guard_(std::move(guard)), index_(index) {
+  page_id_ = guard_.PageId();
+  SkipToPrevLeaf();
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_id_ == INVALID_PAGE_ID; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  item_ = guard_.As<LeafPage>()->GetItem(index_);
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  if (tree_ != nullptr) {
+    index_--;
+    SkipToPrevLeaf();
+  } else {
+    index_++;
+    SkipToNextLeaf();
+  }
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::SkipToNextLeaf() {
+  while (page_id_ != INVALID_PAGE_ID && index_ >= guard_.As<LeafPage>()->GetSize()) {
+    page_id_ = guard_.As<LeafPage>()->GetNextPageId();
+    index_ = 0;
+    if (page_id_ == INVALID_PAGE_ID) {
+      guard_.Drop();
+    } else {
+      guard_ = bpm_->FetchPageRead(page_id_);
+    }
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::SkipToPrevLeaf() {
+  // All keys before the iterator are less than the first key of the leaf, wherever they are by now. A leaf that a
+  // writer emptied before merging it into its left sibling has none, and the first key of the leaf after it still
+  // bounds the keys before it.
+  std::optional<KeyType> first_key;
+  while (page_id_ != INVALID_PAGE_ID && index_ < 0) {
+    const auto *leaf = guard_.As<LeafPage>();
+    if (leaf->GetSize() > 0) {
+      first_key = leaf->KeyAt(0);
+    }
+    if (!tree_->PrevLeaf(&guard_, first_key)) {
+      page_id_ = INVALID_PAGE_ID;
+      index_ = 0;
+      return;
+    }
+    page_id_ = guard_.PageId();
+    leaf = guard_.As<LeafPage>();
+    index_ = (first_key.has_value() ? leaf->KeyIndex(*first_key, tree_->comparator_) : leaf->GetSize()) - 1;
+  }
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -35,5 +96,7 @@ template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
 template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexIterator<GenericKey<128>, RID, GenericComparator<128>>;
+template class IndexIterator<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
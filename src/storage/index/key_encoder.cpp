@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.cpp
+//
+// Identification: src/storage/index/key_encoder.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_encoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+#include "type/value.h"
+
+namespace bustub {
+
+namespace {
+
+/** The number of characters of a varchar in each group of its encoding, see KeyEncoder. */
+constexpr uint32_t VARCHAR_GROUP_SIZE = 8;
+
+/** Writes bytes to a buffer of a fixed size, remembering whether they fit. */
+class KeyWriter {
+ public:
+  KeyWriter(char *out, size_t size) : out_(out), size_(size) {}
+
+  void Put(uint8_t byte) {
+    if (pos_ == size_) {
+      overflow_ = true;
+      return;
+    }
+    out_[pos_++] = static_cast<char>(byte);
+  }
+
+  /** Put the lowest bytes bytes of bits, the most significant first. */
+  void PutBigEndian(uint64_t bits, size_t bytes) {
+    for (size_t i = bytes; i > 0; i--) {
+      Put(static_cast<uint8_t>(bits >> (8 * (i - 1))));
+    }
+  }
+
+  /** Pad the rest of the buffer with 0 bytes. @return false if the bytes did not fit */
+  auto Finish() -> bool {
+    std::memset(out_ + pos_, 0, size_ - pos_);
+    return !overflow_;
+  }
+
+ private:
+  char *out_;
+  size_t size_;
+  size_t pos_{0};
+  bool overflow_{false};
+};
+
+void EncodeValue(const Value &value, KeyWriter *writer) {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      writer->PutBigEndian(static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80U, 1);
+      return;
+    case TypeId::SMALLINT:
+      writer->PutBigEndian(static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000U, 2);
+      return;
+    case TypeId::INTEGER:
+      writer->PutBigEndian(static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000U, 4);
+      return;
+    case TypeId::BIGINT:
+      writer->PutBigEndian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ (1ULL << 63), 8);
+      return;
+    case TypeId::TIMESTAMP:
+      writer->PutBigEndian(value.GetAs<uint64_t>(), 8);
+      return;
+    case TypeId::DECIMAL: {
+      // -0.0 equals 0.0, so both get the same encoding.
+      double decimal = value.GetAs<double>() == 0 ? 0.0 : value.GetAs<double>();
+      uint64_t bits;
+      std::memcpy(&bits, &decimal, sizeof(bits));
+      writer->PutBigEndian((bits >> 63) != 0 ? ~bits : bits ^ (1ULL << 63), 8);
+      return;
+    }
+    case TypeId::VARCHAR: {
+      if (value.IsNull()) {
+        writer->Put(0);
+        return;
+      }
+      writer->Put(1);
+      // The length of a varchar value counts its terminating 0 byte.
+      const char *data = value.GetData();
+      uint32_t length = value.GetLength() == 0 ? 0 : value.GetLength() - 1;
+      for (uint32_t start = 0;; start += VARCHAR_GROUP_SIZE) {
+        uint32_t used = std::min(VARCHAR_GROUP_SIZE, length - start);
+        for (uint32_t i = 0; i < VARCHAR_GROUP_SIZE; i++) {
+          writer->Put(i < used ? static_cast<uint8_t>(data[start + i]) : 0);
+        }
+        // The marker tells how many bytes of the group are characters, and that another group follows if all are.
+        writer->Put(static_cast<uint8_t>(0xFF - (VARCHAR_GROUP_SIZE - used)));
+        if (used < VARCHAR_GROUP_SIZE) {
+          return;
+        }
+      }
+    }
+    default:
+      UNREACHABLE("cannot encode a key column of this type");
+  }
+}
+
+}  // namespace
+
+auto KeyEncoder::EncodedSize(const Schema &key_schema) -> size_t {
+  size_t size = 0;
+  for (const auto &column : key_schema.GetColumns()) {
+    switch (column.GetType()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        size += 1;
+        break;
+      case TypeId::SMALLINT:
+        size += 2;
+        break;
+      case TypeId::INTEGER:
+        size += 4;
+        break;
+      case TypeId::BIGINT:
+      case TypeId::DECIMAL:
+      case TypeId::TIMESTAMP:
+        size += 8;
+        break;
+      case TypeId::VARCHAR:
+        size += 1 + (column.GetLength() / VARCHAR_GROUP_SIZE + 1) * (VARCHAR_GROUP_SIZE + 1);
+        break;
+      default:
+        UNREACHABLE("cannot encode a key column of this type");
+    }
+  }
+  return size;
+}
+
+auto KeyEncoder::IsFixedSize(const Schema &key_schema) -> bool {
+  for (const auto &column : key_schema.GetColumns()) {
+    if (column.GetType() == TypeId::VARCHAR) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto KeyEncoder::Encode(const Tuple &key, const Schema &key_schema, char *out, size_t size) -> bool {
+  KeyWriter writer(out, size);
+  for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+    EncodeValue(key.GetValue(&key_schema, i), &writer);
+  }
+  return writer.Finish();
+}
+
+void KeyEncoder::EncodeInteger(int64_t value, size_t size, char *out) {
+  BUSTUB_ASSERT(size == sizeof(int32_t) || size == sizeof(int64_t), "integer keys take 4 or 8 bytes");
+  KeyWriter writer(out, size);
+  writer.PutBigEndian(static_cast<uint64_t>(value) ^ (1ULL << (8 * size - 1)), size);
+}
+
+auto KeyEncoder::DecodeInteger(const char *data, size_t size) -> int64_t {
+  BUSTUB_ASSERT(size == sizeof(int32_t) || size == sizeof(int64_t), "integer keys take 4 or 8 bytes");
+  uint64_t bits = 0;
+  for (size_t i = 0; i < size; i++) {
+    bits = (bits << 8) | static_cast<uint8_t>(data[i]);
+  }
+  bits ^= 1ULL << (8 * size - 1);
+  return size == sizeof(int32_t) ? static_cast<int32_t>(bits) : static_cast<int64_t>(bits);
+}
+
+}  // namespace bustub
@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.cpp
+//
+// Identification: src/storage/index/key_search.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_search.h"
+
+#include "storage/index/key_encoder.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BUSTUB_HAS_AVX2_KEY_SEARCH
+#endif
+
+namespace bustub {
+
+/**
+ * Halve the keys until at most WINDOW_SIZE of them are left, keeping the bound within them.
+ * @return the index of the first key of the window; all keys before it count
+ */
+static auto Narrow(const char *keys, size_t stride, int *count, size_t width, uint64_t target, bool or_equal)
+    -> int {
+  int base = 0;
+  int size = *count;
+  while (size > KeySearch::WINDOW_SIZE) {
+    int half = size / 2;
+    uint64_t key = KeySearch::Load(keys + (base + half) * stride, width);
+    bool counts = or_equal ? key <= target : key < target;
+    base = counts ? base + half : base;
+    size -= half;
+  }
+  *count = size;
+  return base;
+}
+
+static auto CountWindowScalar(const char *keys, size_t stride, int count, size_t width, uint64_t target,
+                              bool or_equal) -> int {
+  int result = 0;
+  for (int i = 0; i < count; i++) {
+    uint64_t key = KeySearch::Load(keys + i * stride, width);
+    result += static_cast<int>(or_equal ? key <= target : key < target);
+  }
+  return result;
+}
+
+#ifdef BUSTUB_HAS_AVX2_KEY_SEARCH
+/** Count the keys of up to 4 bytes in a window, 8 at a time. */
+__attribute__((target("avx2"))) static auto CountWindow32(const char *keys, size_t stride, int count, size_t width,
+                                                          uint64_t target, bool or_equal) -> int {
+  const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                             _mm256_set1_epi32(static_cast<int>(stride)));
+  const __m256i byte_swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6,
+                                             5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(32 - 8 * width));
+  // AVX2 only compares signed integers, so flip the sign bits of both sides.
+  const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+  const __m256i needle = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(target) ^ 0x80000000U));
+
+  int result = 0;
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int *>(keys + i * stride), offsets, 1);
+    words = _mm256_xor_si256(_mm256_srl_epi32(_mm256_shuffle_epi8(words, byte_swap), shift), sign);
+    if (or_equal) {
+      int greater = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(words, needle)));
+      result += 8 - __builtin_popcount(greater);
+    } else {
+      int less = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, words)));
+      result += __builtin_popcount(less);
+    }
+  }
+  return result + CountWindowScalar(keys + i * stride, stride, count - i, width, target, or_equal);
+}
+
+/** Count the keys of 5 to 8 bytes in a window, 4 at a time. */
+__attribute__((target("avx2"))) static auto CountWindow64(const char *keys, size_t stride, int count, size_t width,
+                                                          uint64_t target, bool or_equal) -> int {
+  const __m128i offsets =
+      _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(stride)));
+  const __m256i byte_swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2,
+                                             1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(64 - 8 * width));
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i needle = _mm256_set1_epi64x(static_cast<int64_t>(target ^ (1ULL << 63)));
+
+  int result = 0;
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256i words = _mm256_i32gather_epi64(reinterpret_cast<const long long *>(keys + i * stride),  // NOLINT
+                                           offsets, 1);
+    words = _mm256_xor_si256(_mm256_srl_epi64(_mm256_shuffle_epi8(words, byte_swap), shift), sign);
+    if (or_equal) {
+      int greater = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(words, needle)));
+      result += 4 - __builtin_popcount(greater);
+    } else {
+      int less = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, words)));
+      result += __builtin_popcount(less);
+    }
+  }
+  return result + CountWindowScalar(keys + i * stride, stride, count - i, width, target, or_equal);
+}
+#endif
+
+auto KeySearch::Count(const char *keys, size_t stride, int count, size_t width, uint64_t target, bool or_equal)
+    -> int {
+#ifdef BUSTUB_HAS_AVX2_KEY_SEARCH
+  if (width > 0 && IsVectorized()) {
+    int base = Narrow(keys, stride, &count, width, target, or_equal);
+    const char *window = keys + base * stride;
+    if (width <= sizeof(uint32_t)) {
+      return base + CountWindow32(window, stride, count, width, target, or_equal);
+    }
+    return base + CountWindow64(window, stride, count, width, target, or_equal);
+  }
+#endif
+  return CountScalar(keys, stride, count, width, target, or_equal);
+}
+
+auto KeySearch::CountScalar(const char *keys, size_t stride, int count, size_t width, uint64_t target, bool or_equal)
+    -> int {
+  if (width == 0) {
+    // Keys without bytes are all equal.
+    return or_equal ? count : 0;
+  }
+  int base = Narrow(keys, stride, &count, width, target, or_equal);
+  return base + CountWindowScalar(keys + base * stride, stride, count, width, target, or_equal);
+}
+
+auto KeySearch::Load(const char *key, size_t width) -> uint64_t {
+  if (width == 0) {
+    return 0;
+  }
+  if (width <= sizeof(uint32_t)) {
+    return KeyEncoder::LoadBigEndian<uint32_t>(key) >> (32 - 8 * width);
+  }
+  return KeyEncoder::LoadBigEndian<uint64_t>(key) >> (64 - 8 * width);
+}
+
+auto KeySearch::IsVectorized() -> bool {
+#ifdef BUSTUB_HAS_AVX2_KEY_SEARCH
+  static const bool HAS_AVX2 = __builtin_cpu_supports("avx2");
+  return HAS_AVX2;
+#else
+  return false;
+#endif
+}
+
+}  // namespace bustub
@@ -9,10 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
 #include "common/exception.h"
+#include "common/macros.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -25,32 +28,284 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size,
+                                          InternalPageLayout layout) {
+  BUSTUB_ASSERT(max_size <= Capacity(layout), "internal page max size is over the capacity of its layout");
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetLSN();
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetParentPageId(parent_id);
+  SetPageId(page_id);
+  layout_ = layout;
+  summary_height_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetLayout() const -> InternalPageLayout { return layout_; }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
-  return key;
-}
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType { return array_[index].first; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  array_[index].first = key;
+  UpdateSummary();
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return 0; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { array_[index].second = value; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetItem(int index) const -> const MappingType & { return array_[index]; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < GetSize(); i++) {
+    if (array_[i].second == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
+  return array_[FindIndex(key, comparator, true, nullptr)].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator,
+                                            std::optional<KeyType> *high_key) const -> ValueType {
+  int size;
+  int index = FindIndex(key, comparator, true, &size);
+  if (index + 1 < size) {
+    *high_key = array_[index + 1].first;
+  }
+  return array_[index].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator,
+                                                 bool or_equal) const -> int {
+  return FindIndex(key, comparator, or_equal, nullptr);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindIndex(const KeyType &key, const KeyComparator &comparator, bool or_equal,
+                                               int *size) const -> int {
+  // Find the last key that is not greater than (less than) the given key, skipping the invalid first key. Optimistic
+  // readers may look at a page in the middle of an update, so never search past the end of the page or the summary.
+  int right = std::clamp(GetSize(), 1, Capacity(layout_));
+  if (size != nullptr) {
+    *size = right;
+  }
+  if (layout_ != InternalPageLayout::EYTZINGER) {
+    return SearchEntries(1, right - 1, key, comparator, or_equal);
+  }
+
+  // Walk down the summary, going to slot 2k+1 rather than 2k without a branch if the key at slot k counts, i.e. is not
+  // greater than (less than) the given key. In a complete tree, where the walk ends below the bottom level tells how
+  // many summary keys count, which is the block to search (past the last one if it went right on a copy).
+  int max_height = SummaryHeight(Capacity(InternalPageLayout::EYTZINGER));
+  const KeyType *summary = SummaryKeys();
+  // The walk depends on each compare before it, so rather than wait for a cache line at every level, fetch the few
+  // lines the summary may take all at once, without waiting for the header either.
+  const auto *summary_bytes = reinterpret_cast<const char *>(summary);
+  for (size_t offset = 0; offset < (size_t{1} << max_height) * sizeof(KeyType); offset += 64) {
+    __builtin_prefetch(summary_bytes + offset);
+  }
+  int height = std::clamp(summary_height_, 0, max_height);
+  uint64_t target = 0;
+  if constexpr (IsByteComparable<KeyComparator>::value && sizeof(KeyType) <= sizeof(uint64_t)) {
+    target = KeySearch::Load(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+  }
+  uint64_t slot = 1;
+  for (int level = 0; level < height; level++) {
+    bool counts;
+    if constexpr (IsByteComparable<KeyComparator>::value && sizeof(KeyType) <= sizeof(uint64_t)) {
+      uint64_t probe = KeySearch::Load(reinterpret_cast<const char *>(&summary[slot]), sizeof(KeyType));
+      counts = or_equal ? probe <= target : probe < target;
+    } else {
+      counts = comparator(summary[slot], key) < static_cast<int>(or_equal);
+    }
+    slot = 2 * slot + static_cast<uint64_t>(counts);
+  }
+  int last_block = std::max(0, (right - 2) / BLOCK_SIZE);
+  int block = std::min(static_cast<int>(slot - (uint64_t{1} << height)), last_block);
+  int begin = 1 + block * BLOCK_SIZE;
+  int count = std::min(BLOCK_SIZE, right - begin);
+  if (count > 0) {
+    __builtin_prefetch(&array_[begin + count - 1]);
+  }
+  return SearchEntries(begin, count, key, comparator, or_equal);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SearchEntries(int begin, int count, const KeyType &key,
+                                                   const KeyComparator &comparator, bool or_equal) const -> int {
+  if constexpr (IsByteComparable<KeyComparator>::value && sizeof(KeyType) <= sizeof(uint64_t)) {
+    uint64_t target = KeySearch::Load(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+    return begin - 1 + KeySearch::Count(reinterpret_cast<const char *>(&array_[begin].first), sizeof(MappingType),
+                                        count, sizeof(KeyType), target, or_equal);
+  }
+  int left = begin;
+  int right = begin + count;
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (comparator(array_[mid].first, key) < static_cast<int>(or_equal)) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left - 1;
+}
+
+/*****************************************************************************
+ * SUMMARY
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SummaryKeys() const -> const KeyType * {
+  return reinterpret_cast<const KeyType *>(reinterpret_cast<const char *>(this) +
+                                           SummaryOffset(Capacity(InternalPageLayout::EYTZINGER)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SummaryKeys() -> KeyType * {
+  return reinterpret_cast<KeyType *>(reinterpret_cast<char *>(this) +
+                                     SummaryOffset(Capacity(InternalPageLayout::EYTZINGER)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::UpdateSummary() {
+  if (layout_ != InternalPageLayout::EYTZINGER) {
+    return;
+  }
+  // The first block needs no summary key, every key of the page before the second block is in it.
+  summary_height_ = SummaryHeight(GetSize());
+  int block = 1;
+  FillSummary(1, &block);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::FillSummary(uint64_t slot, int *block) {
+  if (slot >= (uint64_t{1} << summary_height_)) {
+    return;
+  }
+  FillSummary(2 * slot, block);
+  int last_block = (GetSize() - 2) / BLOCK_SIZE;
+  SummaryKeys()[slot] = array_[1 + std::min(*block, last_block) * BLOCK_SIZE].first;
+  (*block)++;
+  FillSummary(2 * slot + 1, block);
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                     const ValueType &new_value) {
+  array_[0].second = old_value;
+  array_[1] = {new_key, new_value};
+  SetSize(2);
+  UpdateSummary();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                     const ValueType &new_value) {
+  int index = ValueIndex(old_value) + 1;
+  std::move_backward(array_ + index, array_ + GetSize(), array_ + GetSize() + 1);
+  array_[index] = {new_key, new_value};
+  IncreaseSize(1);
+  UpdateSummary();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  std::move(array_ + index + 1, array_ + GetSize(), array_ + index);
+  IncreaseSize(-1);
+  UpdateSummary();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFrom(const MappingType *items, int size) {
+  std::copy(items, items + size, array_);
+  SetSize(size);
+  UpdateSummary();
+}
+
+/*****************************************************************************
+ * MERGE AND REDISTRIBUTE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  array_[0].first = middle_key;
+  std::copy(array_, array_ + GetSize(), recipient->array_ + recipient->GetSize());
+  recipient->IncreaseSize(GetSize());
+  recipient->UpdateSummary();
+  SetSize(0);
+  UpdateSummary();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->array_[recipient->GetSize()] = {middle_key, array_[0].second};
+  recipient->IncreaseSize(1);
+  recipient->UpdateSummary();
+  Remove(0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  std::move_backward(recipient->array_, recipient->array_ + recipient->GetSize(),
+                     recipient->array_ + recipient->GetSize() + 1);
+  recipient->array_[1].first = middle_key;
+  recipient->array_[0] = array_[GetSize() - 1];
+  recipient->IncreaseSize(1);
+  recipient->UpdateSummary();
+  IncreaseSize(-1);
+  UpdateSummary();
+}
 
 // valuetype for internalNode should be page id_t
+/** @return the size of the header in front of the entries of an internal page with the given types */
+INDEX_TEMPLATE_ARGUMENTS
+constexpr auto InternalPageHeaderSize() -> size_t {
+  return sizeof(B_PLUS_TREE_INTERNAL_PAGE_TYPE) - sizeof(MappingType);
+}
+
+// INTERNAL_PAGE_SIZE is computed from INTERNAL_PAGE_HEADER_SIZE, so it must match the layout, and an internal page
+// must be able to split.
+static_assert(sizeof(BPlusTreePage) + sizeof(InternalPageLayout) + sizeof(int) == INTERNAL_PAGE_HEADER_SIZE);
+static_assert(InternalPageHeaderSize<GenericKey<4>, page_id_t, GenericComparator<4>>() == INTERNAL_PAGE_HEADER_SIZE);
+static_assert(InternalPageHeaderSize<GenericKey<256>, page_id_t, GenericComparator<256>>() ==
+              INTERNAL_PAGE_HEADER_SIZE);
+static_assert((BUSTUB_PAGE_USABLE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<256>, page_id_t>) >=
+              3);
+static_assert(BPlusTreeInternalPage<GenericKey<EYTZINGER_MAX_KEY_SIZE>, page_id_t,
+                                    GenericComparator<EYTZINGER_MAX_KEY_SIZE>>::Capacity(InternalPageLayout::EYTZINGER) >=
+              3);
+
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
 template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
+template class BPlusTreeInternalPage<GenericKey<256>, page_id_t, GenericComparator<256>>;
 }  // namespace bustub
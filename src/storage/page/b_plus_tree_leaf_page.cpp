@@ -9,10 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -27,31 +30,467 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  BUSTUB_ASSERT(max_size >= 2 && max_size <= static_cast<int>(LEAF_PAGE_SIZE), "leaf max size out of range");
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetLSN();
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetParentPageId(parent_id);
+  SetPageId(page_id);
+  next_page_id_ = INVALID_PAGE_ID;
+  prev_page_id_ = INVALID_PAGE_ID;
+  prefix_size_ = 0;
+  suffix_size_ = 0;
+}
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next and previous page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return INVALID_PAGE_ID; }
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  KeyType key{};
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType { return DecodeKey(GetLayout(), index); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType { return DecodeValue(GetLayout(), index); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const -> MappingType {
+  auto layout = GetLayout();
+  return {DecodeKey(layout, index), DecodeValue(layout, index)};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyItems(int begin, int end, MappingType *items) const {
+  auto layout = GetLayout();
+  for (int i = begin; i < end; i++) {
+    items[i - begin] = {DecodeKey(layout, i), DecodeValue(layout, i)};
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetCapacity() const -> int { return CapacityOf(GetLayout(), GetMaxSize()); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetMinSize() const -> int {
+  return (CapacityOf(MakeLayout(0, 0, 0), GetMaxSize()) + 1) / 2;
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  // Optimistic readers may look at a page in the middle of an update, so never search past the end of the page.
+  auto layout = GetLayout();
+  if constexpr (IsByteComparable<KeyComparator>::value) {
+    if (layout.size_ == 0) {
+      return 0;
+    }
+    // All keys share the affix, so the key either sorts before or after all of them, or only their middle bytes and
+    // the suffix tell them apart. The middle bytes of the keys are unique, and where the key has the same ones, the
+    // entry comes before the key if the key has the greater suffix.
+    const auto *bytes = reinterpret_cast<const char *>(&key);
+    int prefix_cmp = std::memcmp(bytes, affix_, layout.prefix_size_);
+    if (prefix_cmp != 0) {
+      return prefix_cmp < 0 ? 0 : layout.size_;
+    }
+    int suffix_start = KEY_SIZE - layout.suffix_size_;
+    bool after_equal = std::memcmp(bytes + suffix_start, affix_ + suffix_start, layout.suffix_size_) > 0;
+    if (layout.key_size_ <= sizeof(uint64_t)) {
+      char middle[sizeof(uint64_t)] = {};
+      std::memcpy(middle, bytes + layout.prefix_size_, layout.key_size_);
+      return KeySearch::Count(EntryAt(layout, 0), layout.entry_size_, layout.size_, layout.key_size_,
+                              KeySearch::Load(middle, layout.key_size_), after_equal);
+    }
+    if constexpr (KEY_SIZE > static_cast<int>(sizeof(uint64_t))) {
+      int left = 0;
+      int right = layout.size_;
+      while (left < right) {
+        int mid = left + (right - left) / 2;
+        int cmp = std::memcmp(EntryAt(layout, mid), bytes + layout.prefix_size_, layout.key_size_);
+        if (cmp < 0 || (cmp == 0 && after_equal)) {
+          left = mid + 1;
+        } else {
+          right = mid;
+        }
+      }
+      return left;
+    }
+  }
+  int left = 0;
+  int right = layout.size_;
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (comparator(DecodeKey(layout, mid), key) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const
+    -> bool {
+  int index = KeyIndex(key, comparator);
+  auto layout = GetLayout();
+  if (index >= layout.size_ || comparator(DecodeKey(layout, index), key) != 0) {
+    return false;
+  }
+  *value = DecodeValue(layout, index);
+  return true;
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanInsert(const KeyType &key) const -> bool {
+  int prefix_size;
+  int suffix_size;
+  AffixWith(key, &prefix_size, &suffix_size);
+  return GetSize() + 1 <= CapacityOf(MakeLayout(prefix_size, suffix_size, 0), GetMaxSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator)
+    -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    return false;
+  }
+  InsertAt(index, key, value);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(const KeyType &key, const KeyComparator &comparator) -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(KeyAt(index), key) != 0) {
+    return false;
+  }
+  RemoveAt(index);
+  return true;
+}
+
+/*****************************************************************************
+ * SPLIT, MERGE AND REDISTRIBUTE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFrom(const MappingType *items, int size) {
+  int prefix_size = 0;
+  int suffix_size = 0;
+  if (size > 0) {
+    std::memcpy(affix_, &items[0].first, KEY_SIZE);
+    prefix_size = KEY_SIZE;
+    suffix_size = KEY_SIZE;
+    for (int i = 1; i < size; i++) {
+      NarrowAffix(affix_, reinterpret_cast<const char *>(&items[i].first), &prefix_size, &suffix_size);
+    }
+    suffix_size = std::min(suffix_size, KEY_SIZE - prefix_size);
+  }
+  prefix_size_ = static_cast<uint16_t>(prefix_size);
+  suffix_size_ = static_cast<uint16_t>(suffix_size);
+  auto layout = MakeLayout(prefix_size, suffix_size, size);
+  BUSTUB_ASSERT(layout.size_ == size, "entries do not fit in a leaf page");
+  for (int i = 0; i < size; i++) {
+    Encode(layout, i, items[i].first, items[i].second);
+  }
+  SetSize(size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAndSplit(const KeyType &key, const ValueType &value,
+                                                const KeyComparator &comparator, BPlusTreeLeafPage *recipient) {
+  int index = KeyIndex(key, comparator);
+  std::vector<MappingType> items;
+  items.reserve(GetSize() + 1);
+  for (int i = 0; i < GetSize(); i++) {
+    if (i == index) {
+      items.emplace_back(key, value);
+    }
+    items.push_back(GetItem(i));
+  }
+  if (index == GetSize()) {
+    items.emplace_back(key, value);
+  }
+  int keep = static_cast<int>(items.size()) / 2;
+  CopyFrom(items.data(), keep);
+  recipient->CopyFrom(items.data() + keep, static_cast<int>(items.size()) - keep);
+  recipient->next_page_id_ = next_page_id_;
+  recipient->prev_page_id_ = GetPageId();
+  next_page_id_ = recipient->GetPageId();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanMergeWith(const BPlusTreeLeafPage *right) const -> bool {
+  int prefix_size;
+  int suffix_size;
+  AffixWith(right, &prefix_size, &suffix_size);
+  return GetSize() + right->GetSize() <= CapacityOf(MakeLayout(prefix_size, suffix_size, 0), GetMaxSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  std::vector<MappingType> items;
+  items.reserve(recipient->GetSize() + GetSize());
+  for (int i = 0; i < recipient->GetSize(); i++) {
+    items.push_back(recipient->GetItem(i));
+  }
+  for (int i = 0; i < GetSize(); i++) {
+    items.push_back(GetItem(i));
+  }
+  recipient->CopyFrom(items.data(), static_cast<int>(items.size()));
+  recipient->next_page_id_ = next_page_id_;
+  SetSize(0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RedistributeWith(BPlusTreeLeafPage *right) {
+  std::vector<MappingType> items;
+  items.reserve(GetSize() + right->GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    items.push_back(GetItem(i));
+  }
+  for (int i = 0; i < right->GetSize(); i++) {
+    items.push_back(right->GetItem(i));
+  }
+  int size = static_cast<int>(items.size());
+  int max_size = GetMaxSize();
+  // Any min_size entries fit in a page, and so do the entries of either page before. Keeping one page as it was and
+  // filling the other up to min_size thus fits, and the more entries a page takes from the front or the back, the
+  // fewer fit. The even split moves towards that until both pages have room for their part.
+  int min_size = GetMinSize();
+  int keep = std::clamp(size / 2, min_size, size - min_size);
+  while (keep > min_size && keep > Capacity(items.data(), keep, max_size)) {
+    keep--;
+  }
+  while (keep < size - min_size && size - keep > Capacity(items.data() + keep, size - keep, max_size)) {
+    keep++;
+  }
+  CopyFrom(items.data(), keep);
+  right->CopyFrom(items.data() + keep, size - keep);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Capacity(const MappingType *items, int size, int max_size) -> int {
+  int prefix_size = 0;
+  int suffix_size = 0;
+  if (size > 0) {
+    prefix_size = KEY_SIZE;
+    suffix_size = KEY_SIZE;
+    for (int i = 1; i < size; i++) {
+      NarrowAffix(reinterpret_cast<const char *>(&items[0].first), reinterpret_cast<const char *>(&items[i].first),
+                  &prefix_size, &suffix_size);
+    }
+    suffix_size = std::min(suffix_size, KEY_SIZE - prefix_size);
+  }
+  return CapacityOf(MakeLayout(prefix_size, suffix_size, 0), max_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::FillSize(const MappingType *items, int size, int max_size, double fill_factor)
+    -> int {
+  // The more entries, the fewer bytes they have in common, so the capacity only goes down as the page fills.
+  int prefix_size = KEY_SIZE;
+  int suffix_size = KEY_SIZE;
+  for (int n = 1; n <= size; n++) {
+    NarrowAffix(reinterpret_cast<const char *>(&items[0].first), reinterpret_cast<const char *>(&items[n - 1].first),
+                &prefix_size, &suffix_size);
+    int capacity = CapacityOf(MakeLayout(prefix_size, std::min(suffix_size, KEY_SIZE - prefix_size), 0), max_size);
+    int target = std::clamp(static_cast<int>(fill_factor * capacity), std::max((capacity + 1) / 2, 1), capacity);
+    if (n > target) {
+      return n - 1;
+    }
+  }
+  return size;
+}
+
+/*****************************************************************************
+ * ENTRY LAYOUT
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetLayout() const -> Layout {
+  int prefix_size = std::min<int>(prefix_size_, KEY_SIZE);
+  int suffix_size = std::min<int>(suffix_size_, KEY_SIZE - prefix_size);
+  return MakeLayout(prefix_size, suffix_size, GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::MakeLayout(int prefix_size, int suffix_size, int size) -> Layout {
+  Layout layout;
+  layout.prefix_size_ = prefix_size;
+  layout.suffix_size_ = suffix_size;
+  layout.key_size_ = KEY_SIZE - prefix_size - suffix_size;
+  layout.entry_size_ = layout.key_size_ + sizeof(ValueType);
+  layout.size_ = std::clamp(size, 0, static_cast<int>(LEAF_PAGE_DATA_SIZE / layout.entry_size_));
+  return layout;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CapacityOf(const Layout &layout, int max_size) -> int {
+  return std::min(max_size - 1, static_cast<int>(LEAF_PAGE_DATA_SIZE / layout.entry_size_));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::NarrowAffix(const char *affix, const char *key, int *prefix_size, int *suffix_size) {
+  int prefix = 0;
+  while (prefix < *prefix_size && affix[prefix] == key[prefix]) {
+    prefix++;
+  }
+  int suffix = 0;
+  while (suffix < *suffix_size && affix[KEY_SIZE - 1 - suffix] == key[KEY_SIZE - 1 - suffix]) {
+    suffix++;
+  }
+  *prefix_size = prefix;
+  *suffix_size = suffix;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::AffixWith(const KeyType &key, int *prefix_size, int *suffix_size) const {
+  if (GetSize() == 0) {
+    *prefix_size = KEY_SIZE;
+    *suffix_size = 0;
+    return;
+  }
+  *prefix_size = prefix_size_;
+  *suffix_size = suffix_size_;
+  if (*prefix_size + *suffix_size == KEY_SIZE) {
+    // Only a single key has nothing left to store; its bytes are all in the affix.
+    *prefix_size = KEY_SIZE;
+    *suffix_size = KEY_SIZE;
+  }
+  NarrowAffix(affix_, reinterpret_cast<const char *>(&key), prefix_size, suffix_size);
+  *suffix_size = std::min(*suffix_size, KEY_SIZE - *prefix_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::AffixWith(const BPlusTreeLeafPage *other, int *prefix_size, int *suffix_size) const {
+  if (other->GetSize() == 0 || GetSize() == 0) {
+    const auto *page = GetSize() == 0 ? other : this;
+    *prefix_size = page->prefix_size_;
+    *suffix_size = page->suffix_size_;
+    return;
+  }
+  // The affix of the other page holds the bytes all of its keys have in common, so it stands in for them.
+  *prefix_size = prefix_size_ + suffix_size_ == KEY_SIZE ? KEY_SIZE : prefix_size_;
+  *suffix_size = prefix_size_ + suffix_size_ == KEY_SIZE ? KEY_SIZE : suffix_size_;
+  int other_prefix_size = other->prefix_size_ + other->suffix_size_ == KEY_SIZE ? KEY_SIZE : other->prefix_size_;
+  int other_suffix_size = other->prefix_size_ + other->suffix_size_ == KEY_SIZE ? KEY_SIZE : other->suffix_size_;
+  *prefix_size = std::min(*prefix_size, other_prefix_size);
+  *suffix_size = std::min(*suffix_size, other_suffix_size);
+  NarrowAffix(affix_, other->affix_, prefix_size, suffix_size);
+  *suffix_size = std::min(*suffix_size, KEY_SIZE - *prefix_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::EntryAt(const Layout &layout, int index) const -> const char * {
+  return reinterpret_cast<const char *>(this) + sizeof(BPlusTreeLeafPage) + index * layout.entry_size_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::EntryAt(const Layout &layout, int index) -> char * {
+  return reinterpret_cast<char *>(this) + sizeof(BPlusTreeLeafPage) + index * layout.entry_size_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::DecodeKey(const Layout &layout, int index) const -> KeyType {
+  KeyType key;
+  auto *bytes = reinterpret_cast<char *>(&key);
+  std::memcpy(bytes, affix_, layout.prefix_size_);
+  std::memcpy(bytes + layout.prefix_size_, EntryAt(layout, index), layout.key_size_);
+  std::memcpy(bytes + KEY_SIZE - layout.suffix_size_, affix_ + KEY_SIZE - layout.suffix_size_, layout.suffix_size_);
   return key;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::DecodeValue(const Layout &layout, int index) const -> ValueType {
+  ValueType value;
+  std::memcpy(&value, EntryAt(layout, index) + layout.key_size_, sizeof(ValueType));
+  return value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Encode(const Layout &layout, int index, const KeyType &key, const ValueType &value) {
+  char *entry = EntryAt(layout, index);
+  std::memcpy(entry, reinterpret_cast<const char *>(&key) + layout.prefix_size_, layout.key_size_);
+  std::memcpy(entry + layout.key_size_, &value, sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Widen(int prefix_size, int suffix_size) {
+  // Entries only grow, so moving them from the back never overwrites one that has not moved yet.
+  auto from = GetLayout();
+  auto to = MakeLayout(prefix_size, suffix_size, GetSize());
+  BUSTUB_ASSERT(to.entry_size_ >= from.entry_size_ && to.size_ == GetSize(), "entries do not fit in a leaf page");
+  for (int i = GetSize() - 1; i >= 0; i--) {
+    auto key = DecodeKey(from, i);
+    auto value = DecodeValue(from, i);
+    Encode(to, i, key, value);
+  }
+  prefix_size_ = static_cast<uint16_t>(prefix_size);
+  suffix_size_ = static_cast<uint16_t>(suffix_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  int prefix_size;
+  int suffix_size;
+  AffixWith(key, &prefix_size, &suffix_size);
+  if (GetSize() == 0) {
+    std::memcpy(affix_, &key, KEY_SIZE);
+    prefix_size_ = static_cast<uint16_t>(prefix_size);
+    suffix_size_ = static_cast<uint16_t>(suffix_size);
+  } else if (prefix_size != prefix_size_ || suffix_size != suffix_size_) {
+    Widen(prefix_size, suffix_size);
+  }
+  auto layout = MakeLayout(prefix_size, suffix_size, GetSize() + 1);
+  BUSTUB_ASSERT(layout.size_ == GetSize() + 1, "no room for an entry in a leaf page");
+  char *entry = EntryAt(layout, index);
+  std::memmove(entry + layout.entry_size_, entry, (GetSize() - index) * layout.entry_size_);
+  Encode(layout, index, key, value);
+  IncreaseSize(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(int index) {
+  auto layout = GetLayout();
+  char *entry = EntryAt(layout, index);
+  std::memmove(entry, entry + layout.entry_size_, (GetSize() - index - 1) * layout.entry_size_);
+  IncreaseSize(-1);
+}
+
+/** @return the size of the header in front of the affix of a leaf page with the given types */
+INDEX_TEMPLATE_ARGUMENTS
+constexpr auto LeafPageHeaderSize() -> size_t { return sizeof(B_PLUS_TREE_LEAF_PAGE_TYPE) - sizeof(KeyType); }
+
+// LEAF_PAGE_SIZE is computed from LEAF_PAGE_HEADER_SIZE, so it must match the layout, and a leaf must be able to split.
+static_assert(LeafPageHeaderSize<GenericKey<4>, RID, GenericComparator<4>>() == LEAF_PAGE_HEADER_SIZE);
+static_assert(LeafPageHeaderSize<GenericKey<256>, RID, GenericComparator<256>>() == LEAF_PAGE_HEADER_SIZE);
+static_assert((BUSTUB_PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE - 256) / sizeof(std::pair<GenericKey<256>, RID>) >= 3);
+
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTreeLeafPage<GenericKey<256>, RID, GenericComparator<256>>;
 }  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.cpp
+//
+// Identification: src/storage/page/free_space_map_page.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/free_space_map_page.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void FreeSpaceMapPage::Init(page_id_t page_id) {
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetNextPageId(INVALID_PAGE_ID);
+  SetEntryCount(0);
+  SetLastTablePageId(INVALID_PAGE_ID);
+  SetLastFsmPageId(page_id);
+}
+
+auto FreeSpaceMapPage::AppendEntry(page_id_t table_page_id, uint32_t free_space, uint32_t *slot_num) -> bool {
+  if (IsFull()) {
+    return false;
+  }
+  *slot_num = GetEntryCount();
+  memcpy(GetData() + OFFSET_ENTRIES + sizeof(page_id_t) * *slot_num, &table_page_id, sizeof(page_id_t));
+  SetEntryCount(*slot_num + 1);
+  SetFreeSpace(*slot_num, free_space);
+  return true;
+}
+
+auto FreeSpaceMapPage::SetFreeSpace(uint32_t slot_num, uint32_t free_space) -> bool {
+  BUSTUB_ASSERT(slot_num < GetEntryCount(), "Cannot set free space of an untracked slot.");
+  uint8_t bucket = FreeSpaceToBucket(free_space);
+  if (GetBucket(slot_num) == bucket) {
+    return false;
+  }
+  memcpy(GetData() + OFFSET_BUCKETS + slot_num, &bucket, sizeof(uint8_t));
+  return true;
+}
+
+auto FreeSpaceMapPage::FindFreeSpace(uint32_t required_space, uint32_t *slot_num) -> bool {
+  uint32_t required_bucket = RequiredSpaceToBucket(required_space);
+  if (required_bucket > UINT8_MAX) {
+    return false;
+  }
+  // The buckets are a dense byte array, so this is a plain memory scan that never touches the table pages.
+  auto *buckets = reinterpret_cast<uint8_t *>(GetData() + OFFSET_BUCKETS);
+  uint32_t entry_count = GetEntryCount();
+  for (uint32_t i = 0; i < entry_count; i++) {
+    if (buckets[i] >= required_bucket) {
+      *slot_num = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -43,6 +43,17 @@ auto HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const -> bool {
   return false;
 }
 
+/** @return true if the bitmaps and BLOCK_ARRAY_SIZE entries of a block page with the given types fit in a page */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+constexpr auto BlockPageFits() -> bool {
+  return sizeof(HashTableBlockPage<KeyType, ValueType, KeyComparator>) + (BLOCK_ARRAY_SIZE - 1) * sizeof(MappingType) <=
+         BUSTUB_PAGE_USABLE_SIZE;
+}
+
+static_assert(BlockPageFits<int, int, IntComparator>());
+static_assert(BlockPageFits<GenericKey<4>, RID, GenericComparator<4>>());
+static_assert(BlockPageFits<GenericKey<64>, RID, GenericComparator<64>>());
+
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
 template class HashTableBlockPage<int, int, IntComparator>;
 template class HashTableBlockPage<GenericKey<4>, RID, GenericComparator<4>>;
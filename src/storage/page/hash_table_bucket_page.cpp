@@ -100,6 +100,16 @@ void HASH_TABLE_BUCKET_TYPE::PrintBucket() {
   LOG_INFO("Bucket Capacity: %lu, Size: %u, Taken: %u, Free: %u", BUCKET_ARRAY_SIZE, size, taken, free);
 }
 
+/** @return true if the bitmaps and BUCKET_ARRAY_SIZE entries of a bucket page with the given types fit in a page */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+constexpr auto BucketPageFits() -> bool {
+  return sizeof(HASH_TABLE_BUCKET_TYPE) + (BUCKET_ARRAY_SIZE - 1) * sizeof(MappingType) <= BUSTUB_PAGE_USABLE_SIZE;
+}
+
+static_assert(BucketPageFits<int, int, IntComparator>());
+static_assert(BucketPageFits<GenericKey<4>, RID, GenericComparator<4>>());
+static_assert(BucketPageFits<GenericKey<64>, RID, GenericComparator<64>>());
+
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
 template class HashTableBucketPage<int, int, IntComparator>;
 
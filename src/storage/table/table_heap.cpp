@@ -19,78 +19,300 @@
 namespace bustub {
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     page_id_t first_page_id)
+                     page_id_t first_page_id, page_id_t fsm_page_id)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      segment_id_(DiskManager::GetSegmentId(first_page_id)),
+      fsm_page_id_(fsm_page_id) {
+  BuildFreeSpaceMap();
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+                     Transaction *txn, segment_id_t segment_id)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      segment_id_(segment_id) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_, segment_id_));
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
-  first_page->Init(first_page_id_, BUSTUB_PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  first_page->Init(first_page_id_, BUSTUB_PAGE_USABLE_SIZE, INVALID_LSN, log_manager_, txn);
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  BuildFreeSpaceMap();
 }
 
-auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
-  if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) {  // larger than one page size
-    txn->SetState(TransactionState::ABORTED);
-    return false;
+void TableHeap::BuildFreeSpaceMap() {
+  bool reuse_root = fsm_page_id_ != INVALID_PAGE_ID;
+  FreeSpaceMapPage *fsm_root;
+  if (!reuse_root) {
+    fsm_root = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&fsm_page_id_, segment_id_));
+  } else {
+    fsm_root = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id_));
+  }
+  BUSTUB_ASSERT(fsm_root != nullptr, "Couldn't get the root free space map page of the table heap.");
+  fsm_root->WLatch();
+  if (reuse_root) {
+    // Delete the rest of the old map, whose entries may be stale. Its pages are not logged, so any of them may not have
+    // reached the disk: the walk stops at the first one that does not name itself.
+    auto old_page_id = fsm_root->GetFsmPageId() == fsm_page_id_ ? fsm_root->GetNextPageId() : INVALID_PAGE_ID;
+    while (old_page_id != INVALID_PAGE_ID) {
+      auto old_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(old_page_id));
+      BUSTUB_ASSERT(old_page != nullptr, "Couldn't fetch a free space map page while rebuilding the map.");
+      auto next_page_id = old_page->GetFsmPageId() == old_page_id ? old_page->GetNextPageId() : INVALID_PAGE_ID;
+      buffer_pool_manager_->UnpinPage(old_page_id, false);
+      buffer_pool_manager_->DeletePage(old_page_id);
+      old_page_id = next_page_id;
+    }
+  }
+  fsm_root->Init(fsm_page_id_);
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a table page while building the free space map.");
+    page->RLatch();
+    auto free_space = page->GetFreeSpaceRemaining();
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    TrackTablePage(fsm_root, page_id, free_space);
+    fsm_root->SetLastTablePageId(page_id);
+    page_id = next_page_id;
+  }
+  fsm_root->WUnlatch();
+  buffer_pool_manager_->UnpinPage(fsm_page_id_, true);
+}
+
+auto TableHeap::TrackTablePage(FreeSpaceMapPage *fsm_root, page_id_t table_page_id, uint32_t free_space) -> bool {
+  // Entries are only ever appended to the last FSM page. The root latch serializes appends, so it is safe to latch the
+  // last page (root first, then last) without risking a deadlock with lookups, which hold one FSM latch at a time.
+  auto last_fsm_page_id = fsm_root->GetLastFsmPageId();
+  auto last_fsm_page = fsm_root;
+  if (last_fsm_page_id != fsm_page_id_) {
+    last_fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(last_fsm_page_id));
+    if (last_fsm_page == nullptr) {
+      return false;
+    }
+    last_fsm_page->WLatch();
+  }
+
+  uint32_t slot_num;
+  auto fsm_page_id = last_fsm_page_id;
+  if (!last_fsm_page->AppendEntry(table_page_id, free_space, &slot_num)) {
+    // The last FSM page is full, chain a new one after it.
+    page_id_t new_fsm_page_id;
+    auto new_fsm_page =
+        reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&new_fsm_page_id, segment_id_));
+    if (new_fsm_page == nullptr) {
+      if (last_fsm_page != fsm_root) {
+        last_fsm_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(last_fsm_page_id, false);
+      }
+      return false;
+    }
+    new_fsm_page->Init(new_fsm_page_id);
+    new_fsm_page->AppendEntry(table_page_id, free_space, &slot_num);
+    last_fsm_page->SetNextPageId(new_fsm_page_id);
+    fsm_root->SetLastFsmPageId(new_fsm_page_id);
+    buffer_pool_manager_->UnpinPage(new_fsm_page_id, true);
+    fsm_page_id = new_fsm_page_id;
+  }
+  if (last_fsm_page != fsm_root) {
+    last_fsm_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_fsm_page_id, true);
+  }
+
+  std::scoped_lock fsm_lock(fsm_latch_);
+  fsm_slots_[table_page_id] = {fsm_page_id, slot_num};
+  return true;
+}
+
+void TableHeap::UpdateFreeSpace(page_id_t table_page_id, uint32_t free_space) {
+  FsmSlot slot;
+  {
+    std::scoped_lock fsm_lock(fsm_latch_);
+    auto it = fsm_slots_.find(table_page_id);
+    if (it == fsm_slots_.end()) {
+      return;
+    }
+    slot = it->second;
+  }
+  auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(slot.first));
+  if (fsm_page == nullptr) {
+    // The map is only a hint; a stale entry is corrected by the next insert that trips over it.
+    return;
+  }
+  fsm_page->WLatch();
+  bool is_dirty = fsm_page->SetFreeSpace(slot.second, free_space);
+  fsm_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(slot.first, is_dirty);
+}
+
+auto TableHeap::FindPageWithSpace(uint32_t required_space) -> page_id_t {
+  page_id_t start_page_id;
+  {
+    std::scoped_lock fsm_lock(fsm_latch_);
+    start_page_id = fsm_hint_page_id_ == INVALID_PAGE_ID ? fsm_page_id_ : fsm_hint_page_id_;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  // Search the FSM chain once, starting at the hint and wrapping around at the end.
+  auto fsm_page_id = start_page_id;
+  do {
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id));
+    if (fsm_page == nullptr) {
+      return INVALID_PAGE_ID;
+    }
+    fsm_page->RLatch();
+    uint32_t slot_num;
+    auto table_page_id = INVALID_PAGE_ID;
+    if (fsm_page->FindFreeSpace(required_space, &slot_num)) {
+      table_page_id = fsm_page->GetTablePageId(slot_num);
+    }
+    auto next_page_id = fsm_page->GetNextPageId();
+    fsm_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(fsm_page_id, false);
+
+    if (table_page_id != INVALID_PAGE_ID) {
+      std::scoped_lock fsm_lock(fsm_latch_);
+      fsm_hint_page_id_ = fsm_page_id;
+      return table_page_id;
+    }
+    fsm_page_id = next_page_id == INVALID_PAGE_ID ? fsm_page_id_ : next_page_id;
+  } while (fsm_page_id != start_page_id);
+  return INVALID_PAGE_ID;
+}
+
+void TableHeap::GetNextTablePageIds(page_id_t page_id, size_t max_pages, std::vector<page_id_t> *page_ids) {
+  FsmSlot slot;
+  {
+    std::scoped_lock fsm_lock(fsm_latch_);
+    auto it = fsm_slots_.find(page_id);
+    if (it == fsm_slots_.end()) {
+      return;
+    }
+    slot = it->second;
+  }
+
+  auto fsm_page_id = slot.first;
+  auto slot_num = slot.second + 1;
+  while (page_ids->size() < max_pages && fsm_page_id != INVALID_PAGE_ID) {
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id));
+    if (fsm_page == nullptr) {
+      return;
+    }
+    fsm_page->RLatch();
+    for (; slot_num < fsm_page->GetEntryCount() && page_ids->size() < max_pages; slot_num++) {
+      page_ids->push_back(fsm_page->GetTablePageId(slot_num));
+    }
+    auto next_page_id = fsm_page->GetNextPageId();
+    fsm_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(fsm_page_id, false);
+    fsm_page_id = next_page_id;
+    slot_num = 0;
+  }
+}
+
+auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
+  if (tuple.size_ + 32 > BUSTUB_PAGE_USABLE_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  cur_page->WLatch();
-
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      next_page->WLatch();
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+  // Ask the free space map for a page with room. The map may be stale, so every failed attempt corrects the entry of
+  // the page it tried; that page then drops below the required bucket, which guarantees the loop terminates.
+  auto required_space = TablePage::GetRequiredSpace(tuple);
+  auto page_id = FindPageWithSpace(required_space);
+  while (page_id != INVALID_PAGE_ID) {
+    auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (cur_page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
     }
+    cur_page->WLatch();
+    bool is_inserted = cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    auto free_space = cur_page->GetFreeSpaceRemaining();
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, is_inserted);
+    UpdateFreeSpace(page_id, free_space);
+    if (is_inserted) {
+      // Update the transaction's write set.
+      txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+      return true;
+    }
+    page_id = FindPageWithSpace(required_space);
+  }
+
+  // No tracked page has room, so we grow the table.
+  if (!AppendTuple(tuple, rid, txn)) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
+auto TableHeap::AppendTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
+  // The root FSM page latch serializes appends, so only one thread extends the table page chain at a time.
+  auto fsm_root = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id_));
+  if (fsm_root == nullptr) {
+    return false;
+  }
+  fsm_root->WLatch();
+
+  auto last_page_id = fsm_root->GetLastTablePageId();
+  auto last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
+  if (last_page == nullptr) {
+    fsm_root->WUnlatch();
+    buffer_pool_manager_->UnpinPage(fsm_page_id_, false);
+    return false;
+  }
+  last_page->WLatch();
+
+  // Another thread may have appended a page while we were waiting for the root latch.
+  if (last_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+    auto free_space = last_page->GetFreeSpaceRemaining();
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    fsm_root->WUnlatch();
+    buffer_pool_manager_->UnpinPage(fsm_page_id_, false);
+    UpdateFreeSpace(last_page_id, free_space);
+    return true;
+  }
+
+  page_id_t new_page_id;
+  auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&new_page_id, segment_id_));
+  // If we could not create a new page,
+  if (new_page == nullptr) {
+    // Then life sucks and we abort the transaction.
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id, false);
+    fsm_root->WUnlatch();
+    buffer_pool_manager_->UnpinPage(fsm_page_id_, false);
+    return false;
+  }
+  // Otherwise we were able to create a new page. We initialize it now.
+  new_page->WLatch();
+  last_page->SetNextPageId(new_page_id);
+  new_page->Init(new_page_id, BUSTUB_PAGE_USABLE_SIZE, last_page_id, log_manager_, txn);
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id, true);
+  bool is_inserted = new_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+  BUSTUB_ASSERT(is_inserted, "A tuple that fits in a page must fit in an empty page.");
+  auto free_space = new_page->GetFreeSpaceRemaining();
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+
+  fsm_root->SetLastTablePageId(new_page_id);
+  // The page is reachable through the chain even if it cannot be tracked; it just will not be offered to inserts.
+  TrackTablePage(fsm_root, new_page_id, free_space);
+  fsm_root->WUnlatch();
+  buffer_pool_manager_->UnpinPage(fsm_page_id_, true);
+  return is_inserted;
+}
+
 auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
@@ -122,8 +344,12 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   Tuple old_tuple;
   page->WLatch();
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  auto free_space = page->GetFreeSpaceRemaining();
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  if (is_updated) {
+    UpdateFreeSpace(rid.GetPageId(), free_space);
+  }
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
@@ -141,8 +367,10 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   /** Commented out to make compatible with p4; This is called only on commit or delete, which consequently unlocks the
    * tuple; so should be fine */
   // lock_manager_->Unlock(txn, rid);
+  auto free_space = page->GetFreeSpaceRemaining();
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  UpdateFreeSpace(rid.GetPageId(), free_space);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
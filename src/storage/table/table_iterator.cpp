@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 #include "common/exception.h"
 #include "concurrency/transaction.h"
@@ -39,7 +41,8 @@ auto TableIterator::operator->() -> Tuple * {
 
 auto TableIterator::operator++() -> TableIterator & {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page =
+      static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId(), AccessType::Scan));
   BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
 
   cur_page->RLatch();
@@ -47,7 +50,9 @@ auto TableIterator::operator++() -> TableIterator & {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page_id = cur_page->GetNextPageId();
+      ReadAhead(next_page_id);
+      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(next_page_id, AccessType::Scan));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
@@ -74,6 +79,44 @@ auto TableIterator::operator++() -> TableIterator & {
   return *this;
 }
 
+void TableIterator::ReadAhead(page_id_t page_id) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  // Never let the read-ahead of one scan take more than a quarter of the pool.
+  auto max_window = std::min<size_t>(TABLE_READAHEAD_MAX_PAGES, buffer_pool_manager->GetPoolSize() / 4);
+  if (max_window == 0) {
+    return;
+  }
+
+  size_t window;
+  page_id_t start_page_id;
+  if (readahead_window_ == 0 || ++pages_since_readahead_ > 2 * readahead_window_) {
+    // The scan just crossed its first page boundary, or it left the predicted pages: start over from here.
+    window = std::min<size_t>(TABLE_READAHEAD_MIN_PAGES, max_window);
+    start_page_id = page_id;
+  } else if (page_id == readahead_trigger_page_id_) {
+    // The scan caught up with the last window: issue the next one, twice as large, right behind it.
+    window = std::min(readahead_window_ * 2, max_window);
+    start_page_id = readahead_last_page_id_;
+  } else {
+    return;
+  }
+
+  std::vector<page_id_t> page_ids;
+  table_heap_->GetNextTablePageIds(start_page_id, window, &page_ids);
+  size_t issued = 0;
+  while (issued < page_ids.size() && buffer_pool_manager->PrefetchPage(page_ids[issued], AccessType::Scan)) {
+    issued++;
+  }
+  if (issued < page_ids.size()) {
+    // The pool is short of frames, back off.
+    window = std::max<size_t>(window / 2, 1);
+  }
+  readahead_window_ = window;
+  pages_since_readahead_ = 0;
+  readahead_trigger_page_id_ = issued > 0 ? page_ids[0] : INVALID_PAGE_ID;
+  readahead_last_page_id_ = issued > 0 ? page_ids[issued - 1] : INVALID_PAGE_ID;
+}
+
 auto TableIterator::operator++(int) -> TableIterator {
   TableIterator clone(*this);
   ++(*this);
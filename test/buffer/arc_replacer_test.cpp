@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: pages 10-13 are brought into frames 0-3 and land in T1. Page 11 is accessed again and moves to T2.
+  for (frame_id_t fid = 0; fid < 4; ++fid) {
+    arc_replacer.SetPageId(fid, 10 + fid);
+    arc_replacer.RecordAccess(fid);
+    arc_replacer.SetEvictable(fid, true);
+  }
+  arc_replacer.RecordAccess(1);
+  ASSERT_EQ(4, arc_replacer.Size());
+
+  // Scenario: T1 is above its target size of 0, so its LRU frame goes first and page 10 is remembered in B1.
+  frame_id_t value;
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ((std::vector<frame_id_t>{2, 3, 1}), arc_replacer.EvictionCandidates(4));
+
+  // Scenario: page 10 comes back while in B1. T1 was too small, so its target grows to 1 and the page goes to T2.
+  arc_replacer.SetPageId(0, 10);
+  arc_replacer.RecordAccess(0);
+  arc_replacer.SetEvictable(0, true);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: accesses by a scan never promote a page to T2.
+  arc_replacer.SetPageId(2, 14);
+  arc_replacer.RecordAccess(2, AccessType::Scan);
+  arc_replacer.RecordAccess(2, AccessType::Scan);
+  arc_replacer.SetEvictable(2, true);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+
+  // Scenario: page 11 comes back while in B2, which shrinks the target of T1 back to 0.
+  arc_replacer.SetPageId(1, 11);
+  arc_replacer.RecordAccess(1);
+  arc_replacer.SetEvictable(1, true);
+  ASSERT_EQ((std::vector<frame_id_t>{2, 0, 1}), arc_replacer.EvictionCandidates(4));
+
+  // Scenario: pinned frames are skipped, and removed frames are not remembered.
+  arc_replacer.SetEvictable(2, false);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  arc_replacer.Remove(1);
+  ASSERT_FALSE(arc_replacer.Evict(&value));
+  arc_replacer.SetEvictable(2, true);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(0, arc_replacer.Size());
+}
+
+}  // namespace bustub
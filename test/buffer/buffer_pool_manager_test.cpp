@@ -12,17 +12,26 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <memory>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
-TEST(BufferPoolManagerTest, DISABLED_BinaryDataTest) {
+TEST(BufferPoolManagerTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
   const size_t k = 5;
@@ -88,7 +97,7 @@ TEST(BufferPoolManagerTest, DISABLED_BinaryDataTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(BufferPoolManagerTest, DISABLED_SampleTest) {
+TEST(BufferPoolManagerTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
   const size_t k = 5;
@@ -144,4 +153,499 @@ TEST(BufferPoolManagerTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ShardedTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+  const size_t num_shards = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_shards);
+  EXPECT_EQ(num_shards, bpm->GetNumShards());
+
+  // Scenario: New pages are spread over the shards, and every page id is handed out exactly once.
+  std::vector<bool> seen(buffer_pool_size, false);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    ASSERT_LT(page_id_temp, static_cast<page_id_t>(buffer_pool_size));
+    EXPECT_FALSE(seen[page_id_temp]);
+    seen[page_id_temp] = true;
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+  }
+
+  // Scenario: Once every frame of every shard is pinned, we should not be able to create any new pages.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+
+  // Scenario: Threads working on pages of different shards should see their own data after eviction.
+  std::vector<std::thread> threads;
+  for (size_t shard = 0; shard < num_shards; ++shard) {
+    threads.emplace_back([bpm, shard] {
+      for (int round = 0; round < 10; ++round) {
+        for (size_t i = shard; i < buffer_pool_size; i += num_shards) {
+          auto *page = bpm->FetchPage(i);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(std::to_string(i), page->GetData());
+          page_id_t new_page_id;
+          auto *new_page = bpm->NewPage(&new_page_id);
+          if (new_page != nullptr) {
+            bpm->UnpinPage(new_page_id, false);
+          }
+          EXPECT_EQ(true, bpm->UnpinPage(i, false));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReplacerPolicyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  const size_t num_pages = 50;
+
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::LRUK, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TwoQueue, ReplacerPolicy::ClockPro}) {
+    for (size_t num_shards : {1, 2}) {
+      auto *disk_manager = new DiskManager(db_name);
+      auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_shards, policy);
+
+      // Scenario: Create many more pages than there are frames, so every policy has to evict.
+      page_id_t page_id_temp;
+      for (size_t i = 0; i < num_pages; ++i) {
+        auto *page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+      }
+
+      // Scenario: Mix repeated lookups of a few hot pages with a scan over all pages. Every page keeps its data.
+      for (int round = 0; round < 3; ++round) {
+        for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+          for (page_id_t hot = 0; hot < 3; ++hot) {
+            auto *page = bpm->FetchPage(hot, AccessType::Get);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(std::to_string(hot), page->GetData());
+            EXPECT_EQ(true, bpm->UnpinPage(hot, false, AccessType::Get));
+          }
+          auto *page = bpm->FetchPage(page_id, AccessType::Scan);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(std::to_string(page_id), page->GetData());
+          EXPECT_EQ(true, bpm->UnpinPage(page_id, false, AccessType::Scan));
+        }
+      }
+
+      // Scenario: Pinned pages are never evicted, whatever the policy.
+      std::vector<Page *> pinned;
+      for (size_t i = 0; i < buffer_pool_size; ++i) {
+        auto *page = bpm->FetchPage(i);
+        ASSERT_NE(nullptr, page);
+        pinned.push_back(page);
+      }
+      EXPECT_EQ(nullptr, bpm->FetchPage(num_pages - 1));
+      for (size_t i = 0; i < buffer_pool_size; ++i) {
+        EXPECT_EQ(static_cast<page_id_t>(i), pinned[i]->GetPageId());
+        EXPECT_EQ(true, bpm->UnpinPage(i, false));
+      }
+      EXPECT_TRUE(bpm->DeletePage(0));
+
+      disk_manager->ShutDown();
+      remove("test.db");
+
+      delete bpm;
+      delete disk_manager;
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 600;
+
+  for (bool use_huge_pages : {false, true}) {
+    bpm_use_huge_pages = use_huge_pages;
+    auto *disk_manager = new DiskManager(db_name, true);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    // Scenario: The frame data is one page-aligned array, and the metadata of each frame is cache-line aligned.
+    auto *pages = bpm->GetPages();
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages[i].GetData()) % BUSTUB_PAGE_SIZE);
+      EXPECT_EQ(pages[0].GetData() + i * BUSTUB_PAGE_SIZE, pages[i].GetData());
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&pages[i]) % CACHE_LINE_SIZE);
+    }
+
+    // Scenario: Pages read and written through the arena round-trip through disk, which bypasses the page cache.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, page->GetData()[BUSTUB_PAGE_SIZE - 1]);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    bpm->FlushAllPages();
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size * 2); ++page_id) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(page_id), page->GetData());
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+  bpm_use_huge_pages = true;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+  bpm->StartBackgroundFlusher(0.5, 0.2);
+
+  // Scenario: Dirtying every frame wakes the flusher, which writes pages back until only 20% are dirty.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (int i = 0; i < 100 && bpm->GetStats().dirty_pages_ > 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopBackgroundFlusher();
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.dirty_pages_);
+  EXPECT_EQ(8, stats.flusher_writes_);
+
+  // Scenario: The flusher cleaned the next victims first, so new pages never wait for a write back.
+  for (size_t i = 0; i < 5; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(5, stats.clean_evictions_);
+  EXPECT_EQ(0, stats.dirty_evictions_);
+
+  // Scenario: Pages that were flushed and evicted can be read back.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DeletePageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_shards = 2;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_shards);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 20; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(20, disk_manager->GetNumAllocatedPages());
+
+  // Scenario: Deleted pages are reused lowest first, whether they were resident or not, and stay in their shard.
+  EXPECT_NE(nullptr, bpm->FetchPage(4));
+  EXPECT_EQ(false, bpm->DeletePage(4));
+  EXPECT_EQ(true, bpm->UnpinPage(4, false));
+  for (page_id_t page_id : {0, 3, 4, 19}) {
+    EXPECT_EQ(true, bpm->DeletePage(page_id));
+  }
+  EXPECT_EQ(16, disk_manager->GetNumAllocatedPages());
+  std::vector<page_id_t> reused;
+  for (size_t i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    reused.push_back(page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  std::sort(reused.begin(), reused.end());
+  EXPECT_EQ((std::vector<page_id_t>{0, 3, 4, 19, 20}), reused);
+
+  // Scenario: Deleting a page twice or deleting a page that was never allocated does nothing.
+  EXPECT_EQ(true, bpm->DeletePage(7));
+  EXPECT_EQ(true, bpm->DeletePage(7));
+  EXPECT_EQ(true, bpm->DeletePage(100));
+  EXPECT_EQ(20, disk_manager->GetNumAllocatedPages());
+
+  // Scenario: After a flush, a new buffer pool on the same file reuses the free page of the second shard and starts the
+  // first shard after the highest allocated page.
+  bpm->FlushAllPages();
+  delete bpm;
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_shards);
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(22, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(7, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, SegmentTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_shards = 2;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_shards);
+  auto segment_id = bpm->CreateSegment();
+  ASSERT_NE(DEFAULT_SEGMENT_ID, segment_id);
+  auto first_page_id = DiskManager::GetFirstPageId(segment_id);
+
+  // Scenario: Pages of a segment are numbered from the first page id of the segment, independently of other pages.
+  page_id_t page_id_temp;
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 4; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp, segment_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  EXPECT_EQ((std::vector<page_id_t>{first_page_id, first_page_id + 1, first_page_id + 2, first_page_id + 3}), page_ids);
+  EXPECT_EQ(4, disk_manager->GetNumAllocatedPages(segment_id));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp, segment_id + 1));
+
+  // Scenario: A segment cannot be dropped while one of its pages is pinned, and is gone with all its pages after.
+  EXPECT_EQ(false, bpm->DropSegment(segment_id));
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(true, bpm->DropSegment(segment_id));
+  EXPECT_EQ(false, bpm->DropSegment(segment_id));
+  EXPECT_EQ(false, bpm->DropSegment(DEFAULT_SEGMENT_ID));
+  EXPECT_EQ(false, disk_manager->HasSegment(segment_id));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp, segment_id));
+
+  // Scenario: The dropped pages are not written back, and a segment created in their place starts out empty.
+  bpm->FlushAllPages();
+  EXPECT_EQ(segment_id, bpm->CreateSegment());
+  EXPECT_EQ(0, disk_manager->GetNumAllocatedPages(segment_id));
+  auto *page = bpm->NewPage(&page_id_temp, segment_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  EXPECT_EQ(true, bpm->DropSegment(segment_id));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: Prefetched pages are read in the background and can be fetched afterwards.
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+  for (page_id_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->PrefetchPage(i));
+  }
+  // Prefetching a resident page does nothing.
+  EXPECT_EQ(true, bpm->PrefetchPage(0));
+  EXPECT_EQ(5, bpm->GetStats().prefetch_reads_);
+  for (page_id_t i = 0; i < 5; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), page->GetData());
+  }
+
+  // Scenario: Prefetched pages that nobody pinned are evictable once their reads are done.
+  for (page_id_t i = 5; i < 10; ++i) {
+    EXPECT_EQ(true, bpm->PrefetchPage(i));
+  }
+  for (size_t i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: With every frame pinned, prefetches are dropped.
+  EXPECT_EQ(false, bpm->PrefetchPage(5));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ChecksumTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name, false, DiskSyncPolicy::OnFlush, true);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 4; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Corrupt pages 1 and 2 behind the disk manager's back.
+  int fd = open(db_name.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  char byte = 'X';
+  for (page_id_t page_id : {1, 2}) {
+    ASSERT_EQ(1, pwrite(fd, &byte, 1, DiskManager::GetPageOffset(page_id) + 10));
+  }
+  close(fd);
+
+  // Scenario: A page that fails its checksum cannot be fetched, and does not take up a frame.
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("0", page->GetData());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: The same goes for a prefetched page, and flushing does not stamp a fresh checksum over it.
+  EXPECT_EQ(true, bpm->PrefetchPage(2));
+  bpm->FlushAllPages();
+  EXPECT_EQ(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(nullptr, bpm->FetchPage(2));
+  page = bpm->FetchPage(3);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("3", page->GetData());
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(5, disk_manager->GetNumChecksumFailures());
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentHitTest) {
+  const size_t buffer_pool_size = 40;
+  const size_t num_pages = 60;
+  const size_t num_shards = 2;
+  const size_t num_threads = 4;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 5, nullptr, num_shards);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: Threads pinning a few hot pages without the latch, while others make the pool evict, always get the
+  // page they asked for, and the hits are counted.
+  auto hits_before = bpm->GetStats().hits_;
+  std::vector<std::thread> threads;
+  for (size_t thread_id = 0; thread_id < num_threads; ++thread_id) {
+    threads.emplace_back([&bpm, &page_ids, thread_id] {
+      std::mt19937 gen(thread_id);
+      for (int round = 0; round < 5000; ++round) {
+        // Half of the threads stay on the first pages, the others go through all of them.
+        auto index = thread_id % 2 == 0 ? gen() % 4 : gen() % num_pages;
+        auto page_id = page_ids[index];
+        auto *page = bpm->FetchPage(page_id, AccessType::Get);
+        ASSERT_NE(nullptr, page);
+        ASSERT_EQ(page_id, page->GetPageId());
+        ASSERT_EQ(std::to_string(page_id), page->GetData());
+        ASSERT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LT(hits_before, bpm->GetStats().hits_);
+
+  // Scenario: Every unpin made a frame evictable again, so the whole pool can be taken over by new pages.
+  EXPECT_EQ(false, bpm->UnpinPage(page_ids[0], false));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+}
+
 }  // namespace bustub
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer_test.cpp
+//
+// Identification: test/buffer/clock_pro_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/clock_pro_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ClockProReplacerTest, SampleTest) {
+  ClockProReplacer clock_pro_replacer(4);
+
+  // Scenario: pages 10-13 are brought into frames 0-3 as cold pages in their test period. Page 11 is accessed again.
+  for (frame_id_t fid = 0; fid < 4; ++fid) {
+    clock_pro_replacer.SetPageId(fid, 10 + fid);
+    clock_pro_replacer.RecordAccess(fid);
+    clock_pro_replacer.SetEvictable(fid, true);
+  }
+  clock_pro_replacer.RecordAccess(1);
+  ASSERT_EQ(4, clock_pro_replacer.Size());
+  ASSERT_EQ((std::vector<frame_id_t>{0, 2, 3, 1}), clock_pro_replacer.EvictionCandidates(4));
+
+  // Scenario: HAND_cold evicts unreferenced cold page 10, then promotes page 11, which was reaccessed during its test
+  // period, to hot and evicts page 12 instead.
+  frame_id_t value;
+  ASSERT_TRUE(clock_pro_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_TRUE(clock_pro_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+
+  // Scenario: page 10 comes back while still in its test period and turns hot right away. That leaves room for only
+  // one hot page, so page 11 is demoted.
+  clock_pro_replacer.SetPageId(0, 10);
+  clock_pro_replacer.RecordAccess(0);
+  clock_pro_replacer.SetEvictable(0, true);
+  ASSERT_TRUE(clock_pro_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_TRUE(clock_pro_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: a scan never sets the reference bit, so a scanned page stays cold and goes before hot page 10.
+  clock_pro_replacer.SetPageId(1, 20);
+  clock_pro_replacer.RecordAccess(1, AccessType::Scan);
+  clock_pro_replacer.RecordAccess(1, AccessType::Scan);
+  clock_pro_replacer.SetEvictable(1, true);
+  ASSERT_TRUE(clock_pro_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: once only hot pages are left, HAND_hot demotes one so that it can be evicted.
+  ASSERT_TRUE(clock_pro_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_FALSE(clock_pro_replacer.Evict(&value));
+  ASSERT_EQ(0, clock_pro_replacer.Size());
+}
+
+}  // namespace bustub
@@ -16,7 +16,7 @@
 
 namespace bustub {
 
-TEST(LRUKReplacerTest, DISABLED_SampleTest) {
+TEST(LRUKReplacerTest, SampleTest) {
   LRUKReplacer lru_replacer(7, 2);
 
   // Scenario: add six elements to the replacer. We have [1,2,3,4,5]. Frame 6 is non-evictable.
@@ -95,4 +95,111 @@ TEST(LRUKReplacerTest, DISABLED_SampleTest) {
   ASSERT_EQ(false, lru_replacer.Evict(&value));
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_replacer(6, 2);
+
+  // Scenario: frames 1 and 2 are hot pages with two accesses each, frame 3 has been looked up once.
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(3, AccessType::Get);
+
+  // Scenario: a scan brings in frames 4 and 5 and also passes over hot frame 1.
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  lru_replacer.RecordAccess(5, AccessType::Scan);
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  for (frame_id_t fid = 1; fid <= 5; ++fid) {
+    lru_replacer.SetEvictable(fid, true);
+  }
+  ASSERT_EQ(5, lru_replacer.Size());
+
+  // Scenario: the scanned frames go first, least recently scanned first, even though frame 3 has +inf k-distance.
+  frame_id_t value;
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(5, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+
+  // Scenario: the scan did not touch frame 1's history, so frame 1 still has the larger backward k-distance.
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: a scanned frame that is later accessed normally leaves the probationary group.
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  lru_replacer.RecordAccess(4, AccessType::Get);
+  lru_replacer.RecordAccess(4, AccessType::Get);
+  lru_replacer.RecordAccess(5, AccessType::Scan);
+  lru_replacer.SetEvictable(4, true);
+  lru_replacer.SetEvictable(5, true);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(5, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, RandomizedTest) {
+  const size_t num_frames = 50;
+  const size_t k = 3;
+  LRUKReplacer lru_replacer(num_frames, k);
+
+  // A straightforward model of LRU-K: every access timestamp of every tracked frame.
+  std::vector<std::vector<size_t>> history(num_frames);
+  std::vector<bool> evictable(num_frames, false);
+  size_t now = 0;
+  auto model_victim = [&]() -> frame_id_t {
+    frame_id_t victim = -1;
+    bool victim_inf = false;
+    size_t victim_ts = 0;
+    for (size_t fid = 0; fid < num_frames; ++fid) {
+      if (!evictable[fid]) {
+        continue;
+      }
+      bool inf = history[fid].size() < k;
+      size_t ts = inf ? history[fid].front() : history[fid][history[fid].size() - k];
+      if (victim == -1 || (inf && !victim_inf) || (inf == victim_inf && ts < victim_ts)) {
+        victim = static_cast<frame_id_t>(fid);
+        victim_inf = inf;
+        victim_ts = ts;
+      }
+    }
+    return victim;
+  };
+
+  // Scenario: random accesses, pins, unpins and evictions always pick the frame a linear scan would.
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<frame_id_t> frame_dist(0, num_frames - 1);
+  std::uniform_int_distribution<int> op_dist(0, 9);
+  for (int i = 0; i < 20000; ++i) {
+    auto fid = frame_dist(gen);
+    auto op = op_dist(gen);
+    if (op < 5) {
+      lru_replacer.RecordAccess(fid);
+      history[fid].push_back(now++);
+    } else if (op < 8) {
+      bool set_evictable = op != 7;
+      lru_replacer.SetEvictable(fid, set_evictable);
+      if (!history[fid].empty()) {
+        evictable[fid] = set_evictable;
+      }
+    } else {
+      frame_id_t value;
+      auto expected = model_victim();
+      ASSERT_EQ(expected != -1, lru_replacer.Evict(&value));
+      if (expected != -1) {
+        ASSERT_EQ(expected, value);
+        history[expected].clear();
+        evictable[expected] = false;
+      }
+    }
+    ASSERT_EQ(std::count(evictable.begin(), evictable.end(), true), lru_replacer.Size());
+  }
+}
 }  // namespace bustub
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  const size_t max_entries = 100;
+  const page_id_t num_shards = 4;
+  PageTable page_table(max_entries);
+
+  // Scenario: Pages of one shard, whose ids are all congruent modulo the number of shards, are found.
+  for (frame_id_t frame_id = 0; frame_id < static_cast<frame_id_t>(max_entries); ++frame_id) {
+    page_table.Insert(frame_id * num_shards + 1, frame_id);
+  }
+  EXPECT_EQ(max_entries, page_table.Size());
+  frame_id_t frame_id;
+  for (page_id_t i = 0; i < static_cast<page_id_t>(max_entries); ++i) {
+    ASSERT_TRUE(page_table.Find(i * num_shards + 1, &frame_id));
+    EXPECT_EQ(i, frame_id);
+    EXPECT_FALSE(page_table.Find(i * num_shards, &frame_id));
+  }
+
+  // Scenario: Removed pages are gone, and the others are still found behind their tombstones.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(max_entries); i += 2) {
+    EXPECT_TRUE(page_table.Remove(i * num_shards + 1));
+  }
+  EXPECT_FALSE(page_table.Remove(1));
+  EXPECT_EQ(max_entries / 2, page_table.Size());
+  for (page_id_t i = 0; i < static_cast<page_id_t>(max_entries); ++i) {
+    EXPECT_EQ(i % 2 == 1, page_table.Find(i * num_shards + 1, &frame_id));
+  }
+
+  // Scenario: Churning through many more pages than the table holds at once clears out the tombstones.
+  std::mt19937 gen(15445);
+  std::map<page_id_t, frame_id_t> expected;
+  page_table.ForEach([&](page_id_t page_id, frame_id_t frame_id) { expected[page_id] = frame_id; });
+  EXPECT_EQ(max_entries / 2, expected.size());
+  for (int round = 0; round < 10000; ++round) {
+    if (expected.size() == max_entries || (!expected.empty() && gen() % 2 == 0)) {
+      auto it = expected.begin();
+      std::advance(it, gen() % expected.size());
+      ASSERT_TRUE(page_table.Remove(it->first));
+      expected.erase(it);
+    } else {
+      auto page_id = static_cast<page_id_t>(gen() % 100000) * num_shards + 1;
+      if (expected.count(page_id) == 0) {
+        page_table.Insert(page_id, round);
+        expected[page_id] = round;
+      }
+    }
+  }
+  ASSERT_EQ(expected.size(), page_table.Size());
+  for (const auto &[page_id, frame_id] : expected) {
+    frame_id_t found;
+    ASSERT_TRUE(page_table.Find(page_id, &found));
+    EXPECT_EQ(frame_id, found);
+  }
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  const size_t max_entries = 64;
+  PageTable page_table(max_entries);
+  // Pages 0 to 31 stay in the table; the writer keeps moving the others in and out, with a frame id of its own.
+  for (page_id_t page_id = 0; page_id < 32; ++page_id) {
+    page_table.Insert(page_id, page_id);
+  }
+
+  // Scenario: Readers without a latch never see a wrong frame, while the writer moves pages and rebuilds the table.
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int thread_id = 0; thread_id < 4; ++thread_id) {
+    readers.emplace_back([&page_table, &stop] {
+      while (!stop) {
+        for (page_id_t page_id = 0; page_id < 1000; ++page_id) {
+          frame_id_t frame_id;
+          if (page_table.Find(page_id, &frame_id)) {
+            ASSERT_EQ(page_id < 32 ? page_id : page_id + 1000, frame_id);
+          }
+        }
+      }
+    });
+  }
+  for (int round = 0; round < 200; ++round) {
+    for (page_id_t page_id = 32; page_id < 1000; ++page_id) {
+      page_table.Insert(page_id, page_id + 1000);
+      ASSERT_TRUE(page_table.Remove(page_id));
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(32U, page_table.Size());
+}
+
+}  // namespace bustub
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/two_queue_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  // Eight frames: A1in keeps 2 frames before giving them up, A1out remembers 4 pages.
+  TwoQueueReplacer two_queue_replacer(8);
+
+  // Scenario: pages 100-103 are brought into frames 0-3 and enter A1in. Hitting frame 0 there does not move it.
+  for (frame_id_t fid = 0; fid < 4; ++fid) {
+    two_queue_replacer.SetPageId(fid, 100 + fid);
+    two_queue_replacer.RecordAccess(fid);
+    two_queue_replacer.SetEvictable(fid, true);
+  }
+  two_queue_replacer.RecordAccess(0);
+  ASSERT_EQ(4, two_queue_replacer.Size());
+
+  // Scenario: A1in is evicted in FIFO order, and the evicted pages are remembered in A1out.
+  frame_id_t value;
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 100 comes back while in A1out and is admitted to Am. Page 101 comes back through a scan, which
+  // does not prove reuse, so it enters A1in again.
+  two_queue_replacer.SetPageId(0, 100);
+  two_queue_replacer.RecordAccess(0);
+  two_queue_replacer.SetEvictable(0, true);
+  two_queue_replacer.SetPageId(1, 101);
+  two_queue_replacer.RecordAccess(1, AccessType::Scan);
+  two_queue_replacer.SetEvictable(1, true);
+
+  // Scenario: A1in gives up frames only while it holds more than its share, so Am is next once A1in is down to 2.
+  ASSERT_EQ((std::vector<frame_id_t>{2, 0, 3, 1}), two_queue_replacer.EvictionCandidates(8));
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_TRUE(two_queue_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+
+  // Scenario: pinned frames are never evicted.
+  two_queue_replacer.SetEvictable(1, false);
+  ASSERT_FALSE(two_queue_replacer.Evict(&value));
+  two_queue_replacer.SetEvictable(1, true);
+  two_queue_replacer.Remove(1);
+  ASSERT_EQ(0, two_queue_replacer.Size());
+}
+
+}  // namespace bustub
@@ -19,6 +19,7 @@
 #include "catalog/table_generator.h"
 #include "execution/executor_context.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -57,8 +58,7 @@ TEST(CatalogTest, DISABLED_CreateTable1) {
   const auto table_oid = table_info->oid_;
   EXPECT_NE(Catalog::NULL_TABLE_INFO, catalog->GetTable(table_oid));
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_CreateTable2) {
@@ -85,8 +85,7 @@ TEST(CatalogTest, DISABLED_CreateTable2) {
   // Subsequent attempt to create table with the same name should fail
   EXPECT_EQ(Catalog::NULL_TABLE_INFO, catalog->CreateTable(nullptr, table_name, schema));
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_CreateTable3) {
@@ -117,8 +116,7 @@ TEST(CatalogTest, DISABLED_CreateTable3) {
   EXPECT_EQ(table_info_0->oid_, table_info_1->oid_);
   EXPECT_EQ(table_info_0->name_, table_info_1->name_);
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_CreateTableTest) {
@@ -148,7 +146,8 @@ TEST(CatalogTest, DISABLED_CreateTableTest) {
 
   // Basic empty table attributes
   {
-    EXPECT_EQ(table_metadata->table_->GetFirstPageId(), 0);
+    // The table starts its own segment, the first one of a new database.
+    EXPECT_EQ(table_metadata->table_->GetFirstPageId(), DiskManager::GetFirstPageId(DEFAULT_SEGMENT_ID + 1));
     EXPECT_EQ(table_metadata->name_, table_name);
     EXPECT_EQ(table_metadata->schema_.GetColumnCount(), columns.size());
     for (std::size_t i = 0; i < columns.size(); ++i) {
@@ -213,8 +212,7 @@ TEST(CatalogTest, DISABLED_CreateIndex1) {
   const auto table_indexes2 = catalog->GetTableIndexes(table_name);
   EXPECT_EQ(table_indexes2.size(), 1);
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Attempts to create an index with duplicate name should fail
@@ -262,8 +260,7 @@ TEST(CatalogTest, DISABLED_CreateIndex2) {
   };
   EXPECT_EQ(Catalog::NULL_INDEX_INFO, create_index_f());
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_CreateIndex3) {
@@ -336,8 +333,7 @@ TEST(CatalogTest, DISABLED_QueryIndex1) {
   // Querying the table indexes should return our index
   EXPECT_NE(Catalog::NULL_INDEX_INFO, catalog->GetIndex(index_name, table_name));
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Vanilla index queries by index OID
@@ -386,8 +382,7 @@ TEST(CatalogTest, DISABLED_QueryIndex2) {
   // Information retrieved from the two queries should match
   EXPECT_EQ(index_info1->index_oid_, index_info2->index_oid_);
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Query for nonexistent index on table should fail
@@ -408,8 +403,7 @@ TEST(CatalogTest, DISABLED_FailedQuery1) {
 
   EXPECT_EQ(Catalog::NULL_INDEX_INFO, catalog->GetIndex("index1", table_name));
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Query for index on nonexistent table should fail
@@ -421,8 +415,7 @@ TEST(CatalogTest, DISABLED_FailedQuery2) {
 
   EXPECT_EQ(Catalog::NULL_INDEX_INFO, catalog->GetIndex("index1", "invalid_table"));
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Query for nonexistent index OID should throw
@@ -435,8 +428,7 @@ TEST(CatalogTest, DISABLED_FailedQuery3) {
   const index_oid_t bad_oid = 1337;
   EXPECT_EQ(Catalog::NULL_INDEX_INFO, catalog->GetIndex(bad_oid));
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Query for all indexes on nonexistent table should give empty collection
@@ -449,8 +441,7 @@ TEST(CatalogTest, DISABLED_FailedQuery4) {
   const auto indexes = catalog->GetTableIndexes("invalid_table");
   EXPECT_TRUE(indexes.empty());
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Query for all indexes on existing table with no
@@ -473,8 +464,7 @@ TEST(CatalogTest, DISABLED_FailedQuery5) {
   const auto indexes = catalog->GetTableIndexes(table_name);
   EXPECT_TRUE(indexes.empty());
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Should be able to create and interact with an index with a single BIGINT key
@@ -525,8 +515,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction0) {
   index->ScanKey(index_key, &results, txn.get());
   ASSERT_TRUE(results.empty());
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Should be able to create and interact with an index that is keyed by two INTEGER values
@@ -577,8 +566,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction1) {
   index->ScanKey(index_key, &results, txn.get());
   ASSERT_TRUE(results.empty());
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 // Should be able to create and interact with an index that is keyed by a single INTEGER column
@@ -629,8 +617,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction2) {
   index->ScanKey(index_key, &results, txn.get());
   ASSERT_TRUE(results.empty());
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_IndexInteraction3) {
@@ -684,8 +671,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   index->ScanKey(index_key, &results, txn.get());
   ASSERT_TRUE(results.empty());
 
-  remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveDatabase("catalog_test.db");
 }
 
 }  // namespace bustub
@@ -34,6 +34,7 @@
 #include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
 #include "test_util.h"  // NOLINT
 #include "type/value_factory.h"
 
@@ -48,7 +49,7 @@ class TransactionTest : public ::testing::Test {
   }
 
   // This function is called after every test.
-  void TearDown() override { remove("executor_test.db"); };
+  void TearDown() override { DiskManager::RemoveDatabase("executor_test.db"); };
 
   std::unique_ptr<BustubInstance> bustub_;
 };
@@ -36,15 +36,13 @@ class RecoveryTest : public ::testing::Test {
  protected:
   // This function is called before every test.
   void SetUp() override {
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveDatabase("test.db");
   }
 
   // This function is called after every test.
   void TearDown() override {
     LOG_INFO("Tearing down the system..");
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveDatabase("test.db");
   };
 };
 
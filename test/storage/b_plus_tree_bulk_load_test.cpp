@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sort.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using bustub::DiskManagerUnlimitedMemory;
+
+TEST(BPlusTreeTests, ExternalSortTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(8, disk_manager.get());
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 20000; key++) {
+    keys.push_back(key / 2);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+
+  {
+    // One page of memory makes for many runs, which take several merge passes with a buffer pool of 8 frames.
+    ExternalSort<GenericKey<8>, RID, GenericComparator<8>> sort(bpm, comparator, 1);
+    GenericKey<8> index_key;
+    for (size_t i = 0; i < keys.size(); i++) {
+      index_key.SetFromInteger(keys[i]);
+      sort.Add(index_key, RID(static_cast<page_id_t>(i), 0));
+    }
+    sort.Finish();
+    EXPECT_GT(sort.GetRunCount(), 4U);
+
+    std::pair<GenericKey<8>, RID> item;
+    size_t count = 0;
+    int64_t last_key = -1;
+    page_id_t last_position = -1;
+    while (sort.Next(&item)) {
+      auto key = item.first.ToString();
+      ASSERT_GE(key, last_key);
+      // Entries with equal keys keep the order they were added in.
+      if (key == last_key) {
+        ASSERT_GT(item.second.GetPageId(), last_position);
+      }
+      last_key = key;
+      last_position = item.second.GetPageId();
+      count++;
+    }
+    EXPECT_EQ(keys.size(), count);
+  }
+
+  // The runs are gone once the sort is, so the buffer pool is free again.
+  page_id_t page_id;
+  for (int i = 0; i < 8; i++) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (double fill_factor : {0.5, 0.9, 1.0}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto *bpm = new BufferPoolManager(50, disk_manager.get());
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 5,
+                                                             4);
+    GenericKey<8> index_key;
+    RID rid;
+
+    // Every key comes twice; only the first entry of a key makes it into the tree.
+    int64_t next_key = 1;
+    bool repeat = false;
+    ASSERT_TRUE(tree.BulkLoad(
+        [&](std::pair<GenericKey<8>, RID> *item) {
+          if (next_key > 3000) {
+            return false;
+          }
+          item->first.SetFromInteger(next_key);
+          item->second.Set(repeat ? -1 : 0, static_cast<uint32_t>(next_key));
+          next_key += repeat ? 1 : 0;
+          repeat = !repeat;
+          return true;
+        },
+        fill_factor));
+
+    std::vector<RID> rids;
+    for (int64_t key = 1; key <= 3000; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(0, rids[0].GetPageId());
+      EXPECT_EQ(key, rids[0].GetSlotNum());
+    }
+    int64_t current_key = 1;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+      current_key++;
+    }
+    EXPECT_EQ(3001, current_key);
+
+    // The tree has to be empty to be bulk loaded.
+    EXPECT_FALSE(tree.BulkLoad([](std::pair<GenericKey<8>, RID> * /* item */) { return false; }));
+
+    // Scenario: The loaded tree takes inserts and removes like any other, down to an empty tree.
+    for (int64_t key = 3001; key <= 4000; key++) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.Insert(index_key, rid));
+    }
+    std::vector<int64_t> keys;
+    for (int64_t key = 1; key <= 4000; key++) {
+      keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+      rids.clear();
+      ASSERT_FALSE(tree.GetValue(index_key, &rids));
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+  }
+}
+
+TEST(BPlusTreeTests, BulkLoadSmallTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // Sizes around the capacity of a leaf end up in one or two leaves.
+  for (int64_t size = 0; size <= 12; size++) {
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 5, 4);
+    int64_t next_key = 0;
+    ASSERT_TRUE(tree.BulkLoad([&](std::pair<GenericKey<8>, RID> *item) {
+      if (next_key == size) {
+        return false;
+      }
+      item->first.SetFromInteger(next_key);
+      item->second.Set(0, static_cast<uint32_t>(next_key));
+      next_key++;
+      return true;
+    }));
+    EXPECT_EQ(size == 0, tree.IsEmpty());
+
+    int64_t current_key = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+      current_key++;
+    }
+    EXPECT_EQ(size, current_key);
+
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < size; key++) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+    bpm->UnpinPage(page_id, true);
+  }
+  delete bpm;
+}
+}  // namespace bustub
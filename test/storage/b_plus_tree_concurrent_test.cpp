@@ -10,9 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <memory>
 #include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager.h"
@@ -122,7 +125,7 @@ void LookupHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, con
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -170,7 +173,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -217,7 +220,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -256,7 +259,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -295,7 +298,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest1) {
+TEST(BPlusTreeConcurrentTest, MixTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -336,7 +339,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest1) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest2) {
+TEST(BPlusTreeConcurrentTest, MixTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -402,4 +405,286 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest2) {
   delete bpm;
 }
 
+TEST(BPlusTreeConcurrentTest, MixTest3) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree with small pages, so that the pages optimistic readers look at split and merge all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 4);
+
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  for (int64_t i = 1; i <= 500; i++) {
+    if (i % 5 == 0) {
+      perserved_keys.push_back(i);
+    } else {
+      dynamic_keys.push_back(i);
+    }
+  }
+  InsertHelper(&tree, perserved_keys, 1);
+
+  // Writers insert and remove the other keys over and over while readers look up the preserved ones.
+  auto write_task = [&](int tid) {
+    for (int round = 0; round < 5; round++) {
+      InsertHelper(&tree, dynamic_keys, tid);
+      DeleteHelper(&tree, dynamic_keys, tid);
+    }
+  };
+  auto lookup_task = [&](int tid) {
+    for (int round = 0; round < 10; round++) {
+      LookupHelper(&tree, perserved_keys, tid);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back(i % 2 == 0 ? std::function<void(int)>(write_task) : std::function<void(int)>(lookup_task), i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  size_t size = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    EXPECT_EQ(0, (*iter).first.ToString() % 5);
+    size++;
+  }
+  EXPECT_EQ(size, perserved_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, BatchTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree with small pages, so that the paths that batches reuse change all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 4);
+
+  std::vector<std::pair<GenericKey<8>, RID>> perserved_items;
+  std::vector<std::pair<GenericKey<8>, RID>> dynamic_items;
+  for (int64_t i = 1; i <= 500; i++) {
+    auto &items = i % 5 == 0 ? perserved_items : dynamic_items;
+    items.emplace_back();
+    items.back().first.SetFromInteger(i);
+    items.back().second.Set(0, static_cast<uint32_t>(i));
+  }
+  tree.InsertBatch(perserved_items);
+  std::vector<GenericKey<8>> perserved_keys;
+  for (const auto &item : perserved_items) {
+    perserved_keys.push_back(item.first);
+  }
+
+  // Writers insert the other keys in batches and remove them one by one, while readers look up the preserved ones in
+  // batches.
+  auto write_task = [&](int /* tid */) {
+    for (int round = 0; round < 5; round++) {
+      tree.InsertBatch(dynamic_items);
+      for (const auto &item : dynamic_items) {
+        tree.Remove(item.first);
+      }
+    }
+  };
+  auto lookup_task = [&](int /* tid */) {
+    std::vector<std::vector<RID>> results;
+    for (int round = 0; round < 10; round++) {
+      ASSERT_EQ(perserved_keys.size(), tree.GetValues(perserved_keys, &results));
+      for (size_t i = 0; i < perserved_keys.size(); i++) {
+        ASSERT_EQ(1, results[i].size());
+        ASSERT_EQ(perserved_items[i].second, results[i][0]);
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back(i % 2 == 0 ? std::function<void(int)>(write_task) : std::function<void(int)>(lookup_task), i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  size_t size = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    EXPECT_EQ(0, (*iter).first.ToString() % 5);
+    size++;
+  }
+  EXPECT_EQ(size, perserved_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, ReclaimWhileReadingTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree with small pages, so that removing most keys frees most pages
+  auto tree = std::make_unique<BPlusTree<GenericKey<8>, RID, GenericComparator<8>>>("foo_pk", page_id, bpm,
+                                                                                     comparator, 3, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  for (int64_t key = 1; key <= 1000; key++) {
+    index_key.SetFromInteger(key);
+    rid.Set(0, static_cast<uint32_t>(key));
+    tree->Insert(index_key, rid);
+  }
+  auto num_pages = [&] { return disk_manager->GetNumAllocatedPages(DEFAULT_SEGMENT_ID); };
+  size_t full_pages = num_pages();
+
+  // Readers look up the keys that stay without a break, while the other keys are removed.
+  std::atomic<bool> stop{false};
+  auto lookup_task = [&](int /* tid */) {
+    std::vector<GenericKey<8>> keys(10);
+    for (int64_t i = 0; i < 10; i++) {
+      keys[i].SetFromInteger((i + 1) * 100);
+    }
+    std::vector<std::vector<RID>> results;
+    while (!stop) {
+      ASSERT_EQ(keys.size(), tree->GetValues(keys, &results));
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back(lookup_task, i);
+  }
+  for (int64_t key = 1; key <= 1000; key++) {
+    if (key % 100 != 0) {
+      index_key.SetFromInteger(key);
+      tree->Remove(index_key);
+    }
+  }
+
+  // Scenario: The pages that left the tree are deleted while the readers keep going, once the readers that may have
+  // seen them are done.
+  bool reclaimed = false;
+  for (int i = 0; i < 1000 && !reclaimed; i++) {
+    reclaimed = num_pages() < full_pages / 4;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(reclaimed);
+
+  tree = nullptr;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, ReverseScanTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree with small pages, so that the leaves that reverse scans step back to split and merge all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 4);
+
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  for (int64_t i = 1; i <= 500; i++) {
+    if (i % 5 == 0) {
+      perserved_keys.push_back(i);
+    } else {
+      dynamic_keys.push_back(i);
+    }
+  }
+  InsertHelper(&tree, perserved_keys, 1);
+
+  // Writers insert and remove the other keys over and over while readers scan the tree forwards and backwards, which
+  // latches leaves against the order writers latch them in. Every scan sees the preserved keys, in order.
+  auto write_task = [&](int tid) {
+    for (int round = 0; round < 5; round++) {
+      InsertHelper(&tree, dynamic_keys, tid);
+      DeleteHelper(&tree, dynamic_keys, tid);
+    }
+  };
+  auto scan_task = [&](int tid) {
+    for (int round = 0; round < 20; round++) {
+      std::vector<int64_t> keys;
+      if (round % 3 == 0) {
+        for (auto iter = tree.RBegin(); iter != tree.End(); ++iter) {
+          keys.push_back((*iter).first.ToString());
+        }
+      } else if (round % 3 == 1) {
+        tree.ScanRange(
+            std::nullopt, std::nullopt,
+            [&keys](const std::pair<GenericKey<8>, RID> *items, size_t size) {
+              for (size_t i = 0; i < size; i++) {
+                keys.push_back(items[i].first.ToString());
+              }
+              return true;
+            },
+            true);
+      } else {
+        for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+          keys.push_back((*iter).first.ToString());
+        }
+        std::reverse(keys.begin(), keys.end());
+      }
+      std::vector<int64_t> seen;
+      for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_TRUE(i == 0 || keys[i - 1] > keys[i]) << tid << " " << round;
+        if (keys[i] % 5 == 0) {
+          seen.push_back(keys[i]);
+        }
+      }
+      std::reverse(seen.begin(), seen.end());
+      ASSERT_EQ(perserved_keys, seen) << tid << " " << round;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back(i % 2 == 0 ? std::function<void(int)>(write_task) : std::function<void(int)>(scan_task), i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  size_t size = 0;
+  for (auto iter = tree.RBegin(); iter != tree.End(); ++iter) {
+    EXPECT_EQ(perserved_keys[perserved_keys.size() - 1 - size], (*iter).first.ToString());
+    size++;
+  }
+  EXPECT_EQ(size, perserved_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -12,18 +12,23 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
 using bustub::DiskManagerUnlimitedMemory;
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -90,7 +95,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   delete bpm;
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -156,4 +161,320 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   delete transaction;
   delete bpm;
 }
+
+TEST(BPlusTreeTests, DeleteScaleTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree with small pages, so that leaves and internal pages split, merge and redistribute a lot
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 4);
+  GenericKey<8> index_key;
+  RID rid;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    keys.push_back(key);
+  }
+  auto rng = std::default_random_engine{};
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, rid));
+  }
+  index_key.SetFromInteger(keys[0]);
+  EXPECT_FALSE(tree.Insert(index_key, rid));
+
+  // Remove every other key in random order, then check the rest with lookups and a full scan.
+  std::vector<int64_t> remove_keys;
+  for (auto key : keys) {
+    if (key % 2 == 0) {
+      remove_keys.push_back(key);
+    }
+  }
+  for (auto key : remove_keys) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 2 == 1, tree.GetValue(index_key, &rids));
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key += 2;
+  }
+  EXPECT_EQ(2001, current_key);
+
+  // Scenario: Removing all keys leaves an empty tree that can grow again.
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_TRUE(tree.Begin() == tree.End());
+  index_key.SetFromInteger(42);
+  rid.Set(0, 42);
+  EXPECT_TRUE(tree.Insert(index_key, rid));
+  rids.clear();
+  EXPECT_TRUE(tree.GetValue(index_key, &rids));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+/** Insert and remove keys in random order in a tree that asks for the EYTZINGER layout of its internal pages. */
+template <size_t KeySize>
+void CheckEytzingerLayout(int internal_max_size) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<KeySize> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>> tree(
+      "foo_pk", page_id, bpm.get(), comparator, 3, internal_max_size, InternalPageLayout::EYTZINGER);
+  GenericKey<KeySize> index_key;
+  RID rid;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 3000; key++) {
+    keys.push_back(key);
+  }
+  auto rng = std::default_random_engine{};
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, rid));
+  }
+
+  {
+    using InternalPage = BPlusTreeInternalPage<GenericKey<KeySize>, page_id_t, GenericComparator<KeySize>>;
+    auto guard = bpm->FetchPageRead(tree.GetRootPageId());
+    ASSERT_FALSE(guard.template As<BPlusTreePage>()->IsLeafPage());
+    EXPECT_EQ(InternalPageLayout::EYTZINGER, guard.template As<InternalPage>()->GetLayout());
+  }
+
+  // Remove every third key, so the pages merge and redistribute and the summaries have to follow.
+  for (auto key : keys) {
+    if (key % 3 == 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 0; key <= 3001; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(key % 3 != 0 && key <= 3000, tree.GetValue(index_key, &rids)) << KeySize << " " << key;
+    if (!rids.empty()) {
+      EXPECT_EQ(key, rids[0].GetSlotNum());
+    }
+  }
+  bpm->UnpinPage(page_id, true);
+}
+
+/** Check that a tree with keys of KeySize bytes refuses to lay out its internal pages EYTZINGER. */
+template <size_t KeySize>
+void CheckEytzingerLayoutRejected() {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<KeySize> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  using Tree = BPlusTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>>;
+  EXPECT_THROW(Tree("foo_pk", page_id, bpm.get(), comparator, 3, 40, InternalPageLayout::EYTZINGER), Exception);
+  bpm->UnpinPage(page_id, false);
+}
+
+TEST(BPlusTreeTests, EytzingerLayoutTest) {
+  // Scenario: Lookups find the same keys as with sorted pages, for keys searched as integers.
+  CheckEytzingerLayout<8>(40);
+  // Scenario: Trees with wider keys refuse the EYTZINGER layout, since the summary would cost them half their entries.
+  CheckEytzingerLayoutRejected<16>();
+  CheckEytzingerLayoutRejected<64>();
+  // Scenario: The summary takes room from the entries, and trees asking for more entries get what fits.
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+  EXPECT_LT(InternalPage::Capacity(InternalPageLayout::EYTZINGER), InternalPage::Capacity(InternalPageLayout::SORTED));
+  CheckEytzingerLayout<8>(InternalPage::Capacity(InternalPageLayout::SORTED));
+}
+
+TEST(BPlusTreeTests, ReverseIteratorTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm.get(), comparator, 3, 4);
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  GenericKey<8> index_key;
+  RID rid;
+
+  // Scenario: An empty tree has no keys backwards either.
+  EXPECT_EQ(tree.End(), tree.RBegin());
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+  for (auto key : keys) {
+    rid.Set(0, static_cast<uint32_t>(key));
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, rid));
+  }
+  // Remove every third key, so that leaves merge and redistribute, and some separator keys are no longer keys.
+  for (auto key : keys) {
+    if (key % 3 == 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+  }
+  std::vector<int64_t> expected;
+  for (int64_t key = 1; key <= 2000; key++) {
+    if (key % 3 != 0) {
+      expected.push_back(key);
+    }
+  }
+
+  // Scenario: Every leaf links back to the leaf that links to it, through splits and merges.
+  {
+    auto guard = bpm->FetchPageRead(tree.GetRootPageId());
+    while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+      guard = bpm->FetchPageRead(guard.As<InternalPage>()->ValueAt(0));
+    }
+    EXPECT_EQ(INVALID_PAGE_ID, guard.As<LeafPage>()->GetPrevPageId());
+    while (guard.As<LeafPage>()->GetNextPageId() != INVALID_PAGE_ID) {
+      page_id_t prev_page_id = guard.PageId();
+      guard = bpm->FetchPageRead(guard.As<LeafPage>()->GetNextPageId());
+      ASSERT_EQ(prev_page_id, guard.As<LeafPage>()->GetPrevPageId());
+    }
+  }
+
+  // Scenario: The reverse iterator goes through all keys backwards, from the end or from any key on.
+  std::vector<int64_t> reversed;
+  for (auto iter = tree.RBegin(); iter != tree.End(); ++iter) {
+    reversed.push_back((*iter).first.ToString());
+    EXPECT_EQ(reversed.back(), (*iter).second.GetSlotNum());
+  }
+  EXPECT_EQ(std::vector<int64_t>(expected.rbegin(), expected.rend()), reversed);
+  for (int64_t start = -1; start <= 2002; start += 7) {
+    index_key.SetFromInteger(start);
+    auto iter = tree.RBegin(index_key);
+    auto expected_iter = std::upper_bound(expected.begin(), expected.end(), start);
+    while (expected_iter != expected.begin()) {
+      --expected_iter;
+      ASSERT_NE(tree.End(), iter) << start;
+      ASSERT_EQ(*expected_iter, (*iter).first.ToString()) << start;
+      ++iter;
+    }
+    EXPECT_EQ(tree.End(), iter) << start;
+  }
+  bpm->UnpinPage(page_id, true);
+}
+
+TEST(BPlusTreeTests, CompressedLeafDeleteTest) {
+  auto key_schema = ParseCreateStatement("a varchar(60)");
+  GenericComparator<64> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", page_id, bpm.get(), comparator);
+  using InternalPage = BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+  using LeafPage = BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+  auto make_key = [&](const std::string &value) {
+    GenericKey<64> key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(value)}, key_schema.get()), *key_schema);
+    return key;
+  };
+
+  // Runs of keys that only differ in their last bytes, so that leaves hold twice as many of them, between runs of
+  // random keys that do not fit in a leaf with a run once it is short of entries.
+  std::map<std::string, uint32_t> keys;
+  std::default_random_engine rng;
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<int> length(20, 46);
+  for (char run = 'b'; run <= 'y'; run += 2) {
+    for (int i = 0; i < 300; i++) {
+      std::string key = std::string(1, run) + std::string(41, 'x') + std::to_string(1000 + i);
+      keys.emplace(key, keys.size());
+    }
+    for (int i = 0; i < 100; i++) {
+      std::string key(length(rng), ' ');
+      std::generate(key.begin(), key.end(), [&]() { return static_cast<char>(letter(rng)); });
+      key[0] = static_cast<char>(run + 1);
+      keys.emplace(key, keys.size());
+    }
+  }
+  std::vector<std::string> order;
+  for (const auto &[key, slot] : keys) {
+    order.push_back(key);
+  }
+  std::shuffle(order.begin(), order.end(), rng);
+  for (const auto &key : order) {
+    ASSERT_TRUE(tree.Insert(make_key(key), RID(0, keys[key])));
+  }
+
+  auto check_leaves = [&]() {
+    auto guard = bpm->FetchPageRead(tree.GetRootPageId());
+    while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+      guard = bpm->FetchPageRead(guard.As<InternalPage>()->ValueAt(0));
+    }
+    if (guard.PageId() == tree.GetRootPageId()) {
+      return;
+    }
+    size_t size = 0;
+    while (true) {
+      const auto *leaf = guard.As<LeafPage>();
+      ASSERT_GT(leaf->GetSize(), 0);
+      ASSERT_GE(leaf->GetSize(), leaf->GetMinSize());
+      size += leaf->GetSize();
+      if (leaf->GetNextPageId() == INVALID_PAGE_ID) {
+        break;
+      }
+      guard = bpm->FetchPageRead(leaf->GetNextPageId());
+    }
+    EXPECT_EQ(keys.size(), size);
+  };
+
+  // Scenario: Removing keys in random order merges leaves or shares the entries of two leaves, and never leaves a leaf
+  // empty or short of entries, however many entries its sibling can take.
+  std::shuffle(order.begin(), order.end(), rng);
+  for (size_t i = 0; i < order.size(); i++) {
+    tree.Remove(make_key(order[i]));
+    keys.erase(order[i]);
+    if (i % 100 == 0) {
+      check_leaves();
+      std::vector<uint32_t> expected;
+      for (const auto &[key, slot] : keys) {
+        expected.push_back(slot);
+      }
+      std::vector<uint32_t> scanned;
+      for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+        scanned.push_back((*iter).second.GetSlotNum());
+      }
+      ASSERT_EQ(expected, scanned);
+    }
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  bpm->UnpinPage(page_id, true);
+}
+
 }  // namespace bustub
@@ -0,0 +1,269 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_index_test.cpp
+//
+// Identification: test/storage/b_plus_tree_index_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction.h"
+#include "execution/executor_context.h"
+#include "execution/executors/index_scan_executor.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/key_encoder.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** A table of people whose ids repeat every 10 rows, indexed by (name, id). */
+class BPlusTreeIndexTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    disk_manager_ = std::make_unique<DiskManagerUnlimitedMemory>();
+    bpm_ = std::make_unique<BufferPoolManager>(50, disk_manager_.get());
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), nullptr, nullptr);
+    table_info_ = catalog_->CreateTable(&txn_, "people", schema_);
+    for (int32_t id = 0; id < 500; id++) {
+      rids_.push_back(Insert(id % 10, Name(id)));
+    }
+    index_info_ = catalog_->CreateIndex(&txn_, "people_name_id", "people", schema_, key_schema_, {1, 0});
+    ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info_);
+  }
+
+  static auto Name(int32_t id) -> std::string { return "person " + std::to_string(id); }
+
+  auto Insert(int32_t id, const std::string &name) -> RID {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(name)};
+    RID rid;
+    EXPECT_TRUE(table_info_->table_->InsertTuple(Tuple(values, &schema_), &rid, &txn_));
+    return rid;
+  }
+
+  auto Key(const std::string &name, int32_t id) -> Tuple {
+    return Tuple({ValueFactory::GetVarcharValue(name), ValueFactory::GetIntegerValue(id)}, &key_schema_);
+  }
+
+  auto ScanAll() -> std::vector<RID> {
+    std::vector<RID> all;
+    index_info_->index_->ScanAll(&all, &txn_);
+    return all;
+  }
+
+  auto ScanAllReversed() -> std::vector<RID> {
+    auto all = ScanAll();
+    return {all.rbegin(), all.rend()};
+  }
+
+  auto Scan(const IndexScanPlanNode &plan) -> std::vector<RID> {
+    ExecutorContext exec_ctx(&txn_, catalog_.get(), bpm_.get(), nullptr, nullptr);
+    IndexScanExecutor executor(&exec_ctx, &plan);
+    executor.Init();
+    std::vector<RID> scanned;
+    Tuple tuple;
+    RID rid;
+    while (executor.Next(&tuple, &rid)) {
+      scanned.push_back(rid);
+    }
+    return scanned;
+  }
+
+  auto NameAt(const RID &rid) -> std::string {
+    Tuple tuple;
+    EXPECT_TRUE(table_info_->table_->GetTuple(rid, &tuple, &txn_));
+    return tuple.GetValue(&schema_, 1).ToString();
+  }
+
+  std::unique_ptr<DiskManagerUnlimitedMemory> disk_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<Catalog> catalog_;
+  Transaction txn_{0};
+  Schema schema_{std::vector<Column>{Column("id", TypeId::INTEGER), Column("name", TypeId::VARCHAR, 20)}};
+  Schema key_schema_{Schema::CopySchema(&schema_, {1, 0})};
+  TableInfo *table_info_;
+  IndexInfo *index_info_;
+  std::vector<RID> rids_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, CompositeKeyTest) {
+  // The name takes a flag byte and 3 groups of 8 characters and a marker, the id 4 bytes, so it is a GenericKey<32>.
+  EXPECT_EQ(32U, KeyEncoder::EncodedSize(key_schema_));
+  EXPECT_EQ(32U, index_info_->key_size_);
+
+  // Scenario: Keys added while the index is built and afterwards are both found.
+  rids_.push_back(Insert(3, Name(500)));
+  std::vector<Value> late_values{ValueFactory::GetIntegerValue(3), ValueFactory::GetVarcharValue(Name(500))};
+  index_info_->index_->InsertEntry(Tuple(late_values, &schema_).KeyFromTuple(schema_, key_schema_, {1, 0}),
+                                   rids_.back(), &txn_);
+  for (int32_t id = 0; id <= 500; id++) {
+    std::vector<RID> result;
+    index_info_->index_->ScanKey(Key(Name(id), id == 500 ? 3 : id % 10), &result, &txn_);
+    ASSERT_EQ(1U, result.size()) << id;
+    EXPECT_EQ(rids_[id], result[0]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, MissingKeyTest) {
+  // Scenario: A name with a different id, or a prefix of a name, is not a key.
+  for (const auto &key : {Key("person 12", 3), Key("person 1", 0), Key("person ", 0)}) {
+    std::vector<RID> result;
+    index_info_->index_->ScanKey(key, &result, &txn_);
+    EXPECT_TRUE(result.empty());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, ScanAllTest) {
+  // Scenario: A full scan returns the entries ordered by name.
+  auto all = ScanAll();
+  ASSERT_EQ(rids_.size(), all.size());
+  std::string last_name;
+  for (const auto &rid : all) {
+    auto name = NameAt(rid);
+    EXPECT_LT(last_name, name);
+    last_name = name;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, ScanRangeBatchTest) {
+  // Scenario: Scanning one batch at a time returns the same entries as a full scan, over more than one batch.
+  std::vector<RID> batched;
+  IndexScanCursor cursor;
+  int batches = 0;
+  while (index_info_->index_->ScanRangeBatch(nullptr, nullptr, false, &cursor, &batched, &txn_)) {
+    batches++;
+  }
+  EXPECT_EQ(ScanAll(), batched);
+  EXPECT_LT(1, batches);
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, IndexScanExecutorTest) {
+  // Scenario: An index scan, which fetches the batches as it goes, returns the entries of a full scan.
+  EXPECT_EQ(ScanAll(), Scan(IndexScanPlanNode(std::make_shared<const Schema>(schema_), index_info_->index_oid_)));
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, ReverseScanRangeTest) {
+  // Scenario: A reverse scan returns the entries of a full scan backwards.
+  std::vector<RID> reversed;
+  index_info_->index_->ScanRange(nullptr, nullptr, &reversed, true, &txn_);
+  EXPECT_EQ(ScanAllReversed(), reversed);
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, ReverseScanRangeBatchTest) {
+  // Scenario: Scanning backwards one batch at a time returns the entries of a full scan backwards.
+  std::vector<RID> reversed;
+  IndexScanCursor cursor;
+  while (index_info_->index_->ScanRangeBatch(nullptr, nullptr, true, &cursor, &reversed, &txn_)) {
+  }
+  EXPECT_EQ(ScanAllReversed(), reversed);
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, ReverseIndexScanExecutorTest) {
+  // Scenario: A reverse index scan returns the entries of a full scan backwards.
+  EXPECT_EQ(ScanAllReversed(),
+            Scan(IndexScanPlanNode(std::make_shared<const Schema>(schema_), index_info_->index_oid_, {}, true)));
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, ReverseScanRangeBoundsTest) {
+  // Scenario: A reverse scan between two keys starts at the greater one and stops at the lesser one, both included.
+  Tuple lo = Key("person 200", 0);
+  Tuple hi = Key("person 300", 0);
+  std::vector<RID> reversed;
+  index_info_->index_->ScanRange(&lo, &hi, &reversed, true, &txn_);
+  std::vector<std::string> names;
+  for (const auto &rid : reversed) {
+    names.push_back(NameAt(rid));
+  }
+  ASSERT_FALSE(names.empty());
+  EXPECT_EQ("person 300", names.front());
+  EXPECT_EQ("person 200", names.back());
+  EXPECT_TRUE(std::is_sorted(names.rbegin(), names.rend()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, NulKeyTest) {
+  // Scenario: Names made of 0 bytes, as long as their column allows, are keys like any other.
+  std::vector<std::string> names{std::string(20, '\0'), std::string("person\0", 7), std::string(19, '\0') + "x"};
+  for (const auto &name : names) {
+    rids_.push_back(Insert(0, name));
+    index_info_->index_->InsertEntry(Key(name, 0), rids_.back(), &txn_);
+  }
+  for (size_t i = 0; i < names.size(); i++) {
+    std::vector<RID> result;
+    index_info_->index_->ScanKey(Key(names[i], 0), &result, &txn_);
+    ASSERT_EQ(1U, result.size()) << i;
+    EXPECT_EQ(rids_[rids_.size() - names.size() + i], result[0]);
+  }
+  EXPECT_EQ(rids_.size(), ScanAll().size());
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, DefaultVarcharKeyTest) {
+  // Scenario: An index can be created on a varchar of the default length, and holds the longest names it allows.
+  Schema long_schema{std::vector<Column>{Column("name", TypeId::VARCHAR, VARCHAR_DEFAULT_LENGTH)}};
+  auto *long_table = catalog_->CreateTable(&txn_, "long", long_schema);
+  std::vector<std::string> names{std::string(VARCHAR_DEFAULT_LENGTH, 'x'), std::string(VARCHAR_DEFAULT_LENGTH, '\0')};
+  std::vector<RID> rids;
+  for (const auto &name : names) {
+    RID rid;
+    ASSERT_TRUE(long_table->table_->InsertTuple(Tuple({ValueFactory::GetVarcharValue(name)}, &long_schema), &rid,
+                                                &txn_));
+    rids.push_back(rid);
+  }
+  auto long_key_schema = Schema::CopySchema(&long_schema, {0});
+  auto *long_index = catalog_->CreateIndex(&txn_, "long_name", "long", long_schema, long_key_schema, {0});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, long_index);
+  EXPECT_EQ(256U, long_index->key_size_);
+  for (size_t i = 0; i < names.size(); i++) {
+    std::vector<RID> result;
+    long_index->index_->ScanKey(Tuple({ValueFactory::GetVarcharValue(names[i])}, &long_key_schema), &result, &txn_);
+    ASSERT_EQ(1U, result.size()) << i;
+    EXPECT_EQ(rids[i], result[0]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, EytzingerLayoutTest) {
+  // Scenario: An index with keys wider than 8 bytes cannot lay out its internal pages EYTZINGER, one on integers can.
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO, catalog_->CreateIndex(&txn_, "people_eytzinger", "people", schema_, key_schema_,
+                                                            {1, 0}, InternalPageLayout::EYTZINGER));
+  Schema ids_schema{std::vector<Column>{Column("id", TypeId::INTEGER)}};
+  catalog_->CreateTable(&txn_, "ids", ids_schema);
+  auto ids_key_schema = Schema::CopySchema(&ids_schema, {0});
+  auto *ids_index = catalog_->CreateIndex(&txn_, "ids_eytzinger", "ids", ids_schema, ids_key_schema, {0},
+                                          InternalPageLayout::EYTZINGER);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, ids_index);
+  EXPECT_EQ(4U, ids_index->key_size_);
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTest, WideKeyTest) {
+  // Scenario: Keys longer than the largest key type are rejected.
+  Schema wide_schema{std::vector<Column>{Column("name", TypeId::VARCHAR, 256)}};
+  catalog_->CreateTable(&txn_, "wide", wide_schema);
+  auto wide_key_schema = Schema::CopySchema(&wide_schema, {0});
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO,
+            catalog_->CreateIndex(&txn_, "wide_name", "wide", wide_schema, wide_key_schema, {0}));
+}
+
+}  // namespace bustub
@@ -12,6 +12,9 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <optional>
+#include <random>
+#include <set>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -23,7 +26,7 @@ namespace bustub {
 
 using bustub::DiskManagerUnlimitedMemory;
 
-TEST(BPlusTreeTests, DISABLED_InsertTest1) {
+TEST(BPlusTreeTests, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -62,7 +65,7 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
   delete bpm;
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -120,7 +123,7 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   delete bpm;
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest3) {
+TEST(BPlusTreeTests, InsertTest3) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -184,4 +187,252 @@ TEST(BPlusTreeTests, DISABLED_InsertTest3) {
   delete transaction;
   delete bpm;
 }
+
+TEST(BPlusTreeTests, InsertBatchTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree with small pages, so that a batch fills leaves and splits them
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 5, 4);
+
+  // Three batches of interleaved keys in random order, each with a duplicate of a key of its own and of an earlier one.
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 3000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+  for (int batch = 0; batch < 3; batch++) {
+    std::vector<std::pair<GenericKey<8>, RID>> items;
+    for (size_t i = batch; i < keys.size(); i += 3) {
+      items.emplace_back();
+      items.back().first.SetFromInteger(keys[i]);
+      items.back().second.Set(0, static_cast<uint32_t>(keys[i]));
+    }
+    items.push_back(items[0]);
+    if (batch > 0) {
+      items.emplace_back();
+      items.back().first.SetFromInteger(keys[0]);
+    }
+    EXPECT_EQ(1000, tree.InsertBatch(items));
+  }
+
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key++;
+  }
+  EXPECT_EQ(3001, current_key);
+
+  // Look up every other key, some of them missing and some twice, in random order.
+  std::vector<GenericKey<8>> lookup_keys;
+  for (int64_t key = 0; key <= 3100; key += 2) {
+    lookup_keys.emplace_back();
+    lookup_keys.back().SetFromInteger(key);
+  }
+  lookup_keys.push_back(lookup_keys[1]);
+  std::shuffle(lookup_keys.begin(), lookup_keys.end(), std::default_random_engine{});
+  std::vector<std::vector<RID>> results;
+  EXPECT_EQ(1501, tree.GetValues(lookup_keys, &results));
+  ASSERT_EQ(lookup_keys.size(), results.size());
+  for (size_t i = 0; i < lookup_keys.size(); i++) {
+    auto key = lookup_keys[i].ToString();
+    if (key >= 1 && key <= 3000) {
+      ASSERT_EQ(1, results[i].size());
+      EXPECT_EQ(key, results[i][0].GetSlotNum());
+    } else {
+      EXPECT_TRUE(results[i].empty());
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, CompressedLeafTest) {
+  // A bigint key in a 64 byte key type leaves 56 bytes of zero padding in every key.
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+  using LeafPage = BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+  constexpr int uncompressed_capacity =
+      (BUSTUB_PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE - 64) / sizeof(std::pair<GenericKey<64>, RID>);
+
+  // Scenario: Keys below 256 only differ in one byte, so twice as many of them fit in a leaf.
+  GenericKey<64> index_key;
+  RID rid;
+  for (int64_t key = 0; key < 2 * uncompressed_capacity; key++) {
+    rid.Set(0, static_cast<uint32_t>(key));
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, rid));
+  }
+  {
+    auto guard = bpm->FetchPageRead(tree.GetRootPageId());
+    ASSERT_TRUE(guard.As<BPlusTreePage>()->IsLeafPage());
+    EXPECT_EQ(2 * uncompressed_capacity, guard.As<LeafPage>()->GetSize());
+  }
+
+  // Scenario: Keys of all sizes, in random order, make leaves store more and more of their keys until they split.
+  std::vector<int64_t> keys;
+  for (int64_t i = 0; i < 5000; i++) {
+    keys.push_back(i % 3 == 0 ? i << 40 : (i % 3 == 1 ? i << 12 : i + 1000));
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key));
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid);
+  }
+  for (int64_t key = 0; key < 2 * uncompressed_capacity; key++) {
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  auto iterator = tree.Begin();
+  for (auto key : keys) {
+    ASSERT_NE(tree.End(), iterator);
+    EXPECT_EQ(static_cast<uint32_t>(key), (*iterator).second.GetSlotNum());
+    ++iterator;
+  }
+  EXPECT_EQ(tree.End(), iterator);
+
+  // Scenario: Removing the keys in random order merges and redistributes leaves of all sizes.
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+  std::vector<RID> rids;
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_key.SetFromInteger(keys[i]);
+    tree.Remove(index_key);
+    if (i % 7 == 0) {
+      for (size_t j = i + 1; j < keys.size(); j += 97) {
+        rids.clear();
+        index_key.SetFromInteger(keys[j]);
+        ASSERT_TRUE(tree.GetValue(index_key, &rids));
+        EXPECT_EQ(static_cast<uint32_t>(keys[j]), rids[0].GetSlotNum());
+      }
+    }
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+TEST(BPlusTreeTests, ScanRangeTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  page_id_t eytzinger_header_page_id;
+  bpm->NewPage(&eytzinger_header_page_id);
+  // Small pages, so that a scan goes through many leaves and levels.
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> sorted_tree("foo_pk", header_page->GetPageId(), bpm, comparator,
+                                                                 5, 4);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> eytzinger_tree(
+      "bar_pk", eytzinger_header_page_id, bpm, comparator, 5, 4, InternalPageLayout::EYTZINGER);
+  using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+  GenericKey<8> index_key;
+  auto bound = [](int64_t key) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    return std::optional<GenericKey<8>>(index_key);
+  };
+  auto scan = [](Tree *tree, const std::optional<GenericKey<8>> &lo, const std::optional<GenericKey<8>> &hi,
+                 bool reverse) {
+    std::vector<int64_t> keys;
+    size_t visited = tree->ScanRange(
+        lo, hi,
+        [&keys](const std::pair<GenericKey<8>, RID> *items, size_t size) {
+          EXPECT_LT(0, size);
+          for (size_t i = 0; i < size; i++) {
+            EXPECT_EQ(items[i].first.ToString(), items[i].second.GetSlotNum());
+            keys.push_back(items[i].first.ToString());
+          }
+          return true;
+        },
+        reverse);
+    EXPECT_EQ(keys.size(), visited);
+    return keys;
+  };
+
+  // Scenario: An empty tree has no entries in any range.
+  EXPECT_TRUE(scan(&sorted_tree, std::nullopt, std::nullopt, false).empty());
+  EXPECT_TRUE(scan(&sorted_tree, std::nullopt, std::nullopt, true).empty());
+
+  // Even keys from 2 to 2000, then every third one removed again, so that some separator keys are no longer keys.
+  std::vector<int64_t> keys;
+  for (int64_t key = 2; key <= 2000; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+  RID rid;
+  for (auto key : keys) {
+    rid.Set(0, static_cast<uint32_t>(key));
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(sorted_tree.Insert(index_key, rid));
+    ASSERT_TRUE(eytzinger_tree.Insert(index_key, rid));
+  }
+  std::set<int64_t> expected(keys.begin(), keys.end());
+  for (size_t i = 0; i < keys.size(); i += 3) {
+    index_key.SetFromInteger(keys[i]);
+    sorted_tree.Remove(index_key);
+    eytzinger_tree.Remove(index_key);
+    expected.erase(keys[i]);
+  }
+
+  for (auto *tree : {&sorted_tree, &eytzinger_tree}) {
+    // Scenario: Bounds that are keys, fall between keys or lie past either end, and open bounds, in both directions.
+    std::vector<std::optional<int64_t>> bounds{std::nullopt, -5, 0, 2, 3, 101, 500, 997, 998, 1999, 2000, 2500};
+    for (auto lo : bounds) {
+      for (auto hi : bounds) {
+        std::vector<int64_t> in_range;
+        for (auto key : expected) {
+          if ((!lo.has_value() || key >= *lo) && (!hi.has_value() || key <= *hi)) {
+            in_range.push_back(key);
+          }
+        }
+        auto lo_key = lo.has_value() ? bound(*lo) : std::nullopt;
+        auto hi_key = hi.has_value() ? bound(*hi) : std::nullopt;
+        ASSERT_EQ(in_range, scan(tree, lo_key, hi_key, false));
+        std::reverse(in_range.begin(), in_range.end());
+        ASSERT_EQ(in_range, scan(tree, lo_key, hi_key, true));
+      }
+    }
+
+    // Scenario: The scan stops after the first batch that visit returns false for.
+    for (bool reverse : {false, true}) {
+      std::vector<int64_t> first_batch;
+      size_t visited = tree->ScanRange(
+          bound(100), bound(1900),
+          [&first_batch](const std::pair<GenericKey<8>, RID> *items, size_t size) {
+            for (size_t i = 0; i < size; i++) {
+              first_batch.push_back(items[i].first.ToString());
+            }
+            return false;
+          },
+          reverse);
+      ASSERT_FALSE(first_batch.empty());
+      EXPECT_EQ(first_batch.size(), visited);
+      EXPECT_LT(first_batch.size(), 5U);
+      EXPECT_EQ(reverse ? *std::prev(expected.upper_bound(1900)) : *expected.lower_bound(100), first_batch.front());
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  bpm->UnpinPage(eytzinger_header_page_id, true);
+  delete bpm;
+}
 }  // namespace bustub
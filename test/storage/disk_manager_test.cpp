@@ -10,9 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cstring>
+#include <vector>
 
 #include "common/exception.h"
+#include "common/util/crc32c.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 
@@ -22,14 +27,12 @@ class DiskManagerTest : public ::testing::Test {
  protected:
   // This function is called before every test.
   void SetUp() override {
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveDatabase("test.db");
   }
 
   // This function is called after every test.
   void TearDown() override {
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveDatabase("test.db");
   };
 };
 
@@ -55,6 +58,216 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIOTest) {
+  // One page-aligned buffer pair, and one pair that is deliberately off by a byte and needs the bounce buffer.
+  alignas(BUSTUB_PAGE_SIZE) static char aligned_buf[BUSTUB_PAGE_SIZE];
+  alignas(BUSTUB_PAGE_SIZE) static char aligned_data[BUSTUB_PAGE_SIZE];
+  static char unaligned_space[2][BUSTUB_PAGE_SIZE + 1];
+  char *unaligned_buf = unaligned_space[0] + 1;
+  char *unaligned_data = unaligned_space[1] + 1;
+
+  for (auto sync_policy : {DiskSyncPolicy::None, DiskSyncPolicy::OnFlush, DiskSyncPolicy::EveryWrite}) {
+    auto dm = DiskManager("test.db", true, sync_policy);
+    std::strncpy(aligned_data, "An aligned test string.", BUSTUB_PAGE_SIZE);
+    std::strncpy(unaligned_data, "An unaligned test string.", BUSTUB_PAGE_SIZE);
+
+    dm.WritePage(0, aligned_data);
+    dm.WritePage(3, unaligned_data);
+    dm.Sync();
+    dm.ReadPage(3, aligned_buf);
+    EXPECT_EQ(std::memcmp(aligned_buf, unaligned_data, BUSTUB_PAGE_SIZE), 0);
+    dm.ReadPage(0, unaligned_buf);
+    EXPECT_EQ(std::memcmp(unaligned_buf, aligned_data, BUSTUB_PAGE_SIZE), 0);
+
+    // Pages past the end of the file read as zeros, and pages in the hole before page 3 too.
+    std::memset(unaligned_buf, 1, BUSTUB_PAGE_SIZE);
+    dm.ReadPage(1, unaligned_buf);
+    EXPECT_EQ(0, unaligned_buf[0]);
+    std::memset(aligned_buf, 1, BUSTUB_PAGE_SIZE);
+    dm.ReadPage(10, aligned_buf);
+    EXPECT_EQ(0, aligned_buf[BUSTUB_PAGE_SIZE - 1]);
+
+    dm.ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocationMapTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  auto file_size = [] {
+    struct stat stat_buf;
+    stat("test.db", &stat_buf);
+    return static_cast<int64_t>(stat_buf.st_size);
+  };
+
+  auto *dm = new DiskManager("test.db");
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    dm->AllocatePage(page_id);
+    snprintf(data, BUSTUB_PAGE_SIZE, "%d", page_id);
+    dm->WritePage(page_id, data);
+  }
+  EXPECT_EQ(10, dm->GetNumAllocatedPages());
+  EXPECT_EQ(10, dm->GetPageIdLimit());
+  for (page_id_t page_id : {2, 7, 8, 9}) {
+    EXPECT_TRUE(dm->DeallocatePage(page_id));
+  }
+  EXPECT_FALSE(dm->DeallocatePage(2));
+  EXPECT_FALSE(dm->DeallocatePage(20));
+  EXPECT_FALSE(dm->IsPageAllocated(2));
+  EXPECT_TRUE(dm->IsPageAllocated(3));
+  EXPECT_EQ((std::vector<page_id_t>{2, 7, 8, 9}), dm->GetFreePages());
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: Deallocations that were never persisted are lost on restart, so the pages stay allocated.
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(10, dm->GetNumAllocatedPages());
+  EXPECT_TRUE(dm->GetFreePages().empty());
+  for (page_id_t page_id : {2, 7, 8, 9}) {
+    EXPECT_TRUE(dm->DeallocatePage(page_id));
+  }
+  // Page 8 is allocated again and page 9 deallocated again after the deallocations were taken, so only 2 and 7 are
+  // persisted.
+  auto deallocated_pages = dm->TakeDeallocatedPages();
+  EXPECT_EQ(4, deallocated_pages.size());
+  dm->AllocatePage(8);
+  dm->AllocatePage(9);
+  EXPECT_TRUE(dm->DeallocatePage(9));
+  dm->PersistDeallocations(deallocated_pages);
+  dm->ShutDown();
+  delete dm;
+
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(8, dm->GetNumAllocatedPages());
+  EXPECT_EQ((std::vector<page_id_t>{2, 7}), dm->GetFreePages());
+  EXPECT_TRUE(dm->DeallocatePage(8));
+  EXPECT_TRUE(dm->DeallocatePage(9));
+  dm->PersistDeallocations(dm->TakeDeallocatedPages());
+
+  // Scenario: Compaction truncates the file after page 6 and leaves the live pages and the map as they were.
+  EXPECT_EQ(DiskManager::GetPageOffset(9) + BUSTUB_PAGE_SIZE, file_size());
+  EXPECT_EQ(4, dm->Compact());
+  EXPECT_EQ(DiskManager::GetPageOffset(6) + BUSTUB_PAGE_SIZE, file_size());
+  EXPECT_EQ(7, dm->GetPageIdLimit());
+  for (page_id_t page_id : {0, 1, 3, 4, 5, 6}) {
+    dm->ReadPage(page_id, buf);
+    EXPECT_EQ(std::to_string(page_id), buf);
+  }
+  dm->ShutDown();
+  delete dm;
+
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(6, dm->GetNumAllocatedPages());
+  EXPECT_EQ((std::vector<page_id_t>{2}), dm->GetFreePages());
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SegmentTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  auto exists = [](const std::string &file_name) {
+    struct stat stat_buf;
+    return stat(file_name.c_str(), &stat_buf) == 0;
+  };
+
+  auto *dm = new DiskManager("test.db");
+  EXPECT_EQ((std::vector<segment_id_t>{DEFAULT_SEGMENT_ID}), dm->GetSegments());
+  auto segment_id = dm->CreateSegment();
+  ASSERT_EQ(1, segment_id);
+  EXPECT_TRUE(exists("test.db.1"));
+
+  // Scenario: Pages of a segment have their own page ids, file and allocation map, and are laid out like the pages of
+  // the database file.
+  auto first_page_id = DiskManager::GetFirstPageId(segment_id);
+  EXPECT_EQ(segment_id, DiskManager::GetSegmentId(first_page_id + 3));
+  EXPECT_EQ(DiskManager::GetPageOffset(3), DiskManager::GetPageOffset(first_page_id + 3));
+  dm->AllocatePage(0);
+  std::strncpy(data, "default", sizeof(data));
+  dm->WritePage(0, data);
+  for (page_id_t page_id = first_page_id; page_id < first_page_id + 3; page_id++) {
+    dm->AllocatePage(page_id);
+    snprintf(data, BUSTUB_PAGE_SIZE, "%d", page_id);
+    dm->WritePage(page_id, data);
+  }
+  EXPECT_EQ(1, dm->GetNumAllocatedPages());
+  EXPECT_EQ(3, dm->GetNumAllocatedPages(segment_id));
+  EXPECT_EQ(first_page_id + 3, dm->GetPageIdLimit(segment_id));
+  EXPECT_TRUE(dm->DeallocatePage(first_page_id + 1));
+  dm->PersistDeallocations(dm->TakeDeallocatedPages());
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: Segments are found again when the database is opened.
+  dm = new DiskManager("test.db");
+  EXPECT_EQ((std::vector<segment_id_t>{DEFAULT_SEGMENT_ID, segment_id}), dm->GetSegments());
+  EXPECT_EQ(2, dm->GetNumAllocatedPages(segment_id));
+  EXPECT_EQ((std::vector<page_id_t>{first_page_id + 1}), dm->GetFreePages(segment_id));
+  dm->ReadPage(first_page_id + 2, buf);
+  EXPECT_EQ(std::to_string(first_page_id + 2), buf);
+  dm->ReadPage(0, buf);
+  EXPECT_STREQ("default", buf);
+
+  // Scenario: Dropping a segment removes its file, and pages of a segment that does not exist read as zeros.
+  EXPECT_FALSE(dm->DropSegment(DEFAULT_SEGMENT_ID));
+  EXPECT_TRUE(dm->DropSegment(segment_id));
+  EXPECT_FALSE(dm->DropSegment(segment_id));
+  EXPECT_FALSE(dm->HasSegment(segment_id));
+  EXPECT_FALSE(exists("test.db.1"));
+  dm->ReadPage(first_page_id + 2, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, dm->GetNumAllocatedPages(segment_id));
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  EXPECT_EQ(0xE3069283, Crc32c::Compute("123456789", 9));
+
+  auto *dm = new DiskManager("test.db", false, DiskSyncPolicy::None, true);
+  std::strncpy(data, "A test string.", sizeof(data));
+  dm->WritePage(0, data);
+  dm->WritePage(1, data);
+  // The caller's buffer is left alone, and the page read back carries the checksum in its trailer.
+  EXPECT_EQ(0, data[BUSTUB_PAGE_USABLE_SIZE]);
+  EXPECT_TRUE(dm->ReadPage(0, buf));
+  EXPECT_EQ(std::memcmp(buf, data, BUSTUB_PAGE_USABLE_SIZE), 0);
+  EXPECT_EQ(DiskManager::ComputeChecksum(buf), *reinterpret_cast<uint32_t *>(buf + BUSTUB_PAGE_USABLE_SIZE));
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A flipped byte, as a torn or corrupted write leaves behind, fails the checksum of its page only.
+  int fd = open("test.db", O_RDWR);
+  ASSERT_GE(fd, 0);
+  char byte = 'X';
+  ASSERT_EQ(1, pwrite(fd, &byte, 1, DiskManager::GetPageOffset(1) + 100));
+  close(fd);
+  dm = new DiskManager("test.db", false, DiskSyncPolicy::None, true);
+  EXPECT_TRUE(dm->ReadPage(0, buf));
+  EXPECT_FALSE(dm->ReadPage(1, buf));
+  EXPECT_EQ(1, dm->GetNumChecksumFailures());
+
+  // Scenario: Pages that were never stamped, such as pages past the end of the file, are not checked.
+  EXPECT_TRUE(dm->ReadPage(10, buf));
+  EXPECT_EQ(1, dm->GetNumChecksumFailures());
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: Without checksums the corrupted page reads as it is.
+  dm = new DiskManager("test.db");
+  EXPECT_TRUE(dm->ReadPage(1, buf));
+  EXPECT_EQ('X', buf[100]);
+  dm->ShutDown();
+  delete dm;
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+/** Write num_pages pages as one batch, then read them back as another batch. */
+static void ScheduleRoundTrip(DiskScheduler *disk_scheduler, size_t num_pages) {
+  std::vector<std::unique_ptr<char[]>> write_bufs;
+  std::vector<std::unique_ptr<char[]>> read_bufs;
+  std::vector<DiskRequest> requests;
+  std::vector<std::future<bool>> futures;
+  for (size_t i = 0; i < num_pages; i++) {
+    write_bufs.emplace_back(new char[BUSTUB_PAGE_SIZE]);
+    read_bufs.emplace_back(new char[BUSTUB_PAGE_SIZE]);
+    snprintf(write_bufs[i].get(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    auto promise = disk_scheduler->CreatePromise();
+    futures.push_back(promise.get_future());
+    requests.push_back({true, write_bufs[i].get(), static_cast<page_id_t>(i), std::move(promise)});
+  }
+  disk_scheduler->Schedule(std::move(requests));
+  for (auto &future : futures) {
+    ASSERT_TRUE(future.get());
+  }
+
+  requests.clear();
+  futures.clear();
+  for (size_t i = 0; i < num_pages; i++) {
+    auto promise = disk_scheduler->CreatePromise();
+    futures.push_back(promise.get_future());
+    requests.push_back({false, read_bufs[i].get(), static_cast<page_id_t>(i), std::move(promise)});
+  }
+  disk_scheduler->Schedule(std::move(requests));
+  for (size_t i = 0; i < num_pages; i++) {
+    ASSERT_TRUE(futures[i].get());
+    ASSERT_EQ(0, memcmp(write_bufs[i].get(), read_bufs[i].get(), BUSTUB_PAGE_SIZE));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+
+  auto dm = std::make_unique<DiskManager>("test.db");
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto promise1 = disk_scheduler->CreatePromise();
+  auto future1 = promise1.get_future();
+  auto promise2 = disk_scheduler->CreatePromise();
+  auto future2 = promise2.get_future();
+
+  disk_scheduler->Schedule({/*is_write=*/true, data, /*page_id=*/0, std::move(promise1)});
+  ASSERT_TRUE(future1.get());
+  disk_scheduler->Schedule({/*is_write=*/false, buf, /*page_id=*/0, std::move(promise2)});
+  ASSERT_TRUE(future2.get());
+
+  ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // Reading past the end of the file returns an empty page.
+  std::memset(buf, 1, sizeof(buf));
+  std::memset(data, 0, sizeof(data));
+  auto promise3 = disk_scheduler->CreatePromise();
+  auto future3 = promise3.get_future();
+  disk_scheduler->Schedule({/*is_write=*/false, buf, /*page_id=*/100, std::move(promise3)});
+  ASSERT_TRUE(future3.get());
+  ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  disk_scheduler = nullptr;  // Call the DiskScheduler destructor to finish all scheduled jobs.
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, BatchTest) {
+  // More requests than the io_uring queue depth, so the ring has to be refilled while requests are in flight.
+  auto dm = std::make_unique<DiskManager>("test.db");
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+  ScheduleRoundTrip(disk_scheduler.get(), DISK_SCHEDULER_QUEUE_DEPTH * 4);
+  disk_scheduler = nullptr;
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, ChecksumTest) {
+  auto dm = std::make_unique<DiskManager>("test.db", false, DiskSyncPolicy::OnFlush, true);
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: The checksum is stamped into a copy, so the caller's page is left alone while it is written.
+  auto promise1 = disk_scheduler->CreatePromise();
+  auto future1 = promise1.get_future();
+  disk_scheduler->Schedule({/*is_write=*/true, data, /*page_id=*/0, std::move(promise1)});
+  ASSERT_TRUE(future1.get());
+  char zeros[BUSTUB_PAGE_SIZE - BUSTUB_PAGE_USABLE_SIZE] = {0};
+  ASSERT_EQ(0, std::memcmp(data + BUSTUB_PAGE_USABLE_SIZE, zeros, sizeof(zeros)));
+
+  // Scenario: The page read back passes its checksum.
+  auto promise2 = disk_scheduler->CreatePromise();
+  auto future2 = promise2.get_future();
+  disk_scheduler->Schedule({/*is_write=*/false, buf, /*page_id=*/0, std::move(promise2)});
+  ASSERT_TRUE(future2.get());
+  ASSERT_EQ(0, std::memcmp(buf, data, BUSTUB_PAGE_USABLE_SIZE));
+  ASSERT_EQ(0, dm->GetNumChecksumFailures());
+
+  disk_scheduler = nullptr;
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, WorkerPoolTest) {
+  // The in-memory disk manager has no file, so requests go through the worker pool.
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+  ASSERT_FALSE(disk_scheduler->UsesIoUring());
+  ScheduleRoundTrip(disk_scheduler.get(), 100);
+}
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page_test.cpp
+//
+// Identification: test/storage/free_space_map_page_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapPageTest, BasicTest) {
+  FreeSpaceMapPage page{};
+  page_id_t page_id = 15445;
+  page.Init(page_id);
+
+  ASSERT_EQ(page.GetFsmPageId(), page_id);
+  ASSERT_EQ(page.GetNextPageId(), INVALID_PAGE_ID);
+  ASSERT_EQ(page.GetLastFsmPageId(), page_id);
+  ASSERT_EQ(page.GetEntryCount(), 0);
+
+  uint32_t slot_num;
+  ASSERT_FALSE(page.FindFreeSpace(1, &slot_num));
+
+  // Page 1 is almost full, page 2 has some room and page 3 is empty.
+  ASSERT_TRUE(page.AppendEntry(1, 10, &slot_num));
+  ASSERT_EQ(slot_num, 0);
+  ASSERT_TRUE(page.AppendEntry(2, 1000, &slot_num));
+  ASSERT_EQ(slot_num, 1);
+  ASSERT_TRUE(page.AppendEntry(3, BUSTUB_PAGE_SIZE, &slot_num));
+  ASSERT_EQ(slot_num, 2);
+  ASSERT_EQ(page.GetEntryCount(), 3);
+
+  // Free space is rounded down, so the map never promises more than the page has.
+  ASSERT_LE(page.GetFreeSpace(0), 10);
+  ASSERT_LE(page.GetFreeSpace(1), 1000);
+  ASSERT_GT(page.GetFreeSpace(1), 1000 - FreeSpaceMapPage::FSM_BUCKET_WIDTH);
+
+  ASSERT_TRUE(page.FindFreeSpace(500, &slot_num));
+  ASSERT_EQ(page.GetTablePageId(slot_num), 2);
+  ASSERT_TRUE(page.FindFreeSpace(2000, &slot_num));
+  ASSERT_EQ(page.GetTablePageId(slot_num), 3);
+  ASSERT_FALSE(page.FindFreeSpace(BUSTUB_PAGE_SIZE + 1, &slot_num));
+
+  // Page 2 fills up, so the request has to go to page 3.
+  ASSERT_TRUE(page.SetFreeSpace(1, 100));
+  ASSERT_FALSE(page.SetFreeSpace(1, 100));
+  ASSERT_TRUE(page.FindFreeSpace(500, &slot_num));
+  ASSERT_EQ(page.GetTablePageId(slot_num), 3);
+}
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapPageTest, FullPageTest) {
+  FreeSpaceMapPage page{};
+  page.Init(0);
+
+  uint32_t slot_num;
+  page_id_t table_page_id = 1;
+  while (!page.IsFull()) {
+    ASSERT_TRUE(page.AppendEntry(table_page_id, 0, &slot_num));
+    ASSERT_EQ(page.GetTablePageId(slot_num), table_page_id);
+    table_page_id++;
+  }
+  ASSERT_FALSE(page.AppendEntry(table_page_id, 0, &slot_num));
+  ASSERT_FALSE(page.FindFreeSpace(1, &slot_num));
+
+  // Entries and buckets do not overlap: the last slot can still be found after the page fills up.
+  auto last_slot = page.GetEntryCount() - 1;
+  page.SetFreeSpace(last_slot, BUSTUB_PAGE_SIZE);
+  ASSERT_TRUE(page.FindFreeSpace(BUSTUB_PAGE_SIZE / 2, &slot_num));
+  ASSERT_EQ(slot_num, last_slot);
+  ASSERT_EQ(page.GetTablePageId(slot_num), table_page_id - 1);
+}
+
+}  // namespace bustub
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder_test.cpp
+//
+// Identification: test/storage/key_encoder_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/key_encoder.h"
+#include "test_util.h"  // NOLINT
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TEST(KeyEncoderTest, OrderTest) {
+  auto key_schema = ParseCreateStatement("a integer,b varchar(8),c bigint");
+  // The varchar takes a flag byte and two groups of 8 characters and a marker, since 8 characters fill the first one.
+  EXPECT_EQ(4U + 19U + 8U, KeyEncoder::EncodedSize(*key_schema));
+
+  std::vector<int32_t> as{BUSTUB_INT32_MIN, -70000, -1, 0, 1, 255, 256, 70000, BUSTUB_INT32_MAX};
+  std::vector<std::string> bs{"", std::string(1, '\0'), std::string(8, '\0'), std::string("a\0b", 3), "a",
+                              std::string("a\0", 2), "abcdefg", "abcdefgh", "abcdefgi", "ab", "b", "\xff",
+                              std::string(8, '\xff')};
+  std::vector<int64_t> cs{BUSTUB_INT64_MIN, -1, 0, 1};
+  std::vector<std::tuple<int32_t, std::string, int64_t>> keys;
+  for (auto a : as) {
+    for (const auto &b : bs) {
+      for (auto c : cs) {
+        keys.emplace_back(a, b, c);
+      }
+    }
+  }
+
+  // Scenario: The encodings order like the keys, column by column.
+  auto encode = [&](const std::tuple<int32_t, std::string, int64_t> &key) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(std::get<0>(key)),
+                              ValueFactory::GetVarcharValue(std::get<1>(key)),
+                              ValueFactory::GetBigIntValue(std::get<2>(key))};
+    std::string encoded(32, 'x');
+    EXPECT_TRUE(KeyEncoder::Encode(Tuple(values, key_schema.get()), *key_schema, encoded.data(), encoded.size()));
+    return encoded;
+  };
+  std::vector<std::string> encoded;
+  std::transform(keys.begin(), keys.end(), std::back_inserter(encoded), encode);
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      ASSERT_EQ(keys[i] < keys[j], encoded[i] < encoded[j]) << i << " " << j;
+    }
+  }
+
+  // Scenario: NULL comes before any other value of a column.
+  std::vector<Value> nulls{ValueFactory::GetNullValueByType(TypeId::INTEGER),
+                           ValueFactory::GetNullValueByType(TypeId::VARCHAR),
+                           ValueFactory::GetNullValueByType(TypeId::BIGINT)};
+  std::string null_key(32, 'x');
+  EXPECT_TRUE(KeyEncoder::Encode(Tuple(nulls, key_schema.get()), *key_schema, null_key.data(), null_key.size()));
+  EXPECT_LT(null_key, *std::min_element(encoded.begin(), encoded.end()));
+
+  // Scenario: Keys fit in EncodedSize() bytes whatever bytes their strings hold, unless a string is longer than its
+  // column.
+  auto fits = [&](const std::string &b, size_t size) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(0), ValueFactory::GetVarcharValue(b),
+                              ValueFactory::GetBigIntValue(0)};
+    char buffer[64];
+    return KeyEncoder::Encode(Tuple(values, key_schema.get()), *key_schema, buffer, size);
+  };
+  EXPECT_TRUE(fits(std::string(8, '\0'), KeyEncoder::EncodedSize(*key_schema)));
+  EXPECT_TRUE(fits(std::string(8, '\xff'), KeyEncoder::EncodedSize(*key_schema)));
+  EXPECT_FALSE(fits(std::string(16, 'x'), KeyEncoder::EncodedSize(*key_schema)));
+  EXPECT_TRUE(fits(std::string(16, 'x'), 64));
+}
+
+TEST(KeyEncoderTest, DecimalOrderTest) {
+  auto key_schema = ParseCreateStatement("a double");
+  std::vector<double> decimals{-1e300, -2.5, -1, -1e-300, 0, 1e-300, 1, 2.5, 1e300};
+  std::vector<std::string> encoded;
+  for (auto decimal : decimals) {
+    std::string key(8, 'x');
+    std::vector<Value> values{ValueFactory::GetDecimalValue(decimal)};
+    EXPECT_TRUE(KeyEncoder::Encode(Tuple(values, key_schema.get()), *key_schema, key.data(), key.size()));
+    encoded.push_back(key);
+  }
+  EXPECT_TRUE(std::is_sorted(encoded.begin(), encoded.end()));
+  EXPECT_EQ(encoded.size(), std::set<std::string>(encoded.begin(), encoded.end()).size());
+
+  // -0.0 and 0.0 are the same key.
+  std::string negative_zero(8, 'x');
+  std::vector<Value> values{ValueFactory::GetDecimalValue(-0.0)};
+  EXPECT_TRUE(KeyEncoder::Encode(Tuple(values, key_schema.get()), *key_schema, negative_zero.data(), 8));
+  EXPECT_EQ(encoded[4], negative_zero);
+}
+
+/** Check that comparator orders keys of a single integer column like the integers. */
+template <size_t KeySize>
+void CheckIntegerComparator(const std::string &create_stmt, const std::vector<Value> &values) {
+  auto key_schema = ParseCreateStatement(create_stmt);
+  GenericComparator<KeySize> comparator(key_schema.get());
+  std::vector<GenericKey<KeySize>> keys(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    keys[i].SetFromKey(Tuple({values[i]}, key_schema.get()), *key_schema);
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    for (size_t j = 0; j < values.size(); j++) {
+      int expected = values[i].CompareLessThan(values[j]) == CmpBool::CmpTrue      ? -1
+                     : values[i].CompareGreaterThan(values[j]) == CmpBool::CmpTrue ? 1
+                                                                                   : 0;
+      ASSERT_EQ(expected, comparator(keys[i], keys[j])) << create_stmt << " " << KeySize << " " << i << " " << j;
+    }
+  }
+}
+
+TEST(KeyEncoderTest, IntegerComparatorTest) {
+  std::vector<Value> integers;
+  std::vector<Value> bigints;
+  for (int64_t value : {BUSTUB_INT64_MIN, static_cast<int64_t>(BUSTUB_INT32_MIN), -65536L, -256L, -1L, 0L, 1L, 255L,
+                        256L, 65536L, static_cast<int64_t>(BUSTUB_INT32_MAX), BUSTUB_INT64_MAX}) {
+    bigints.push_back(ValueFactory::GetBigIntValue(value));
+    if (value >= BUSTUB_INT32_MIN && value <= BUSTUB_INT32_MAX) {
+      integers.push_back(ValueFactory::GetIntegerValue(static_cast<int32_t>(value)));
+    }
+  }
+  // Scenario: Keys of 4 and 8 bytes compare as integers, longer ones only compare their first 4 or 8 bytes.
+  CheckIntegerComparator<4>("a integer", integers);
+  CheckIntegerComparator<8>("a integer", integers);
+  CheckIntegerComparator<64>("a integer", integers);
+  CheckIntegerComparator<8>("a bigint", bigints);
+  CheckIntegerComparator<16>("a bigint", bigints);
+  CheckIntegerComparator<64>("a bigint", bigints);
+}
+
+}  // namespace bustub
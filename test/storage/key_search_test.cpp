@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search_test.cpp
+//
+// Identification: test/storage/key_search_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/key_search.h"
+
+namespace bustub {
+
+TEST(KeySearchTest, CountTest) {
+  std::mt19937_64 gen(15445);
+  for (size_t width = 1; width <= 8; width++) {
+    uint64_t max_key = width == 8 ? UINT64_MAX : (1ULL << (8 * width)) - 1;
+    for (size_t stride : {width, width + 4, width + 8}) {
+      for (int count : {0, 1, 2, 7, 8, 9, 16, 17, 100, 250}) {
+        // Keys are stored big-endian, with 8 readable bytes behind the last one.
+        std::set<uint64_t> key_set;
+        while (static_cast<int>(key_set.size()) < count) {
+          key_set.insert(gen() & max_key);
+        }
+        std::vector<uint64_t> keys(key_set.begin(), key_set.end());
+        std::vector<char> bytes(count * stride + 8, '\x5a');
+        for (int i = 0; i < count; i++) {
+          for (size_t b = 0; b < width; b++) {
+            bytes[i * stride + b] = static_cast<char>(keys[i] >> (8 * (width - 1 - b)));
+          }
+          ASSERT_EQ(keys[i], KeySearch::Load(&bytes[i * stride], width));
+        }
+
+        // Scenario: Both searches find the lower and upper bound of stored keys, their neighbours and the extremes.
+        std::vector<uint64_t> targets{0, max_key};
+        for (auto key : keys) {
+          targets.push_back(key);
+          targets.push_back(key - 1);
+          targets.push_back(key + 1);
+        }
+        for (auto target : targets) {
+          target &= max_key;
+          int lower = std::lower_bound(keys.begin(), keys.end(), target) - keys.begin();
+          int upper = std::upper_bound(keys.begin(), keys.end(), target) - keys.begin();
+          ASSERT_EQ(lower, KeySearch::Count(bytes.data(), stride, count, width, target, false)) << width << count;
+          ASSERT_EQ(upper, KeySearch::Count(bytes.data(), stride, count, width, target, true)) << width << count;
+          ASSERT_EQ(lower, KeySearch::CountScalar(bytes.data(), stride, count, width, target, false));
+          ASSERT_EQ(upper, KeySearch::CountScalar(bytes.data(), stride, count, width, target, true));
+        }
+      }
+    }
+  }
+
+  // Scenario: Keys without bytes are all equal.
+  char none[8] = {};
+  EXPECT_EQ(0, KeySearch::Count(none, 0, 5, 0, 0, false));
+  EXPECT_EQ(5, KeySearch::Count(none, 0, 5, 0, 0, true));
+}
+
+}  // namespace bustub
@@ -24,7 +24,7 @@
 
 namespace bustub {
 // NOLINTNEXTLINE
-TEST(TupleTest, DISABLED_TableHeapTest) {
+TEST(TupleTest, TableHeapTest) {
   // test1: parse create sql statement
   std::string create_stmt = "a varchar(20), b smallint, c bigint, d bool, e varchar(16)";
   Column col1{"a", TypeId::VARCHAR, 20};
@@ -67,8 +67,116 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   remove("test.db");  // remove db file
   remove("test.log");
   delete table;
+  delete log_manager;
+  delete lock_manager;
   delete buffer_pool_manager;
   delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TableIteratorReadAheadTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  Column col3{"c", TypeId::BIGINT};
+  Column col4{"d", TypeId::BOOLEAN};
+  Column col5{"e", TypeId::VARCHAR, 16};
+  std::vector<Column> cols{col1, col2, col3, col4, col5};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  const int num_tuples = 5000;
+  for (int i = 0; i < num_tuples; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  auto first_page_id = table->GetFirstPageId();
+  auto fsm_page_id = table->GetFreeSpaceMapPageId();
+  buffer_pool_manager->FlushAllPages();
+  delete table;
+  delete buffer_pool_manager;
+
+  // A cold scan reads the table ahead of the iterator and still returns every tuple exactly once.
+  buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, first_page_id, fsm_page_id);
+  // The free space map is rebuilt in the root page it had.
+  EXPECT_EQ(fsm_page_id, table->GetFreeSpaceMapPageId());
+  int count = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    count++;
+  }
+  EXPECT_EQ(num_tuples, count);
+  EXPECT_GT(buffer_pool_manager->GetStats().prefetch_reads_, 0);
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, FreeSpaceMapRebuildTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::BIGINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  const int num_tuples = 1000;
+  for (int i = 0; i < num_tuples; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  auto first_page_id = table->GetFirstPageId();
+  auto fsm_page_id = table->GetFreeSpaceMapPageId();
+  delete table;
+
+  // Changes to the map are not logged. Make it miss the table pages after the first one, as if it had not reached the
+  // disk since.
+  auto *fsm_root = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager->FetchPage(fsm_page_id));
+  ASSERT_NE(first_page_id, fsm_root->GetLastTablePageId());
+  fsm_root->SetLastTablePageId(first_page_id);
+  buffer_pool_manager->UnpinPage(fsm_page_id, true);
+
+  // The opened heap rebuilds the map from the table pages, so new pages are still appended at the end of the chain.
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, first_page_id, fsm_page_id);
+  EXPECT_EQ(fsm_page_id, table->GetFreeSpaceMapPageId());
+  for (int i = 0; i < num_tuples; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  int count = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    count++;
+  }
+  EXPECT_EQ(2 * num_tuples, count);
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
 }
 
 }  // namespace bustub
@@ -1,5 +1,6 @@
 #include <chrono>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <random>
@@ -13,7 +14,7 @@
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
@@ -61,6 +62,7 @@ struct BpmTotalMetrics {
 
     fmt::print("<<< BEGIN\n");
     fmt::print("scan: {}\n", scan_per_sec);
+    fmt::print("scan MB/s: {}\n", scan_per_sec * bustub::BUSTUB_PAGE_SIZE / (1 << 20));
     fmt::print("get: {}\n", get_per_sec);
     fmt::print(">>> END\n");
   }
@@ -100,42 +102,22 @@ struct BpmMetrics {
   }
 };
 
-// NOLINTNEXTLINE
-auto main(int argc, char **argv) -> int {
+/**
+ * Create the pages, then run the scan and get threads against them for duration_ms. With use_access_type == false
+ * every access is reported as AccessType::Unknown, i.e. the buffer pool gets no hint which accesses are scans.
+ */
+auto RunBench(uint64_t duration_ms, uint64_t latency_ms, size_t num_shards, bustub::ReplacerPolicy policy,
+              bool use_access_type) -> bustub::BufferPoolStats {
   using bustub::AccessType;
   using bustub::BufferPoolManager;
   using bustub::DiskManagerUnlimitedMemory;
   using bustub::page_id_t;
 
-  argparse::ArgumentParser program("bustub-bpm-bench");
-  program.add_argument("--duration").help("run bpm bench for n milliseconds");
-  program.add_argument("--latency").help("set disk latency to n milliseconds");
-
-  try {
-    program.parse_args(argc, argv);
-  } catch (const std::runtime_error &err) {
-    std::cerr << err.what() << std::endl;
-    std::cerr << program;
-    return 1;
-  }
-
-  uint64_t duration_ms = 30000;
-  if (program.present("--duration")) {
-    duration_ms = std::stoi(program.get("--duration"));
-  }
-
-  uint64_t latency_ms = 0;
-  if (program.present("--latency")) {
-    latency_ms = std::stoi(program.get("--latency"));
-  }
-
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr, num_shards,
+                                                 policy);
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
-
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
     auto *page = bpm->NewPage(&page_id);
@@ -158,16 +140,18 @@ auto main(int argc, char **argv) -> int {
   total_metrics.Begin();
 
   std::vector<std::thread> threads;
+  auto scan_access = use_access_type ? AccessType::Scan : AccessType::Unknown;
+  auto get_access = use_access_type ? AccessType::Get : AccessType::Unknown;
 
   for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics, scan_access] {
       BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
       size_t page_idx = BUSTUB_PAGE_CNT * thread_id / BUSTUB_SCAN_THREAD;
 
       while (!metrics.ShouldFinish()) {
-        auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Scan);
+        auto *page = bpm->FetchPage(page_ids[page_idx], scan_access);
 
         char &ch = page->GetData()[page_idx % 1024];
         ch += 1;
@@ -175,7 +159,7 @@ auto main(int argc, char **argv) -> int {
           ch = 1;
         }
 
-        bpm->UnpinPage(page->GetPageId(), true, AccessType::Scan);
+        bpm->UnpinPage(page->GetPageId(), true, scan_access);
         page_idx = (page_idx + 1) % BUSTUB_PAGE_CNT;
         metrics.Tick();
         metrics.Report();
@@ -186,7 +170,7 @@ auto main(int argc, char **argv) -> int {
   }
 
   for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics, get_access] {
       std::random_device r;
       std::default_random_engine gen(r());
       zipfian_int_distribution<size_t> dist(0, BUSTUB_PAGE_CNT - 1, 0.8);
@@ -196,14 +180,14 @@ auto main(int argc, char **argv) -> int {
 
       while (!metrics.ShouldFinish()) {
         auto page_idx = dist(gen);
-        auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Get);
+        auto *page = bpm->FetchPage(page_ids[page_idx], get_access);
 
         char ch = page->GetData()[page_idx % 1024];
         if (ch == 0) {
           throw std::runtime_error("invalid data");
         }
 
-        bpm->UnpinPage(page->GetPageId(), false, AccessType::Get);
+        bpm->UnpinPage(page->GetPageId(), false, get_access);
         page_idx += 1;
         metrics.Tick();
         metrics.Report();
@@ -219,5 +203,95 @@ auto main(int argc, char **argv) -> int {
 
   total_metrics.Report();
 
+  return bpm->GetStats();
+}
+
+auto HitRatio(const bustub::BufferPoolStats &stats) -> double {
+  auto total = stats.hits_ + stats.misses_;
+  return total == 0 ? 0 : static_cast<double>(stats.hits_) / static_cast<double>(total);
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-bpm-bench");
+  program.add_argument("--duration").help("run bpm bench for n milliseconds");
+  program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--shards").help("split the buffer pool into n independently latched shards");
+  program.add_argument("--replacer").help("replacement policy: lru, clock, lru-k (default), arc, 2q or clock-pro");
+  program.add_argument("--mode").help(
+      "default: one run; mixed: one run without and one with access type hints, reporting the hit ratio of each");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 30000;
+  if (program.present("--duration")) {
+    duration_ms = std::stoi(program.get("--duration"));
+  }
+
+  uint64_t latency_ms = 0;
+  if (program.present("--latency")) {
+    latency_ms = std::stoi(program.get("--latency"));
+  }
+
+  size_t num_shards = 1;
+  if (program.present("--shards")) {
+    num_shards = std::stoi(program.get("--shards"));
+  }
+  // Every thread may pin a page of the same shard at once, so each shard needs a frame per thread.
+  if (num_shards == 0 || BUSTUB_BPM_SIZE / num_shards < BUSTUB_SCAN_THREAD + BUSTUB_GET_THREAD) {
+    std::cerr << "--shards must leave at least " << BUSTUB_SCAN_THREAD + BUSTUB_GET_THREAD << " frames per shard"
+              << std::endl;
+    return 1;
+  }
+
+  const std::map<std::string, bustub::ReplacerPolicy> policies = {
+      {"lru", bustub::ReplacerPolicy::LRU},        {"clock", bustub::ReplacerPolicy::Clock},
+      {"lru-k", bustub::ReplacerPolicy::LRUK},     {"arc", bustub::ReplacerPolicy::ARC},
+      {"2q", bustub::ReplacerPolicy::TwoQueue},    {"clock-pro", bustub::ReplacerPolicy::ClockPro},
+  };
+  std::string replacer = "lru-k";
+  if (program.present("--replacer")) {
+    replacer = program.get("--replacer");
+  }
+  if (policies.count(replacer) == 0) {
+    std::cerr << "unknown --replacer " << replacer << std::endl;
+    return 1;
+  }
+  auto policy = policies.at(replacer);
+
+  std::string mode = "default";
+  if (program.present("--mode")) {
+    mode = program.get("--mode");
+  }
+  if (mode != "default" && mode != "mixed") {
+    std::cerr << "unknown --mode " << mode << std::endl;
+    return 1;
+  }
+
+  fmt::print(stderr,
+             "[info] total_page={}, page_size={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, "
+             "shards={}, replacer={}, mode={}\n",
+             BUSTUB_PAGE_CNT, bustub::BUSTUB_PAGE_SIZE, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE,
+             num_shards, replacer, mode);
+
+  if (mode == "default") {
+    RunBench(duration_ms, latency_ms, num_shards, policy, true);
+    return 0;
+  }
+
+  // Same workload twice: first the buffer pool cannot tell scans from gets, then it can.
+  auto before = RunBench(duration_ms, latency_ms, num_shards, policy, false);
+  auto after = RunBench(duration_ms, latency_ms, num_shards, policy, true);
+  fmt::print("<<< BEGIN\n");
+  fmt::print("hit ratio without access type: {:.4f}\n", HitRatio(before));
+  fmt::print("hit ratio with access type: {:.4f}\n", HitRatio(after));
+  fmt::print(">>> END\n");
+
   return 0;
 }
@@ -0,0 +1,47 @@
+#include <sys/stat.h>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "argparse/argparse.hpp"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+
+/** @return the size of a file and the bytes of disk space it takes up */
+auto FileUsage(const std::string &file_name) -> std::pair<int64_t, int64_t> {
+  struct stat stat_buf;
+  if (stat(file_name.c_str(), &stat_buf) != 0) {
+    return {0, 0};
+  }
+  return {stat_buf.st_size, static_cast<int64_t>(stat_buf.st_blocks) * 512};
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-compact");
+  program.add_argument("db_file").help("database file to compact, which must not be in use");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto db_file = program.get("db_file");
+  auto [old_size, old_usage] = FileUsage(db_file);
+  if (old_size == 0) {
+    std::cerr << "cannot find a database in " << db_file << std::endl;
+    return 1;
+  }
+
+  bustub::DiskManager disk_manager(db_file);
+  auto reclaimed = disk_manager.Compact();
+  fmt::print("{} allocated pages, {} free pages reclaimed\n", disk_manager.GetNumAllocatedPages(), reclaimed);
+  disk_manager.ShutDown();
+
+  auto [new_size, new_usage] = FileUsage(db_file);
+  fmt::print("file size {} -> {} bytes, disk usage {} -> {} bytes\n", old_size, new_size, old_usage, new_usage);
+  return 0;
+}
@@ -0,0 +1,467 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/key_search.h"
+
+using Clock = std::chrono::steady_clock;
+
+static auto PerSecond(size_t operations, Clock::time_point start) -> double {
+  auto elapsed = std::chrono::duration<double>(Clock::now() - start);
+  return static_cast<double>(operations) / elapsed.count();
+}
+
+/**
+ * Counts the cache misses of this thread with a hardware performance counter. Counters may not be there, e.g. in a VM
+ * or with perf_event_paranoid set high, and then Read() returns nothing.
+ */
+class CacheMissCounter {
+ public:
+  CacheMissCounter() {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  ~CacheMissCounter() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  CacheMissCounter(const CacheMissCounter &) = delete;
+  auto operator=(const CacheMissCounter &) -> CacheMissCounter & = delete;
+
+  void Start() {
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  /** @return the cache misses since Start(), if the counter works */
+  auto Read() -> std::optional<uint64_t> {
+    uint64_t count;
+    if (fd_ < 0 || ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0) != 0 || read(fd_, &count, sizeof(count)) != sizeof(count)) {
+      return std::nullopt;
+    }
+    return count;
+  }
+
+ private:
+  int fd_;
+};
+
+/** The lookups per second of a tree and the cache misses per lookup, if there are counters to tell. */
+struct LookupResult {
+  double rate_;
+  std::optional<double> misses_;
+
+  auto ToString() const -> std::string {
+    return fmt::format("{:.0f}/s, {} cache misses/lookup", rate_,
+                       misses_.has_value() ? fmt::format("{:.1f}", *misses_) : "n/a");
+  }
+};
+
+/**
+ * Search a leaf page full of keys of the given width for random keys and return the searches per second. The keys
+ * are laid out like the entries of a leaf page, each followed by its RID.
+ */
+static auto RunPageSearches(size_t width, bool vectorized, size_t num_searches) -> double {
+  size_t stride = width + sizeof(bustub::RID);
+  auto count = static_cast<int>(bustub::BUSTUB_PAGE_USABLE_SIZE / stride);
+  std::vector<char> bytes(count * stride + sizeof(uint64_t));
+  for (int i = 0; i < count; i++) {
+    uint64_t key = 2 * i + 1;
+    for (size_t b = 0; b < width; b++) {
+      bytes[i * stride + b] = static_cast<char>(key >> (8 * (width - 1 - b)));
+    }
+  }
+
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<uint64_t> dist(0, 2 * count + 1);
+  std::vector<uint64_t> targets(4096);
+  for (auto &target : targets) {
+    target = dist(gen);
+  }
+  int sum = 0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < num_searches; i++) {
+    auto target = targets[i % targets.size()];
+    sum += vectorized ? bustub::KeySearch::Count(bytes.data(), stride, count, width, target, false)
+                      : bustub::KeySearch::CountScalar(bytes.data(), stride, count, width, target, false);
+  }
+  auto rate = PerSecond(num_searches, start);
+  if (sum < 0) {
+    throw std::runtime_error("bad search");
+  }
+  return rate;
+}
+
+/**
+ * Search random keys in num_pages full internal pages with the given layout, a different page each time, so that the
+ * pages are mostly not in the cache, like the internal pages of a large tree.
+ */
+template <size_t KeySize>
+auto RunInternalPageSearches(bustub::InternalPageLayout layout, size_t num_pages, size_t num_searches)
+    -> LookupResult {
+  using InternalPage = bustub::BPlusTreeInternalPage<bustub::GenericKey<KeySize>, bustub::page_id_t,
+                                                     bustub::GenericComparator<KeySize>>;
+  bustub::Schema key_schema({bustub::Column("a", KeySize < 8 ? bustub::TypeId::INTEGER : bustub::TypeId::BIGINT)});
+  bustub::GenericComparator<KeySize> comparator(&key_schema);
+  int size = InternalPage::Capacity(layout);
+  std::vector<std::pair<bustub::GenericKey<KeySize>, bustub::page_id_t>> items(size);
+  for (int i = 0; i < size; i++) {
+    items[i].first.SetFromInteger(2 * i);
+    items[i].second = i;
+  }
+  // Pages start at a page boundary in the buffer pool too.
+  std::vector<char> buffer((num_pages + 1) * bustub::BUSTUB_PAGE_SIZE);
+  char *pages = buffer.data() + (bustub::BUSTUB_PAGE_SIZE -
+                                 reinterpret_cast<uintptr_t>(buffer.data()) % bustub::BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < num_pages; i++) {
+    auto page = reinterpret_cast<InternalPage *>(pages + i * bustub::BUSTUB_PAGE_SIZE);
+    page->Init(static_cast<bustub::page_id_t>(i), bustub::INVALID_PAGE_ID, size, layout);
+    page->CopyFrom(items.data(), size);
+  }
+
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<size_t> page_dist(0, num_pages - 1);
+  std::uniform_int_distribution<int64_t> key_dist(0, 2 * size);
+  std::vector<std::pair<size_t, bustub::GenericKey<KeySize>>> targets(4096);
+  for (auto &target : targets) {
+    target.first = page_dist(gen);
+    target.second.SetFromInteger(key_dist(gen));
+  }
+  int64_t sum = 0;
+  CacheMissCounter counter;
+  counter.Start();
+  auto start = Clock::now();
+  bustub::page_id_t child = 0;
+  for (size_t i = 0; i < num_searches; i++) {
+    // Like on the way down a tree, the page to search depends on the search before, so the searches cannot overlap.
+    const auto &[page_index, key] = targets[i % targets.size()];
+    size_t page = (page_index + i / targets.size() + child) % num_pages;
+    child = reinterpret_cast<const InternalPage *>(pages + page * bustub::BUSTUB_PAGE_SIZE)->Lookup(key, comparator);
+    sum += child;
+  }
+  LookupResult result{PerSecond(num_searches, start), std::nullopt};
+  if (auto misses = counter.Read(); misses.has_value()) {
+    result.misses_ = static_cast<double>(*misses) / static_cast<double>(num_searches);
+  }
+  if (sum < 0) {
+    throw std::runtime_error("bad search");
+  }
+  return result;
+}
+
+/**
+ * Look up random keys of a bulk-loaded B+ tree with num_keys keys, whose internal pages hold up to internal_max_size
+ * entries (fewer to get a deeper tree) laid out as given.
+ */
+template <size_t KeySize>
+auto RunTreeLookups(size_t num_keys, size_t num_lookups, int internal_max_size, bustub::InternalPageLayout layout)
+    -> LookupResult {
+  using bustub::BUSTUB_PAGE_USABLE_SIZE;
+  using bustub::GenericKey;
+  using bustub::RID;
+  // LEAF_PAGE_SIZE is written in terms of these.
+  using KeyType = GenericKey<KeySize>;
+  using ValueType = RID;
+
+  // Keys of less than 8 bytes hold an INTEGER, see GenericKey::SetFromInteger().
+  bustub::Schema key_schema({bustub::Column("a", KeySize < 8 ? bustub::TypeId::INTEGER : bustub::TypeId::BIGINT)});
+  bustub::GenericComparator<KeySize> comparator(&key_schema);
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  // Leaves are at least half full, so this keeps the whole tree in memory.
+  size_t num_frames = 2 * num_keys * (KeySize + sizeof(RID)) / bustub::BUSTUB_PAGE_SIZE + 64;
+  auto bpm = std::make_unique<bustub::BufferPoolManager>(num_frames, disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bustub::BPlusTree<KeyType, ValueType, bustub::GenericComparator<KeySize>> tree(
+      "bench", header_page_id, bpm.get(), comparator, LEAF_PAGE_SIZE, internal_max_size, layout);
+  size_t next_key = 0;
+  tree.BulkLoad([&](std::pair<GenericKey<KeySize>, RID> *item) {
+    if (next_key == num_keys) {
+      return false;
+    }
+    item->first.SetFromInteger(static_cast<int64_t>(2 * next_key));
+    item->second.Set(0, static_cast<uint32_t>(next_key));
+    next_key++;
+    return true;
+  });
+
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<size_t> dist(0, num_keys - 1);
+  GenericKey<KeySize> key;
+  std::vector<RID> result;
+  CacheMissCounter counter;
+  counter.Start();
+  auto start = Clock::now();
+  for (size_t i = 0; i < num_lookups; i++) {
+    key.SetFromInteger(static_cast<int64_t>(2 * dist(gen)));
+    result.clear();
+    if (!tree.GetValue(key, &result)) {
+      throw std::runtime_error("key not found");
+    }
+  }
+  LookupResult lookup_result{PerSecond(num_lookups, start), std::nullopt};
+  if (auto misses = counter.Read(); misses.has_value()) {
+    lookup_result.misses_ = static_cast<double>(*misses) / static_cast<double>(num_lookups);
+  }
+  bpm->UnpinPage(header_page_id, true);
+  return lookup_result;
+}
+
+/**
+ * Look up random keys of a bulk-loaded B+ tree of num_keys keys, which the buffer pool holds, from each number of
+ * threads in thread_counts, num_lookups lookups between them. Returns the lookups per second for each thread count.
+ *
+ * With optimistic lock coupling, the only thing in the tree that readers write is an epoch slot of their own. They
+ * still pin the pages they visit in the buffer pool, so the throughput grows with the threads up to the number of cores
+ * only as far as pinning the root and upper pages allows.
+ */
+auto RunConcurrentLookups(size_t num_keys, size_t num_lookups, const std::vector<size_t> &thread_counts)
+    -> std::vector<double> {
+  using bustub::BUSTUB_PAGE_USABLE_SIZE;
+  using bustub::GenericKey;
+  using bustub::RID;
+  // LEAF_PAGE_SIZE is written in terms of these.
+  using KeyType = GenericKey<8>;
+  using ValueType = RID;
+
+  bustub::Schema key_schema({bustub::Column("a", bustub::TypeId::BIGINT)});
+  bustub::GenericComparator<8> comparator(&key_schema);
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  size_t num_frames = 2 * num_keys * (sizeof(KeyType) + sizeof(RID)) / bustub::BUSTUB_PAGE_SIZE + 64;
+  auto bpm = std::make_unique<bustub::BufferPoolManager>(num_frames, disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bustub::BPlusTree<KeyType, ValueType, bustub::GenericComparator<8>> tree("bench", header_page_id, bpm.get(),
+                                                                           comparator);
+  size_t next_key = 0;
+  tree.BulkLoad([&](std::pair<KeyType, RID> *item) {
+    if (next_key == num_keys) {
+      return false;
+    }
+    item->first.SetFromInteger(static_cast<int64_t>(next_key));
+    item->second.Set(0, static_cast<uint32_t>(next_key));
+    next_key++;
+    return true;
+  });
+
+  std::vector<double> rates;
+  for (size_t num_threads : thread_counts) {
+    size_t lookups_per_thread = std::max<size_t>(num_lookups / num_threads, 1);
+    std::atomic<bool> all_found{true};
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (size_t i = 0; i < num_threads; i++) {
+      threads.emplace_back([&, i] {
+        std::mt19937_64 gen(i);
+        std::uniform_int_distribution<size_t> dist(0, num_keys - 1);
+        KeyType key;
+        std::vector<RID> result;
+        for (size_t n = 0; n < lookups_per_thread; n++) {
+          key.SetFromInteger(static_cast<int64_t>(dist(gen)));
+          result.clear();
+          if (!tree.GetValue(key, &result)) {
+            all_found = false;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    rates.push_back(PerSecond(num_threads * lookups_per_thread, start));
+    if (!all_found) {
+      throw std::runtime_error("key not found");
+    }
+  }
+  bpm->UnpinPage(header_page_id, true);
+  return rates;
+}
+
+/** How a range scan reads the entries of a B+ tree. */
+enum class ScanMode { ITERATOR, BATCHED, BATCHED_REVERSE };
+
+/**
+ * Scan ranges of scan_length entries from random starting keys of a bulk-loaded tree of num_keys keys, which the
+ * buffer pool holds, with the iterator or with ScanRange(). Returns the entries read per second.
+ */
+template <size_t KeySize>
+auto RunRangeScans(size_t num_keys, size_t num_scans, size_t scan_length, ScanMode mode) -> double {
+  using bustub::BUSTUB_PAGE_USABLE_SIZE;
+  using bustub::GenericKey;
+  using bustub::RID;
+  // LEAF_PAGE_SIZE is written in terms of these.
+  using KeyType = GenericKey<KeySize>;
+  using ValueType = RID;
+
+  bustub::Schema key_schema({bustub::Column("a", KeySize < 8 ? bustub::TypeId::INTEGER : bustub::TypeId::BIGINT)});
+  bustub::GenericComparator<KeySize> comparator(&key_schema);
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  size_t num_frames = 2 * num_keys * (KeySize + sizeof(RID)) / bustub::BUSTUB_PAGE_SIZE + 64;
+  auto bpm = std::make_unique<bustub::BufferPoolManager>(num_frames, disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bustub::BPlusTree<KeyType, ValueType, bustub::GenericComparator<KeySize>> tree("bench", header_page_id, bpm.get(),
+                                                                                 comparator);
+  size_t next_key = 0;
+  tree.BulkLoad([&](std::pair<GenericKey<KeySize>, RID> *item) {
+    if (next_key == num_keys) {
+      return false;
+    }
+    item->first.SetFromInteger(static_cast<int64_t>(next_key));
+    item->second.Set(0, static_cast<uint32_t>(next_key));
+    next_key++;
+    return true;
+  });
+
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<size_t> dist(0, num_keys - scan_length);
+  GenericKey<KeySize> lo;
+  GenericKey<KeySize> hi;
+  uint64_t checksum = 0;
+  size_t entries = 0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < num_scans; i++) {
+    auto first = static_cast<int64_t>(dist(gen));
+    lo.SetFromInteger(first);
+    hi.SetFromInteger(first + static_cast<int64_t>(scan_length) - 1);
+    if (mode == ScanMode::ITERATOR) {
+      for (auto iterator = tree.Begin(lo); !iterator.IsEnd() && comparator((*iterator).first, hi) <= 0;
+           ++iterator) {
+        checksum += (*iterator).second.GetSlotNum();
+        entries++;
+      }
+      continue;
+    }
+    entries += tree.ScanRange(
+        lo, hi,
+        [&checksum](const std::pair<GenericKey<KeySize>, RID> *items, size_t size) {
+          for (size_t j = 0; j < size; j++) {
+            checksum += items[j].second.GetSlotNum();
+          }
+          return true;
+        },
+        mode == ScanMode::BATCHED_REVERSE);
+  }
+  double rate = PerSecond(entries, start);
+  if (entries != num_scans * scan_length || checksum == 0) {
+    throw std::runtime_error("range scan missed entries");
+  }
+  bpm->UnpinPage(header_page_id, true);
+  return rate;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-index-bench");
+  program.add_argument("--keys").help("keys in each B+ tree (default 1000000)");
+  program.add_argument("--lookups").help("lookups per B+ tree and searches per page (default 1000000)");
+  program.add_argument("--internal-size").help("most entries in an internal page, fewer make deeper trees (default "
+                                               "as many as fit)");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_keys = 1000000;
+  if (program.present("--keys")) {
+    num_keys = std::stoul(program.get("--keys"));
+  }
+  size_t num_lookups = 1000000;
+  if (program.present("--lookups")) {
+    num_lookups = std::stoul(program.get("--lookups"));
+  }
+
+  int internal_size = INT_MAX;
+  if (program.present("--internal-size")) {
+    internal_size = std::stoi(program.get("--internal-size"));
+  }
+
+  fmt::print(stderr, "[info] keys={}, lookups={}, internal_size={}, vectorized={}\n", num_keys, num_lookups,
+             internal_size, bustub::KeySearch::IsVectorized());
+
+  fmt::print("<<< BEGIN\n");
+  for (size_t width : {4, 8}) {
+    fmt::print("page search, {} byte keys: scalar {:.0f}/s, vectorized {:.0f}/s\n", width,
+               RunPageSearches(width, false, num_lookups), RunPageSearches(width, true, num_lookups));
+  }
+  for (auto layout : {bustub::InternalPageLayout::SORTED, bustub::InternalPageLayout::EYTZINGER}) {
+    auto name = layout == bustub::InternalPageLayout::SORTED ? "sorted" : "eytzinger";
+    // 512 MB of pages, more than the caches hold.
+    size_t num_pages = (size_t{512} << 20) / bustub::BUSTUB_PAGE_SIZE;
+    fmt::print("internal page search, GenericKey<4>, {}: {}\n", name,
+               RunInternalPageSearches<4>(layout, num_pages, num_lookups).ToString());
+    fmt::print("internal page search, GenericKey<8>, {}: {}\n", name,
+               RunInternalPageSearches<8>(layout, num_pages, num_lookups).ToString());
+    fmt::print("tree lookup, GenericKey<4>, {}: {}\n", name,
+               RunTreeLookups<4>(num_keys, num_lookups, internal_size, layout).ToString());
+    fmt::print("tree lookup, GenericKey<8>, {}: {}\n", name,
+               RunTreeLookups<8>(num_keys, num_lookups, internal_size, layout).ToString());
+    // Only keys of up to EYTZINGER_MAX_KEY_SIZE bytes can have EYTZINGER internal pages.
+    if (layout == bustub::InternalPageLayout::SORTED) {
+      fmt::print("internal page search, GenericKey<16>, {}: {}\n", name,
+                 RunInternalPageSearches<16>(layout, num_pages, num_lookups).ToString());
+      fmt::print("internal page search, GenericKey<64>, {}: {}\n", name,
+                 RunInternalPageSearches<64>(layout, num_pages, num_lookups).ToString());
+      fmt::print("tree lookup, GenericKey<16>, {}: {}\n", name,
+                 RunTreeLookups<16>(num_keys, num_lookups, internal_size, layout).ToString());
+      fmt::print("tree lookup, GenericKey<64>, {}: {}\n", name,
+                 RunTreeLookups<64>(num_keys, num_lookups, internal_size, layout).ToString());
+    }
+  }
+  std::vector<size_t> thread_counts{1, 2, 4, 8, 16};
+  auto rates = RunConcurrentLookups(num_keys, num_lookups, thread_counts);
+  for (size_t i = 0; i < thread_counts.size(); i++) {
+    fmt::print("tree lookup, GenericKey<8>, {} threads: {:.0f}/s, speedup {:.2f}\n", thread_counts[i], rates[i],
+               rates[i] / rates[0]);
+  }
+  for (auto [mode, name] : {std::pair{ScanMode::ITERATOR, "iterator"}, std::pair{ScanMode::BATCHED, "batched"},
+                            std::pair{ScanMode::BATCHED_REVERSE, "batched reverse"}}) {
+    size_t num_scans = std::max<size_t>(num_lookups / 100, 1);
+    fmt::print("range scan of 1000 keys, GenericKey<8>, {}: {:.0f} entries/s\n", name,
+               RunRangeScans<8>(num_keys, num_scans, 1000, mode));
+    fmt::print("range scan of 1000 keys, GenericKey<64>, {}: {:.0f} entries/s\n", name,
+               RunRangeScans<64>(num_keys, num_scans, 1000, mode));
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "fmt/core.h"
+
+/**
+ * Drive a replacer the way a buffer pool under memory pressure does and return the average time of one round in
+ * nanoseconds. Every round evicts a victim, brings a new page into its frame and unpins it, then hits a random
+ * resident page: pin, access, unpin.
+ */
+auto RunRounds(bustub::Replacer *replacer, size_t num_frames, size_t num_rounds) -> double {
+  using bustub::AccessType;
+  using bustub::frame_id_t;
+
+  for (size_t i = 0; i < num_frames; i++) {
+    auto fid = static_cast<frame_id_t>(i);
+    replacer->RecordAccess(fid, AccessType::Get);
+    replacer->SetEvictable(fid, true);
+  }
+
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<frame_id_t> dist(0, static_cast<frame_id_t>(num_frames - 1));
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_rounds; i++) {
+    frame_id_t victim;
+    if (!replacer->Evict(&victim)) {
+      throw std::runtime_error("no victim");
+    }
+    replacer->RecordAccess(victim, AccessType::Get);
+    replacer->SetEvictable(victim, true);
+
+    auto hit = dist(gen);
+    replacer->SetEvictable(hit, false);
+    replacer->RecordAccess(hit, AccessType::Get);
+    replacer->SetEvictable(hit, true);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  return static_cast<double>(elapsed.count()) / static_cast<double>(num_rounds);
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-replacer-bench");
+  program.add_argument("--replacer").help("replacement policy: lru, clock, lru-k (default), arc, 2q or clock-pro");
+  program.add_argument("--max-frames").help("largest frame count to run, growing 10x from 1000 (default 1000000)");
+  program.add_argument("--rounds").help("evict/access rounds per frame count (default 200000)");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  const std::map<std::string, bustub::ReplacerPolicy> policies = {
+      {"lru", bustub::ReplacerPolicy::LRU},     {"clock", bustub::ReplacerPolicy::Clock},
+      {"lru-k", bustub::ReplacerPolicy::LRUK},  {"arc", bustub::ReplacerPolicy::ARC},
+      {"2q", bustub::ReplacerPolicy::TwoQueue}, {"clock-pro", bustub::ReplacerPolicy::ClockPro},
+  };
+  std::string replacer = "lru-k";
+  if (program.present("--replacer")) {
+    replacer = program.get("--replacer");
+  }
+  if (policies.count(replacer) == 0) {
+    std::cerr << "unknown --replacer " << replacer << std::endl;
+    return 1;
+  }
+
+  size_t max_frames = 1000000;
+  if (program.present("--max-frames")) {
+    max_frames = std::stoul(program.get("--max-frames"));
+  }
+
+  size_t num_rounds = 200000;
+  if (program.present("--rounds")) {
+    num_rounds = std::stoul(program.get("--rounds"));
+  }
+
+  fmt::print(stderr, "[info] replacer={}, max_frames={}, rounds={}, lru_k_size={}\n", replacer, max_frames,
+             num_rounds, bustub::LRUK_REPLACER_K);
+
+  fmt::print("<<< BEGIN\n");
+  for (size_t num_frames = 1000; num_frames <= max_frames; num_frames *= 10) {
+    auto instance = bustub::CreateReplacer(policies.at(replacer), num_frames, bustub::LRUK_REPLACER_K);
+    auto ns_per_round = RunRounds(instance.get(), num_frames, num_rounds);
+    fmt::print("frames {}: {:.1f} ns/round\n", num_frames, ns_per_round);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
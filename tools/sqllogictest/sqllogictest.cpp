@@ -73,6 +73,11 @@ auto ProcessExtraOptions(const std::string &sql, bustub::BustubInstance &instanc
           fmt::print("IndexScan not found\n");
           return false;
         }
+      } else if (opt == "ensure:reverse_index_scan") {
+        if (!bustub::StringUtil::Contains(result.str(), "reverse=true")) {
+          fmt::print("reverse IndexScan not found\n");
+          return false;
+        }
       } else if (opt == "ensure:topn") {
         if (!bustub::StringUtil::Contains(result.str(), "TopN")) {
           fmt::print("TopN not found\n");
@@ -0,0 +1,56 @@
+#include <sys/stat.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "fmt/ranges.h"
+#include "storage/disk/disk_manager.h"
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-verify");
+  program.add_argument("db_file").help("database file to check the page checksums of, which must not be in use");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto db_file = program.get("db_file");
+  struct stat stat_buf;
+  if (stat(db_file.c_str(), &stat_buf) != 0) {
+    std::cerr << "cannot find a database in " << db_file << std::endl;
+    return 1;
+  }
+
+  bustub::DiskManager disk_manager(db_file, false, bustub::DiskSyncPolicy::None, true);
+  std::vector<char> data(bustub::BUSTUB_PAGE_SIZE);
+  std::vector<bustub::page_id_t> failed_pages;
+  int num_checked = 0;
+  for (auto segment_id : disk_manager.GetSegments()) {
+    auto limit = disk_manager.GetPageIdLimit(segment_id);
+    for (auto page_id = bustub::DiskManager::GetFirstPageId(segment_id); page_id < limit; page_id++) {
+      if (!disk_manager.IsPageAllocated(page_id)) {
+        continue;
+      }
+      num_checked++;
+      if (!disk_manager.ReadPage(page_id, data.data())) {
+        failed_pages.push_back(page_id);
+      }
+    }
+  }
+  disk_manager.ShutDown();
+
+  fmt::print("{} pages checked, {} failed\n", num_checked, failed_pages.size());
+  if (!failed_pages.empty()) {
+    fmt::print("failed pages: {}\n", failed_pages);
+    return 1;
+  }
+  return 0;
+}